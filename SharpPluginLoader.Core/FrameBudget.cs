@@ -0,0 +1,250 @@
+﻿using System.Diagnostics;
+using System.Runtime.InteropServices;
+
+namespace SharpPluginLoader.Core
+{
+    /// <summary>
+    /// The per-frame callbacks that are timed against a plugin's frame budget.
+    /// </summary>
+    public enum FrameCallback
+    {
+        OnUpdate,
+        OnRender,
+        OnImGuiRender,
+        OnImGuiFreeRender
+    }
+
+    internal enum FrameBudgetAction : uint
+    {
+        None,
+        Log,
+        Disable
+    }
+
+    // Mirrored by CoreModule::FrameBudgetConfig (SPL.FrameBudgetMs, SPL.FrameBudgetAction, SPL.FrameBudgetStrikes)
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct FrameBudgetConfig
+    {
+        public float BudgetMs;
+        public FrameBudgetAction Action;
+        public uint Strikes;
+    }
+
+    /// <summary>
+    /// Times the per-frame callbacks of every plugin and enforces the frame budget.
+    /// A frame ends whenever the game's main update runs, so the frame time of a plugin
+    /// is the sum of its OnUpdate call and all render callbacks since the previous update.
+    /// </summary>
+    internal static unsafe class FrameBudget
+    {
+        public const int WindowSize = 120;
+
+        // Names of the native counters that time the same callbacks from the other side of the boundary
+        public static readonly (FrameCallback Callback, string Counter)[] NativeCounters =
+        [
+            (FrameCallback.OnUpdate, "CoreModule::main_update_hook"),
+            (FrameCallback.OnRender, "D3DModule::core_render"),
+            (FrameCallback.OnImGuiRender, "D3DModule::core_imgui_render")
+        ];
+
+        public static FrameBudgetConfig Config => _config;
+
+        public static PluginFrameTimings[] All => _all;
+
+        public static void Initialize()
+        {
+            FrameBudgetConfig config;
+            InternalCalls.GetFrameBudgetConfig(&config);
+            _config = config;
+
+            Log.Debug($"Frame budget: {config.BudgetMs} ms, action: {config.Action}, strikes: {config.Strikes}");
+        }
+
+        // Lookups scan the immutable snapshot, plugins only ever change under the lock
+        public static PluginFrameTimings Get(IPlugin plugin)
+        {
+            foreach (var timings in _all)
+            {
+                if (timings.Plugin == plugin)
+                    return timings;
+            }
+
+            // Not under the lock, PluginManager calls into here while holding its own lock
+            var budget = PluginManager.Instance.GetPluginData(plugin).FrameBudgetMs;
+
+            lock (Lock)
+            {
+                var existing = Array.Find(_all, t => t.Plugin == plugin);
+                if (existing is not null)
+                    return existing;
+
+                var timings = new PluginFrameTimings(plugin, budget > 0 ? budget : _config.BudgetMs);
+
+                _all = [.. _all.Where(t => t.Plugin.Key != plugin.Key), timings];
+                return timings;
+            }
+        }
+
+        public static void Remove(IPlugin plugin)
+        {
+            lock (Lock)
+            {
+                _all = Array.FindAll(_all, t => t.Plugin != plugin);
+            }
+        }
+
+        public static void EndFrame()
+        {
+            foreach (var timings in _all)
+            {
+                if (!timings.EndFrame() || timings.IsSuspended)
+                    continue;
+
+                switch (_config.Action)
+                {
+                    case FrameBudgetAction.Log:
+                        Log.Warn($"Plugin {timings.Plugin.Name} exceeded its frame budget of {timings.BudgetMs:F2} ms " +
+                                 $"for {_config.Strikes} consecutive frames (average {timings.Average:F2} ms)");
+                        break;
+                    case FrameBudgetAction.Disable:
+                        Log.Error($"Plugin {timings.Plugin.Name} exceeded its frame budget of {timings.BudgetMs:F2} ms " +
+                                  $"for {_config.Strikes} consecutive frames, suspending its frame callbacks");
+                        timings.IsSuspended = true;
+                        break;
+                }
+            }
+        }
+
+        private static FrameBudgetConfig _config = new() { BudgetMs = 4.0f, Action = FrameBudgetAction.Log, Strikes = 120 };
+        private static readonly object Lock = new();
+        private static PluginFrameTimings[] _all = [];
+    }
+
+    /// <summary>
+    /// Rolling frame timings of a single plugin. Callbacks may run on the main and the render thread,
+    /// so the per-frame accumulators are atomic. The rolling windows are only written by the main thread.
+    /// </summary>
+    internal sealed class PluginFrameTimings
+    {
+        public IPlugin Plugin { get; }
+
+        public float BudgetMs { get; }
+
+        public bool IsSuspended { get; set; }
+
+        public float Average => _total.Average;
+
+        public PluginFrameTimings(IPlugin plugin, float budgetMs)
+        {
+            Plugin = plugin;
+            BudgetMs = budgetMs;
+        }
+
+        public CallbackScope Measure(FrameCallback callback) => new(this, callback);
+
+        public RollingWindow GetWindow(FrameCallback callback) => _callbacks[(int)callback];
+
+        public RollingWindow Total => _total;
+
+        public void Resume()
+        {
+            IsSuspended = false;
+            _strikes = 0;
+        }
+
+        // Returns true on the frame the plugin reaches the configured number of consecutive overruns
+        internal bool EndFrame()
+        {
+            var total = 0.0f;
+            for (var i = 0; i < _pending.Length; i++)
+            {
+                var ms = (float)Stopwatch.GetElapsedTime(0, Interlocked.Exchange(ref _pending[i], 0)).TotalMilliseconds;
+                _callbacks[i].Add(ms);
+                total += ms;
+            }
+
+            _total.Add(total);
+
+            if (total <= BudgetMs)
+            {
+                _strikes = 0;
+                return false;
+            }
+
+            return ++_strikes == FrameBudget.Config.Strikes;
+        }
+
+        internal void Record(FrameCallback callback, long start)
+        {
+            Interlocked.Add(ref _pending[(int)callback], Stopwatch.GetTimestamp() - start);
+        }
+
+        internal readonly struct CallbackScope : IDisposable
+        {
+            private readonly PluginFrameTimings _timings;
+            private readonly FrameCallback _callback;
+            private readonly long _start;
+
+            public CallbackScope(PluginFrameTimings timings, FrameCallback callback)
+            {
+                _timings = timings;
+                _callback = callback;
+                _start = Stopwatch.GetTimestamp();
+            }
+
+            public void Dispose() => _timings.Record(_callback, _start);
+        }
+
+        private readonly long[] _pending = new long[4];
+        private readonly RollingWindow[] _callbacks = [new(), new(), new(), new()];
+        private readonly RollingWindow _total = new();
+        private uint _strikes;
+    }
+
+    /// <summary>
+    /// The last <see cref="FrameBudget.WindowSize"/> frame times of a callback, in milliseconds.
+    /// </summary>
+    internal sealed class RollingWindow
+    {
+        public float Average => _count == 0 ? 0.0f : _sum / _count;
+
+        public float Max
+        {
+            get
+            {
+                var max = 0.0f;
+                for (var i = 0; i < _count; i++)
+                    max = Math.Max(max, _samples[i]);
+                return max;
+            }
+        }
+
+        // Only computed when displayed, so sorting a copy is fine
+        public float P99
+        {
+            get
+            {
+                if (_count == 0)
+                    return 0.0f;
+
+                Span<float> sorted = stackalloc float[_count];
+                _samples.AsSpan(0, _count).CopyTo(sorted);
+                sorted.Sort();
+                return sorted[Math.Min((int)(_count * 0.99f), _count - 1)];
+            }
+        }
+
+        public void Add(float sample)
+        {
+            _sum += sample - _samples[_next];
+            _samples[_next] = sample;
+            _next = (_next + 1) % _samples.Length;
+            _count = Math.Min(_count + 1, _samples.Length);
+        }
+
+        private readonly float[] _samples = new float[FrameBudget.WindowSize];
+        private float _sum;
+        private int _next;
+        private int _count;
+    }
+}
@@ -118,17 +118,17 @@ namespace SharpPluginLoader.Core
             callback(*result);
         }
 
-        private static void ChatMessageSentHook(string message)
+        // void ChatMessageSent(const wchar_t* message)
+        private static void ChatMessageSentHook(ref HookContext ctx)
         {
+            var message = Marshal.PtrToStringUni((nint)ctx.Rcx) ?? string.Empty;
             foreach (var plugin in PluginManager.Instance.GetPlugins(p => p.OnChatMessageSent))
                 plugin.OnChatMessageSent(message);
-
-            _chatMessageSentHook.Original(message);
         }
 
         internal static void Initialize()
         {
-            _chatMessageSentHook = Hook.Create<ChatMessageSentDelegate>(AddressRepository.Get("Chat:MessageSent"), ChatMessageSentHook);
+            MulticastHook.Subscribe(AddressRepository.Get("Chat:MessageSent"), ChatMessageSentHook);
         }
 
         private static readonly Queue<DialogCallback> DialogCallbacks = new();
@@ -137,10 +137,6 @@ namespace SharpPluginLoader.Core
         private static readonly NativeAction<nint, string, float, uint, bool> DisplayMessageFunc = new(AddressRepository.Get("Gui:DisplayMessage"));
         private static readonly NativeAction<nint, nint, nint, nint, bool> DisplayMessageWindowFunc = new(AddressRepository.Get("Gui:DisplayMessageWindow"));
         private static readonly NativeAction<string> DisplayAlertFunc = new(AddressRepository.Get("Gui:DisplayAlert"));
-        private static Hook<ChatMessageSentDelegate> _chatMessageSentHook = null!;
-
-        [UnmanagedFunctionPointer(CallingConvention.StdCall, CharSet = CharSet.Unicode)]
-        private delegate void ChatMessageSentDelegate(string message);
     }
 
     /// <summary>
@@ -0,0 +1,126 @@
+﻿using System.Diagnostics;
+using System.Globalization;
+using System.Runtime.InteropServices;
+using System.Text;
+
+namespace SharpPluginLoader.Core
+{
+    /// <summary>
+    /// Provides access to the call counters and latency histograms the loader keeps for its hooks.
+    /// Native hooks (rendering, the main update, multicast hooks) and every hook created
+    /// with <see cref="Memory.Hook.Create{TFunction}"/> are measured.
+    /// </summary>
+    public static unsafe class HookProfiler
+    {
+        private const uint MaxCounters = 128;
+
+        // The native side ignores samples for this counter
+        internal const uint NoCounter = MaxCounters;
+
+        // Running total of the Stopwatch ticks this thread spent in original functions called from hooks.
+        // Timings subtract how much it grew in between, so time spent in an original is not counted
+        // towards the hook that called it.
+        [ThreadStatic] private static long _excludedTicks;
+
+        /// <summary>
+        /// Gets the statistics of all hook counters.
+        /// </summary>
+        public static HookStatistics[] GetStatistics()
+        {
+            var stats = stackalloc HookStatistics[(int)MaxCounters];
+            var count = InternalCalls.GetHookStatistics(stats, MaxCounters);
+            return new ReadOnlySpan<HookStatistics>(stats, (int)count).ToArray();
+        }
+
+        /// <summary>
+        /// Clears all hook counters.
+        /// </summary>
+        public static void Reset() => InternalCalls.ResetHookStatistics();
+
+        /// <summary>
+        /// Writes the statistics of all hook counters to a CSV file.
+        /// </summary>
+        /// <param name="path">The path of the file</param>
+        public static void ExportCsv(string path)
+        {
+            var csv = new StringBuilder();
+            csv.AppendLine("Name,Calls,Total (ms),Mean (us),P50 (us),P99 (us),Max (us)");
+
+            foreach (var stat in GetStatistics())
+            {
+                csv.AppendLine(string.Join(',',
+                    $"\"{stat.Name.Replace("\"", "\"\"")}\"",
+                    stat.Calls.ToString(CultureInfo.InvariantCulture),
+                    stat.TotalMs.ToString("F3", CultureInfo.InvariantCulture),
+                    stat.MeanUs.ToString("F3", CultureInfo.InvariantCulture),
+                    stat.P50Us.ToString("F3", CultureInfo.InvariantCulture),
+                    stat.P99Us.ToString("F3", CultureInfo.InvariantCulture),
+                    stat.MaxUs.ToString("F3", CultureInfo.InvariantCulture)));
+            }
+
+            Directory.CreateDirectory(Path.GetDirectoryName(Path.GetFullPath(path))!);
+            File.WriteAllText(path, csv.ToString());
+        }
+
+        internal static uint RegisterCounter(string name) => InternalCalls.RegisterHookCounter(name);
+
+        internal static void UnregisterCounter(uint counter) => InternalCalls.UnregisterHookCounter(counter);
+
+        // The start of a timed call, offset by the time excluded on this thread so far
+        internal static long BeginTiming() => Stopwatch.GetTimestamp() - _excludedTicks;
+
+        // Records the time since BeginTiming, minus what was spent in original functions in between.
+        // Elapsed time is in Stopwatch ticks, which the native side converts with the QPC frequency.
+        internal static void EndHook(uint counter, long begin) =>
+            InternalCalls.RecordHookSample(counter, (ulong)(Stopwatch.GetTimestamp() - _excludedTicks - begin));
+
+        // Excludes the time since BeginTiming. Whatever nested hooks excluded in between is part of that
+        // time already, so the total is set rather than added to.
+        internal static void EndOriginal(long begin) => _excludedTicks = Stopwatch.GetTimestamp() - begin;
+    }
+
+    /// <summary>
+    /// The statistics of a single hook counter. Percentiles are approximate,
+    /// they are the upper bound of the histogram bucket they fall into.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public unsafe struct HookStatistics
+    {
+        private readonly sbyte* _name;
+
+        /// <summary>
+        /// The number of recorded calls.
+        /// </summary>
+        public ulong Calls;
+
+        /// <summary>
+        /// The total time spent in the hook, in milliseconds.
+        /// </summary>
+        public double TotalMs;
+
+        /// <summary>
+        /// The mean time per call, in microseconds.
+        /// </summary>
+        public double MeanUs;
+
+        /// <summary>
+        /// The median time per call, in microseconds.
+        /// </summary>
+        public double P50Us;
+
+        /// <summary>
+        /// The 99th percentile time per call, in microseconds.
+        /// </summary>
+        public double P99Us;
+
+        /// <summary>
+        /// The longest call, in microseconds.
+        /// </summary>
+        public double MaxUs;
+
+        /// <summary>
+        /// The name of the counter.
+        /// </summary>
+        public readonly string Name => _name == null ? string.Empty : new string(_name);
+    }
+}
@@ -137,6 +137,13 @@ namespace SharpPluginLoader.Core
         /// When set to true, any ImGui widgets rendered inside <see cref="IPlugin.OnImGuiRender"/> will be wrapped in a TreeNode.
         /// </summary>
         public bool ImGuiWrappedInTreeNode = true;
+
+        /// <summary>
+        /// The time in milliseconds the plugin's per-frame callbacks (<see cref="IPlugin.OnUpdate"/>, <see cref="IPlugin.OnRender"/>,
+        /// <see cref="IPlugin.OnImGuiRender"/> and <see cref="IPlugin.OnImGuiFreeRender"/>) may take per frame combined.
+        /// A value of 0 uses the loader's default budget (SPL.FrameBudgetMs).
+        /// </summary>
+        public float FrameBudgetMs;
     }
 
 #pragma warning restore CS0649
@@ -189,6 +196,11 @@ namespace SharpPluginLoader.Core
         /// This is only used for special cases, and is not applicable to most plugins.
         /// This will NOT be called during hot-reloading.
         /// </summary>
+        /// <remarks>
+        /// When <c>SPL.AsyncClrBootstrap</c> is enabled in loader-config.json, this is instead called
+        /// after the game's static initializers, right before WinMain. Plugins that rely on running before
+        /// the static initializers require the option to be left off.
+        /// </remarks>
         [PluginEvent]
         public void OnPreMain() => throw new NotImplementedException();
 
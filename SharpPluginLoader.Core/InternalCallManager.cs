@@ -11,6 +11,22 @@ namespace SharpPluginLoader.Core
         public string Name => Marshal.PtrToStringAnsi(_fieldName) ?? string.Empty;
     }
 
+    /// <summary>
+    /// A native companion (Plugin.Native.dll) that was loaded by the native plugin host
+    /// before the managed plugins, along with its internal calls.
+    /// </summary>
+    internal readonly unsafe struct NativeCompanion
+    {
+        private readonly nint _path;
+        public readonly nint Module;
+        private readonly InternalCall* _internalCalls;
+        private readonly uint _internalCallCount;
+
+        public string Path => Marshal.PtrToStringUTF8(_path) ?? string.Empty;
+
+        public ReadOnlySpan<InternalCall> InternalCalls => new(_internalCalls, (int)_internalCallCount);
+    }
+
     /// <summary>
     /// This attribute is used to mark a class as an internal call manager.
     /// There can only be one internal call manager per plugin.
@@ -22,29 +38,24 @@ namespace SharpPluginLoader.Core
 
     internal static class InternalCallManager
     {
-        public static unsafe void UploadInternalCalls(InternalCall* internalCalls, uint internalCallsCount)
+        public static unsafe void UploadInternalCalls(nint* table, uint count, uint tableHash)
         {
-            for (var i = 0; i < internalCallsCount; i++)
+            // The table is generated for both sides from the same declarations, so a mismatch means
+            // the loader and SharpPluginLoader.Core come from different builds.
+            if (count != InternalCallTable.Count || tableHash != InternalCallTable.TableHash)
             {
-                var icall = internalCalls[i];
-
-                Log.Debug($"[Core] Uploading internal call {icall.Name}");
-
-                var field = typeof(InternalCalls).GetField(icall.Name + "Ptr");
-
-                if (field == null)
-                {
-                    Log.Error($"[Core] Internal call {icall.Name} does not exist");
-                    continue;
-                }
+                Log.Error($"[Core] Internal call table mismatch (native: {count} calls, 0x{tableHash:X8}, " +
+                          $"managed: {InternalCallTable.Count} calls, 0x{InternalCallTable.TableHash:X8}). " +
+                          "Make sure the loader and SharpPluginLoader.Core are from the same version.");
+                return;
+            }
 
-                if (!field.FieldType.IsFunctionPointer)
-                {
-                    Log.Error($"[Core] Internal call {icall.Name} is not a function pointer");
-                    continue;
-                }
+            InternalCallTable.Bind(table);
 
-                field.SetValue(null, icall.FunctionPointer);
+            for (var i = 0; i < count; i++)
+            {
+                if (table[i] == 0)
+                    Log.Debug($"[Core] Internal call {InternalCallTable.Names[i]} was not registered");
             }
         }
     }
@@ -0,0 +1,152 @@
+﻿// <auto-generated>
+// Generated by generate_internal_calls.py from mhw-cs-plugin-loader/InternalCalls.json. Do not edit.
+// </auto-generated>
+
+namespace SharpPluginLoader.Core
+{
+    internal static unsafe partial class InternalCalls
+    {
+#pragma warning disable CS0649 // Field is never assigned to, and will always have its default value
+        public static delegate* unmanaged<nint, void> QueueYesNoDialogPtr;
+        public static delegate* unmanaged<string, void> LoadChunkPtr;
+        public static delegate* unmanaged<string, nint> RequestChunkPtr;
+        public static delegate* unmanaged<nint> GetDefaultChunkPtr;
+        public static delegate* unmanaged<nint, string, nint> ChunkGetFilePtr;
+        public static delegate* unmanaged<nint, string, nint> ChunkGetFolderPtr;
+        public static delegate* unmanaged<nint, nint> FileGetContentsPtr;
+        public static delegate* unmanaged<nint, long> FileGetSizePtr;
+        public static delegate* unmanaged<string, float, float, ref float, int, bool> BeginTimelinePtr;
+        public static delegate* unmanaged<void> EndTimelinePtr;
+        public static delegate* unmanaged<string, ref bool, bool> BeginTimelineGroupPtr;
+        public static delegate* unmanaged<void> EndTimelineGroupPtr;
+        public static delegate* unmanaged<string, float*, int, out int, bool> TimelineTrackPtr;
+        public static delegate* unmanaged<string, ref uint, ref int, bool> BitfieldPtr;
+        public static delegate* unmanaged<string, int, void> NotificationSuccessPtr;
+        public static delegate* unmanaged<string, int, void> NotificationErrorPtr;
+        public static delegate* unmanaged<string, int, void> NotificationWarningPtr;
+        public static delegate* unmanaged<string, int, void> NotificationInfoPtr;
+        public static delegate* unmanaged<int, int, string, string, void> NotificationPtr;
+        public static delegate* unmanaged<void> RenderNotificationsPtr;
+        public static delegate* unmanaged<nint, nint, void> RenderSpherePtr;
+        public static delegate* unmanaged<nint, nint, void> RenderObbPtr;
+        public static delegate* unmanaged<nint, nint, void> RenderCapsulePtr;
+        public static delegate* unmanaged<nint, nint, void> RenderLinePtr;
+        public static delegate* unmanaged<string, out uint, out uint, nint> LoadTexturePtr;
+        public static delegate* unmanaged<nint, void> UnloadTexturePtr;
+        public static delegate* unmanaged<nint, nint> RegisterTexturePtr;
+        public static delegate* unmanaged<string, nint> GetRepositoryAddressPtr;
+        public static delegate* unmanaged<sbyte*> GetGameRevisionPtr;
+        public static delegate* unmanaged<LogStatistics*, void> GetLogStatisticsPtr;
+        public static delegate* unmanaged<void> NotifySingletonsChangedPtr;
+        public static delegate* unmanaged<string, long, long, void> RecordTraceSpanPtr;
+        public static delegate* unmanaged<nint, bool> HookAddManagedSubscriberPtr;
+        public static delegate* unmanaged<nint, void> HookRemoveManagedSubscriberPtr;
+        public static delegate* unmanaged<HookStatistics*, uint, uint> GetHookStatisticsPtr;
+        public static delegate* unmanaged<void> ResetHookStatisticsPtr;
+        public static delegate* unmanaged<string, uint> RegisterHookCounterPtr;
+        public static delegate* unmanaged<uint, ulong, void> RecordHookSamplePtr;
+        public static delegate* unmanaged<FrameBudgetConfig*, void> GetFrameBudgetConfigPtr;
+        public static delegate* unmanaged<out uint, NativeCompanion*> GetNativeCompanionsPtr;
+        public static delegate* unmanaged<MemoryStatistics*, uint, uint> GetMemoryStatisticsPtr;
+        public static delegate* unmanaged<uint, void> UnregisterHookCounterPtr;
+#pragma warning restore CS0649
+    }
+
+    internal static unsafe class InternalCallTable
+    {
+        public const int Count = 42;
+        public const uint TableHash = 0x9BA21F46;
+
+        public static readonly string[] Names =
+        [
+            "QueueYesNoDialog",
+            "LoadChunk",
+            "RequestChunk",
+            "GetDefaultChunk",
+            "ChunkGetFile",
+            "ChunkGetFolder",
+            "FileGetContents",
+            "FileGetSize",
+            "BeginTimeline",
+            "EndTimeline",
+            "BeginTimelineGroup",
+            "EndTimelineGroup",
+            "TimelineTrack",
+            "Bitfield",
+            "NotificationSuccess",
+            "NotificationError",
+            "NotificationWarning",
+            "NotificationInfo",
+            "Notification",
+            "RenderNotifications",
+            "RenderSphere",
+            "RenderObb",
+            "RenderCapsule",
+            "RenderLine",
+            "LoadTexture",
+            "UnloadTexture",
+            "RegisterTexture",
+            "GetRepositoryAddress",
+            "GetGameRevision",
+            "GetLogStatistics",
+            "NotifySingletonsChanged",
+            "RecordTraceSpan",
+            "HookAddManagedSubscriber",
+            "HookRemoveManagedSubscriber",
+            "GetHookStatistics",
+            "ResetHookStatistics",
+            "RegisterHookCounter",
+            "RecordHookSample",
+            "GetFrameBudgetConfig",
+            "GetNativeCompanions",
+            "GetMemoryStatistics",
+            "UnregisterHookCounter",
+        ];
+
+        public static void Bind(nint* table)
+        {
+            InternalCalls.QueueYesNoDialogPtr = (delegate* unmanaged<nint, void>)table[0];
+            InternalCalls.LoadChunkPtr = (delegate* unmanaged<string, void>)table[1];
+            InternalCalls.RequestChunkPtr = (delegate* unmanaged<string, nint>)table[2];
+            InternalCalls.GetDefaultChunkPtr = (delegate* unmanaged<nint>)table[3];
+            InternalCalls.ChunkGetFilePtr = (delegate* unmanaged<nint, string, nint>)table[4];
+            InternalCalls.ChunkGetFolderPtr = (delegate* unmanaged<nint, string, nint>)table[5];
+            InternalCalls.FileGetContentsPtr = (delegate* unmanaged<nint, nint>)table[6];
+            InternalCalls.FileGetSizePtr = (delegate* unmanaged<nint, long>)table[7];
+            InternalCalls.BeginTimelinePtr = (delegate* unmanaged<string, float, float, ref float, int, bool>)table[8];
+            InternalCalls.EndTimelinePtr = (delegate* unmanaged<void>)table[9];
+            InternalCalls.BeginTimelineGroupPtr = (delegate* unmanaged<string, ref bool, bool>)table[10];
+            InternalCalls.EndTimelineGroupPtr = (delegate* unmanaged<void>)table[11];
+            InternalCalls.TimelineTrackPtr = (delegate* unmanaged<string, float*, int, out int, bool>)table[12];
+            InternalCalls.BitfieldPtr = (delegate* unmanaged<string, ref uint, ref int, bool>)table[13];
+            InternalCalls.NotificationSuccessPtr = (delegate* unmanaged<string, int, void>)table[14];
+            InternalCalls.NotificationErrorPtr = (delegate* unmanaged<string, int, void>)table[15];
+            InternalCalls.NotificationWarningPtr = (delegate* unmanaged<string, int, void>)table[16];
+            InternalCalls.NotificationInfoPtr = (delegate* unmanaged<string, int, void>)table[17];
+            InternalCalls.NotificationPtr = (delegate* unmanaged<int, int, string, string, void>)table[18];
+            InternalCalls.RenderNotificationsPtr = (delegate* unmanaged<void>)table[19];
+            InternalCalls.RenderSpherePtr = (delegate* unmanaged<nint, nint, void>)table[20];
+            InternalCalls.RenderObbPtr = (delegate* unmanaged<nint, nint, void>)table[21];
+            InternalCalls.RenderCapsulePtr = (delegate* unmanaged<nint, nint, void>)table[22];
+            InternalCalls.RenderLinePtr = (delegate* unmanaged<nint, nint, void>)table[23];
+            InternalCalls.LoadTexturePtr = (delegate* unmanaged<string, out uint, out uint, nint>)table[24];
+            InternalCalls.UnloadTexturePtr = (delegate* unmanaged<nint, void>)table[25];
+            InternalCalls.RegisterTexturePtr = (delegate* unmanaged<nint, nint>)table[26];
+            InternalCalls.GetRepositoryAddressPtr = (delegate* unmanaged<string, nint>)table[27];
+            InternalCalls.GetGameRevisionPtr = (delegate* unmanaged<sbyte*>)table[28];
+            InternalCalls.GetLogStatisticsPtr = (delegate* unmanaged<LogStatistics*, void>)table[29];
+            InternalCalls.NotifySingletonsChangedPtr = (delegate* unmanaged<void>)table[30];
+            InternalCalls.RecordTraceSpanPtr = (delegate* unmanaged<string, long, long, void>)table[31];
+            InternalCalls.HookAddManagedSubscriberPtr = (delegate* unmanaged<nint, bool>)table[32];
+            InternalCalls.HookRemoveManagedSubscriberPtr = (delegate* unmanaged<nint, void>)table[33];
+            InternalCalls.GetHookStatisticsPtr = (delegate* unmanaged<HookStatistics*, uint, uint>)table[34];
+            InternalCalls.ResetHookStatisticsPtr = (delegate* unmanaged<void>)table[35];
+            InternalCalls.RegisterHookCounterPtr = (delegate* unmanaged<string, uint>)table[36];
+            InternalCalls.RecordHookSamplePtr = (delegate* unmanaged<uint, ulong, void>)table[37];
+            InternalCalls.GetFrameBudgetConfigPtr = (delegate* unmanaged<FrameBudgetConfig*, void>)table[38];
+            InternalCalls.GetNativeCompanionsPtr = (delegate* unmanaged<out uint, NativeCompanion*>)table[39];
+            InternalCalls.GetMemoryStatisticsPtr = (delegate* unmanaged<MemoryStatistics*, uint, uint>)table[40];
+            InternalCalls.UnregisterHookCounterPtr = (delegate* unmanaged<uint, void>)table[41];
+        }
+    }
+}
@@ -4,47 +4,10 @@ using SharpPluginLoader.Core.Resources.Animation;
 
 namespace SharpPluginLoader.Core
 {
-    internal static unsafe class InternalCalls
+    // The function pointer fields are generated from mhw-cs-plugin-loader/InternalCalls.json,
+    // see InternalCalls.Generated.cs and generate_internal_calls.py.
+    internal static unsafe partial class InternalCalls
     {
-#pragma warning disable CS0649 // Field is never assigned to, and will always have its default value
-        public static delegate* unmanaged<nint, void> QueueYesNoDialogPtr;
-
-        public static delegate* unmanaged<string, void> LoadChunkPtr;
-        public static delegate* unmanaged<string, nint> RequestChunkPtr;
-        public static delegate* unmanaged<nint> GetDefaultChunkPtr;
-        public static delegate* unmanaged<nint, string, nint> ChunkGetFilePtr;
-        public static delegate* unmanaged<nint, string, nint> ChunkGetFolderPtr;
-        public static delegate* unmanaged<nint, nint> FileGetContentsPtr;
-        public static delegate* unmanaged<nint, long> FileGetSizePtr;
-
-        public static delegate* unmanaged<string, float, float, ref float, int, bool> BeginTimelinePtr;
-        public static delegate* unmanaged<void> EndTimelinePtr;
-        public static delegate* unmanaged<string, ref bool, bool> BeginTimelineGroupPtr;
-        public static delegate* unmanaged<void> EndTimelineGroupPtr;
-        public static delegate* unmanaged<string, float*, int, out int, bool> TimelineTrackPtr;
-
-        public static delegate* unmanaged<string, ref uint, ref int, bool> BitfieldPtr;
-
-        public static delegate* unmanaged<string, int, void> NotificationSuccessPtr;
-        public static delegate* unmanaged<string, int, void> NotificationErrorPtr;
-        public static delegate* unmanaged<string, int, void> NotificationWarningPtr;
-        public static delegate* unmanaged<string, int, void> NotificationInfoPtr;
-        public static delegate* unmanaged<int, int, string, string, void> NotificationPtr;
-        public static delegate* unmanaged<void> RenderNotificationsPtr;
-
-        public static delegate* unmanaged<nint, nint, void> RenderSpherePtr;
-        public static delegate* unmanaged<nint, nint, void> RenderObbPtr;
-        public static delegate* unmanaged<nint, nint, void> RenderCapsulePtr;
-        public static delegate* unmanaged<nint, nint, void> RenderLinePtr;
-
-        public static delegate* unmanaged<string, out uint, out uint, nint> LoadTexturePtr;
-        public static delegate* unmanaged<nint, void> UnloadTexturePtr;
-        public static delegate* unmanaged<nint, nint> RegisterTexturePtr;
-
-        public static delegate* unmanaged<string, nint> GetRepositoryAddressPtr;
-        public static delegate* unmanaged<sbyte*> GetGameRevisionPtr;
-#pragma warning restore CS0649
-
         public static void QueueYesNoDialog(nint messagePtr) => QueueYesNoDialogPtr(messagePtr);
 
         public static void LoadChunk(string name) => LoadChunkPtr(name);
@@ -125,5 +88,31 @@ namespace SharpPluginLoader.Core
             var revision = GetGameRevisionPtr();
             return revision == null ? string.Empty : new string(revision);
         }
+
+        public static void GetLogStatistics(LogStatistics* stats) => GetLogStatisticsPtr(stats);
+
+        public static void NotifySingletonsChanged() => NotifySingletonsChangedPtr();
+
+        public static void RecordTraceSpan(string name, long start, long end) => RecordTraceSpanPtr(name, start, end);
+
+        public static bool HookAddManagedSubscriber(nint target) => HookAddManagedSubscriberPtr(target);
+
+        public static void HookRemoveManagedSubscriber(nint target) => HookRemoveManagedSubscriberPtr(target);
+
+        public static uint GetHookStatistics(HookStatistics* stats, uint capacity) => GetHookStatisticsPtr(stats, capacity);
+
+        public static void ResetHookStatistics() => ResetHookStatisticsPtr();
+
+        public static uint RegisterHookCounter(string name) => RegisterHookCounterPtr(name);
+
+        public static void RecordHookSample(uint counter, ulong elapsed) => RecordHookSamplePtr(counter, elapsed);
+
+        public static void GetFrameBudgetConfig(FrameBudgetConfig* config) => GetFrameBudgetConfigPtr(config);
+
+        public static NativeCompanion* GetNativeCompanions(out uint count) => GetNativeCompanionsPtr(out count);
+
+        public static uint GetMemoryStatistics(MemoryStatistics* stats, uint capacity) => GetMemoryStatisticsPtr(stats, capacity);
+
+        public static void UnregisterHookCounter(uint counter) => UnregisterHookCounterPtr(counter);
     }
 }
@@ -49,5 +49,49 @@ namespace SharpPluginLoader.Core
         /// </summary>
         /// <param name="message">The message to log.</param>
         public static void Error(string message) => DoLog(LogLevel.Error, message);
+
+        /// <summary>
+        /// Gets the counters of the native rate limited logger.
+        /// </summary>
+        /// <returns>A snapshot of the logging statistics.</returns>
+        public static LogStatistics GetStatistics()
+        {
+            LogStatistics stats;
+            InternalCalls.GetLogStatistics(&stats);
+            return stats;
+        }
+    }
+
+    /// <summary>
+    /// Counters of the native rate limited logger. Repeated errors on hot paths (e.g. every frame)
+    /// are collapsed or dropped instead of being written to the console and log file.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct LogStatistics
+    {
+        /// <summary>
+        /// The number of rate limited messages that were written.
+        /// </summary>
+        public ulong Emitted;
+
+        /// <summary>
+        /// The number of messages that were collapsed because they were identical to the previous one.
+        /// </summary>
+        public ulong Deduplicated;
+
+        /// <summary>
+        /// The number of messages that were dropped by the rate limiter.
+        /// </summary>
+        public ulong RateLimited;
+
+        /// <summary>
+        /// The number of "repeated N times" summaries that were written.
+        /// </summary>
+        public ulong Summaries;
+
+        /// <summary>
+        /// The number of distinct rate limited call sites that have logged at least once.
+        /// </summary>
+        public uint Sites;
     }
 }
@@ -1,4 +1,7 @@
-﻿using Reloaded.Hooks;
+﻿using System.Reflection;
+using System.Reflection.Emit;
+using System.Runtime.CompilerServices;
+using Reloaded.Hooks;
 using Reloaded.Hooks.Definitions;
 
 namespace SharpPluginLoader.Core.Memory
@@ -12,9 +15,16 @@ namespace SharpPluginLoader.Core.Memory
         /// <param name="address">The address of the function to hook</param>
         /// <param name="hook">The hook function</param>
         /// <returns>The hook object</returns>
+        /// <remarks>
+        /// Calls to the hook are timed and show up in <see cref="HookProfiler"/>
+        /// under the name of the calling assembly, the function type and the address.
+        /// Time spent in <see cref="Hook{TFunction}.Original"/> is not counted.
+        /// </remarks>
+        [MethodImpl(MethodImplOptions.NoInlining)]
         public static Hook<TFunction> Create<TFunction>(long address, TFunction hook)
         {
-            return new Hook<TFunction>(hook, address);
+            var owner = Assembly.GetCallingAssembly().GetName().Name;
+            return new Hook<TFunction>(hook, address, $"{owner}: {typeof(TFunction).Name} at 0x{address:X}");
         }
     }
 
@@ -37,7 +47,7 @@ namespace SharpPluginLoader.Core.Memory
         /// <summary>
         /// Gets the original function.
         /// </summary>
-        public TFunction Original => _hook.OriginalFunction;
+        public TFunction Original => _original;
 
         /// <summary>
         /// Gets a value indicating whether the hook is enabled.
@@ -45,15 +55,108 @@ namespace SharpPluginLoader.Core.Memory
         public bool IsEnabled => _hook.IsHookEnabled;
 
         #region Internal
-        internal Hook(TFunction hook, long address)
+        internal Hook(TFunction hook, long address, string name)
         {
-            _hook = ReloadedHooks.Instance.CreateHook(hook, address).Activate();
+            _timing = new Timing(hook);
+            _hook = ReloadedHooks.Instance.CreateHook(Instrument(_timing), address).Activate();
+            _original = ExcludeFromTiming(_hook.OriginalFunction);
+
+            // Registered last, so a hook that fails to install doesn't hold on to a counter
+            if (hook is Delegate)
+                _timing.Counter = HookProfiler.RegisterCounter(name);
+        }
+
+        // What an instrumented hook calls and the counter it records to.
+        // Public fields, so the dynamic wrapper can read them.
+        private sealed class Timing(TFunction function)
+        {
+            public readonly TFunction Function = function;
+            public uint Counter = HookProfiler.NoCounter;
+        }
+
+        // Wraps the hook in a delegate of the same type that records the time spent in it
+        private static TFunction Instrument(Timing timing)
+        {
+            if (timing.Function is not Delegate)
+                return timing.Function;
+
+            return Wrap(timing, il =>
+            {
+                il.Emit(OpCodes.Ldarg_0);
+                il.Emit(OpCodes.Ldfld, CounterField);
+                il.Emit(OpCodes.Ldloc_0);
+                il.Emit(OpCodes.Call, EndHookMethod);
+            });
+        }
+
+        // Wraps the original function so the time spent in it is left out of the hook calling it
+        private static TFunction ExcludeFromTiming(TFunction original)
+        {
+            if (original is not Delegate)
+                return original;
+
+            return Wrap(new Timing(original), il =>
+            {
+                il.Emit(OpCodes.Ldloc_0);
+                il.Emit(OpCodes.Call, EndOriginalMethod);
+            });
+        }
+
+        // Builds a delegate of the same type that calls `timing.Function` between BeginTiming and `emitEnd`.
+        // Emitted as IL rather than built from expressions, since expressions can't take pointer parameters.
+        private static TFunction Wrap(Timing timing, Action<ILGenerator> emitEnd)
+        {
+            var invoke = typeof(TFunction).GetMethod("Invoke")!;
+            var parameters = invoke.GetParameters().Select(p => p.ParameterType).ToArray();
+            var returnsValue = invoke.ReturnType != typeof(void);
+
+            var method = new DynamicMethod($"Timed_{typeof(TFunction).Name}", invoke.ReturnType,
+                [typeof(Timing), ..parameters], typeof(Timing).Module, true);
+            var il = method.GetILGenerator();
+
+            il.DeclareLocal(typeof(long)); // begin
+            if (returnsValue)
+                il.DeclareLocal(invoke.ReturnType); // result
+
+            il.Emit(OpCodes.Call, BeginTimingMethod);
+            il.Emit(OpCodes.Stloc_0);
+
+            var exit = il.BeginExceptionBlock();
+            il.Emit(OpCodes.Ldarg_0);
+            il.Emit(OpCodes.Ldfld, FunctionField);
+
+            // Argument 0 is the bound Timing, the function's own parameters follow it
+            for (var i = 1; i <= parameters.Length; i++)
+                il.Emit(OpCodes.Ldarg, (short)i);
+
+            il.Emit(OpCodes.Callvirt, invoke);
+            if (returnsValue)
+                il.Emit(OpCodes.Stloc_1);
+
+            il.Emit(OpCodes.Leave, exit);
+            il.BeginFinallyBlock();
+            emitEnd(il);
+            il.EndExceptionBlock();
+
+            if (returnsValue)
+                il.Emit(OpCodes.Ldloc_1);
+            il.Emit(OpCodes.Ret);
+
+            return (TFunction)(object)method.CreateDelegate(typeof(TFunction), timing);
         }
 
         private void ReleaseUnmanagedResources()
         {
-            if (IsEnabled)
+            // The finalizer also runs for hooks whose constructor threw
+            if (_hook is { IsHookEnabled: true })
                 _hook.Disable();
+
+            if (_timing is not null && _timing.Counter != HookProfiler.NoCounter)
+            {
+                var counter = _timing.Counter;
+                _timing.Counter = HookProfiler.NoCounter;
+                HookProfiler.UnregisterCounter(counter);
+            }
         }
 
         public void Dispose()
@@ -68,6 +171,18 @@ namespace SharpPluginLoader.Core.Memory
         }
 
         private readonly IHook<TFunction> _hook;
+        private readonly TFunction _original;
+        private readonly Timing _timing;
+
+        private static readonly FieldInfo FunctionField = typeof(Timing).GetField(nameof(Timing.Function))!;
+        private static readonly FieldInfo CounterField = typeof(Timing).GetField(nameof(Timing.Counter))!;
+
+        private static readonly MethodInfo BeginTimingMethod =
+            typeof(HookProfiler).GetMethod(nameof(HookProfiler.BeginTiming), BindingFlags.NonPublic | BindingFlags.Static)!;
+        private static readonly MethodInfo EndHookMethod =
+            typeof(HookProfiler).GetMethod(nameof(HookProfiler.EndHook), BindingFlags.NonPublic | BindingFlags.Static)!;
+        private static readonly MethodInfo EndOriginalMethod =
+            typeof(HookProfiler).GetMethod(nameof(HookProfiler.EndOriginal), BindingFlags.NonPublic | BindingFlags.Static)!;
         #endregion
     }
 }
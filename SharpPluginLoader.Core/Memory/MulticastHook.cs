@@ -0,0 +1,171 @@
+﻿using System.Collections.Concurrent;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+using System.Runtime.Intrinsics;
+
+namespace SharpPluginLoader.Core.Memory
+{
+    /// <summary>
+    /// A callback that is invoked at the entry of a hooked function.
+    /// </summary>
+    /// <param name="context">The register context at the function entry. Arguments are in Rcx, Rdx, R8 and R9
+    /// (or Xmm0-Xmm3 for floating point arguments). Changes to it are visible to the original function.</param>
+    public delegate void HookCallback(ref HookContext context);
+
+    /// <summary>
+    /// The register context at the entry of a function hooked with <see cref="MulticastHook"/>.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public unsafe struct HookContext
+    {
+        private fixed byte _xmm[16 * 16];
+        public nuint RFlags;
+        public nuint R15;
+        public nuint R14;
+        public nuint R13;
+        public nuint R12;
+        public nuint R11;
+        public nuint R10;
+        public nuint R9;
+        public nuint R8;
+        public nuint Rdi;
+        public nuint Rsi;
+        public nuint Rdx;
+        public nuint Rcx;
+        public nuint Rbx;
+        public nuint Rax;
+        public nuint Rbp;
+        public nuint Rsp;
+        public nuint Rip;
+
+        /// <summary>
+        /// Gets a reference to one of the xmm0-xmm15 registers.
+        /// </summary>
+        /// <param name="index">The index of the register</param>
+        public ref Vector128<float> Xmm(int index)
+        {
+            Ensure.IsTrue(index is >= 0 and < 16);
+            return ref Unsafe.As<byte, Vector128<float>>(ref _xmm[index * 16]);
+        }
+    }
+
+    /// <summary>
+    /// Subscribes callbacks to the entry of native functions. Unlike <see cref="Hook{TFunction}"/>, every address
+    /// is only ever detoured once by the loader, no matter how many plugins subscribe to it, and all managed
+    /// subscribers of an address are invoked from a single transition into managed code.
+    /// </summary>
+    /// <remarks>
+    /// Subscribers can inspect and modify the arguments, but cannot replace the function or change its return value.
+    /// Use <see cref="Hook.Create{TFunction}"/> for that.
+    /// </remarks>
+    public static class MulticastHook
+    {
+        /// <summary>
+        /// Subscribes a callback to the entry of a native function.
+        /// </summary>
+        /// <param name="address">The address of the function</param>
+        /// <param name="callback">The callback to invoke</param>
+        /// <param name="priority">Subscribers with a higher priority are invoked first</param>
+        /// <returns>The subscription, dispose it to unsubscribe. Null if the function could not be hooked.</returns>
+        public static HookSubscription? Subscribe(nint address, HookCallback callback, int priority = 0)
+        {
+            lock (Subscribers)
+            {
+                if (!InternalCalls.HookAddManagedSubscriber(address))
+                {
+                    Log.Error($"Failed to subscribe to 0x{address:X}");
+                    return null;
+                }
+
+                var subscription = new HookSubscription(address, callback, priority);
+                var current = Subscribers.GetValueOrDefault(address, []);
+
+                // Copy-on-write so Dispatch can read the list without locking. Descending priority,
+                // subscribers with equal priority are invoked in subscription order.
+                var index = Array.FindIndex(current, s => s.Priority < priority);
+                Subscribers[address] = index == -1
+                    ? [.. current, subscription]
+                    : [.. current[..index], subscription, .. current[index..]];
+
+                return subscription;
+            }
+        }
+
+        /// <inheritdoc cref="Subscribe(nint, HookCallback, int)"/>
+        public static HookSubscription? Subscribe(long address, HookCallback callback, int priority = 0)
+        {
+            return Subscribe((nint)address, callback, priority);
+        }
+
+        internal static void Unsubscribe(HookSubscription subscription)
+        {
+            lock (Subscribers)
+            {
+                if (!Subscribers.TryGetValue(subscription.Address, out var current))
+                    return;
+
+                var remaining = Array.FindAll(current, s => s != subscription);
+                if (remaining.Length == current.Length)
+                    return;
+
+                if (remaining.Length == 0)
+                    Subscribers.TryRemove(subscription.Address, out _);
+                else
+                    Subscribers[subscription.Address] = remaining;
+
+                InternalCalls.HookRemoveManagedSubscriber(subscription.Address);
+            }
+        }
+
+        [UnmanagedCallersOnly]
+        internal static unsafe void Dispatch(nint target, HookContext* context)
+        {
+            if (!Subscribers.TryGetValue(target, out var subscribers))
+                return;
+
+            foreach (var subscriber in subscribers)
+            {
+                try
+                {
+                    subscriber.Callback(ref *context);
+                }
+                catch (Exception e)
+                {
+                    Log.Error($"Exception in hook subscriber for 0x{target:X}: {e}");
+                }
+            }
+        }
+
+        private static readonly ConcurrentDictionary<nint, HookSubscription[]> Subscribers = new();
+    }
+
+    /// <summary>
+    /// Represents a subscription created by <see cref="MulticastHook.Subscribe(nint, HookCallback, int)"/>.
+    /// </summary>
+    public sealed class HookSubscription : IDisposable
+    {
+        /// <summary>
+        /// The address of the hooked function.
+        /// </summary>
+        public nint Address { get; }
+
+        /// <summary>
+        /// The priority of the subscription.
+        /// </summary>
+        public int Priority { get; }
+
+        internal HookCallback Callback { get; }
+
+        internal HookSubscription(nint address, HookCallback callback, int priority)
+        {
+            Address = address;
+            Callback = callback;
+            Priority = priority;
+        }
+
+        /// <summary>
+        /// Unsubscribes the callback.
+        /// </summary>
+        public void Dispose() => MulticastHook.Unsubscribe(this);
+    }
+}
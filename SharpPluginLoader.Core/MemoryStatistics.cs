@@ -0,0 +1,153 @@
+﻿using System.Diagnostics;
+using System.Runtime.InteropServices;
+
+namespace SharpPluginLoader.Core
+{
+    /// <summary>
+    /// Provides access to the memory the loader itself holds, broken down by subsystem.
+    /// Snapshots of the live bytes can be taken to find growth, e.g. across quest loads.
+    /// The loader takes a snapshot whenever a quest is entered or left.
+    /// </summary>
+    public static unsafe class MemoryProfiler
+    {
+        private const uint MaxTags = 32;
+        private const int MaxSnapshots = 16;
+
+        /// <summary>
+        /// The snapshots taken so far, oldest first. Only the most recent 16 are kept.
+        /// </summary>
+        public static IReadOnlyList<MemorySnapshot> Snapshots
+        {
+            get
+            {
+                lock (SnapshotHistory)
+                    return [.. SnapshotHistory];
+            }
+        }
+
+        /// <summary>
+        /// Gets the memory statistics of all tags.
+        /// </summary>
+        public static MemoryStatistics[] GetStatistics()
+        {
+            var stats = stackalloc MemoryStatistics[(int)MaxTags];
+            var count = InternalCalls.GetMemoryStatistics(stats, MaxTags);
+            return new ReadOnlySpan<MemoryStatistics>(stats, (int)count).ToArray();
+        }
+
+        /// <summary>
+        /// Records the live bytes of every tag.
+        /// </summary>
+        /// <param name="label">A label to identify the snapshot by</param>
+        public static MemorySnapshot TakeSnapshot(string label)
+        {
+            var snapshot = new MemorySnapshot(label, DateTime.Now,
+                GetStatistics().ToDictionary(s => s.Tag, s => s.LiveBytes));
+
+            lock (SnapshotHistory)
+            {
+                if (SnapshotHistory.Count == MaxSnapshots)
+                    SnapshotHistory.RemoveAt(0);
+
+                SnapshotHistory.Add(snapshot);
+            }
+
+            return snapshot;
+        }
+
+        /// <summary>
+        /// Gets the allocation rate of a tag, averaged over the last second.
+        /// Rates are only updated while something calls this, like the memory panel.
+        /// </summary>
+        /// <param name="tag">The name of the tag</param>
+        /// <returns>Allocations and allocated bytes per second</returns>
+        public static (double Allocations, double Bytes) GetAllocationRate(string tag)
+        {
+            UpdateRates();
+            return Rates.TryGetValue(tag, out var rate) ? rate : (0.0, 0.0);
+        }
+
+        private static void UpdateRates()
+        {
+            var elapsed = Stopwatch.GetElapsedTime(_lastSample);
+            if (elapsed < TimeSpan.FromSeconds(1))
+                return;
+
+            var stats = GetStatistics();
+            var seconds = elapsed.TotalSeconds;
+
+            foreach (var stat in stats)
+            {
+                if (PreviousStatistics.TryGetValue(stat.Tag, out var previous))
+                {
+                    Rates[stat.Tag] = ((stat.Allocations - previous.Allocations) / seconds,
+                        (stat.AllocatedBytes - previous.AllocatedBytes) / seconds);
+                }
+
+                PreviousStatistics[stat.Tag] = stat;
+            }
+
+            _lastSample = Stopwatch.GetTimestamp();
+        }
+
+        private static readonly List<MemorySnapshot> SnapshotHistory = [];
+        private static readonly Dictionary<string, MemoryStatistics> PreviousStatistics = [];
+        private static readonly Dictionary<string, (double Allocations, double Bytes)> Rates = [];
+        private static long _lastSample;
+    }
+
+    /// <summary>
+    /// The live bytes of every tag at a point in time.
+    /// </summary>
+    /// <param name="Label">The label the snapshot was taken with</param>
+    /// <param name="Time">The time the snapshot was taken at</param>
+    /// <param name="LiveBytes">The live bytes, by tag</param>
+    public sealed record MemorySnapshot(string Label, DateTime Time, IReadOnlyDictionary<string, ulong> LiveBytes)
+    {
+        /// <summary>
+        /// Gets how much a tag has grown (or shrunk) since this snapshot was taken.
+        /// </summary>
+        public long GetDelta(in MemoryStatistics current) =>
+            (long)current.LiveBytes - (long)LiveBytes.GetValueOrDefault(current.Tag);
+    }
+
+    /// <summary>
+    /// The memory statistics of a single subsystem of the loader.
+    /// GPU resources are included with their (estimated) size.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public unsafe struct MemoryStatistics
+    {
+        private readonly sbyte* _tag;
+
+        /// <summary>
+        /// The number of bytes currently held.
+        /// </summary>
+        public ulong LiveBytes;
+
+        /// <summary>
+        /// The highest number of bytes held at once.
+        /// </summary>
+        public ulong PeakBytes;
+
+        /// <summary>
+        /// The number of allocations since startup.
+        /// </summary>
+        public ulong Allocations;
+
+        /// <summary>
+        /// The number of frees since startup.
+        /// </summary>
+        public ulong Frees;
+
+        /// <summary>
+        /// The number of bytes allocated since startup.
+        /// </summary>
+        public ulong AllocatedBytes;
+
+        /// <summary>
+        /// The name of the tag.
+        /// </summary>
+        public readonly string Tag => _tag == null ? string.Empty : new string(_tag);
+    }
+}
@@ -19,9 +19,10 @@ namespace SharpPluginLoader.Core
         private delegate void TriggerOnMhMainCtorDelegate();
         private delegate void ReloadPluginsDelegate();
         private delegate void ReloadPluginDelegate(string pluginName);
-        private delegate void UploadInternalCallsDelegate(InternalCall* internalCalls, uint internalCallsCount);
+        private delegate void UploadInternalCallsDelegate(nint* table, uint count, uint tableHash);
         private delegate nint FindCoreMethodDelegate(string typeName, string methodName);
         private delegate void InitializeDelegate();
+        private delegate void FindCoreMethodsDelegate(sbyte** typeNames, sbyte** methodNames, nint* functionPointers, uint count);
 
         private readonly struct RetrievedMethod(string typeName, string methodName, nint functionPointer)
         {
@@ -44,6 +45,7 @@ namespace SharpPluginLoader.Core
             public nint UploadInternalCallsPtr;
             public nint FindCoreMethodPtr;
             public nint InitializePtr;
+            public nint FindCoreMethodsPtr;
         }
 
         private static readonly Dictionary<int, RetrievedMethod> RetrievedMethods = [];
@@ -72,6 +74,7 @@ namespace SharpPluginLoader.Core
             {
                 PlaceNativeDlls();
                 AddressRepository.Initialize();
+                FrameBudget.Initialize();
 
                 Task.WaitAll([
                     Task.Run(SingletonManager.Initialize),
@@ -107,7 +110,8 @@ namespace SharpPluginLoader.Core
                 new ReloadPluginDelegate(ReloadPlugin),
                 new UploadInternalCallsDelegate(InternalCallManager.UploadInternalCalls),
                 new FindCoreMethodDelegate(FindCoreMethod),
-                new InitializeDelegate(Initialize)
+                new InitializeDelegate(Initialize),
+                new FindCoreMethodsDelegate(FindCoreMethods)
             ]);
 
             pointers->ShutdownPtr = Marshal.GetFunctionPointerForDelegate(NativeCallbacks[0]);
@@ -119,6 +123,7 @@ namespace SharpPluginLoader.Core
             pointers->UploadInternalCallsPtr = Marshal.GetFunctionPointerForDelegate(NativeCallbacks[6]);
             pointers->FindCoreMethodPtr = Marshal.GetFunctionPointerForDelegate(NativeCallbacks[7]);
             pointers->InitializePtr = Marshal.GetFunctionPointerForDelegate(NativeCallbacks[8]);
+            pointers->FindCoreMethodsPtr = Marshal.GetFunctionPointerForDelegate(NativeCallbacks[9]);
 
             Log.Debug("[Core] Retrieved Function pointers");
         }
@@ -130,10 +135,12 @@ namespace SharpPluginLoader.Core
 
         public static void TriggerOnPreMain()
         {
-            PluginManager.Instance.LoadPlugins(PluginManager.DefaultPluginDirectory);
+            using (new TraceScope("PluginManager.LoadPlugins"))
+                PluginManager.Instance.LoadPlugins(PluginManager.DefaultPluginDirectory);
 
             // Invoke OnPreMain for even subscribers.
-            PluginManager.Instance.InvokeOnPreMain();
+            using (new TraceScope("PluginManager.InvokeOnPreMain"))
+                PluginManager.Instance.InvokeOnPreMain();
         }
 
         public static void TriggerOnWinMain()
@@ -145,7 +152,8 @@ namespace SharpPluginLoader.Core
         {
             SingletonManager.MapSingletons();
 
-            PluginManager.Instance.InvokeOnLoad();
+            using (new TraceScope("PluginManager.InvokeOnLoad"))
+                PluginManager.Instance.InvokeOnLoad();
         }
 
         public static void ReloadPlugins()
@@ -206,6 +214,12 @@ namespace SharpPluginLoader.Core
             }
         }
 
+        public static void FindCoreMethods(sbyte** typeNames, sbyte** methodNames, nint* functionPointers, uint count)
+        {
+            for (var i = 0; i < count; i++)
+                functionPointers[i] = FindCoreMethod(new string(typeNames[i]), new string(methodNames[i]));
+        }
+
         [UnmanagedCallersOnly]
         public static void OnUpdate(float deltaTime)
         {
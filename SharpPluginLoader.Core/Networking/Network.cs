@@ -75,8 +75,8 @@ namespace SharpPluginLoader.Core.Networking
 
         internal static void Initialize()
         {
-            _sendPacketHook = new Hook<SendPacketDelegate>(SendPacketHook, AddressRepository.Get("Network:SendPacket"));
-            _receivePacketHook = new Hook<ReceivePacketDelegate>(ReceivePacketHook, AddressRepository.Get("Network:ReceivePacket"));
+            _sendPacketHook = Hook.Create<SendPacketDelegate>(AddressRepository.Get("Network:SendPacket"), SendPacketHook);
+            _receivePacketHook = Hook.Create<ReceivePacketDelegate>(AddressRepository.Get("Network:ReceivePacket"), ReceivePacketHook);
         }
 
         private delegate void SendPacketDelegate(nint instance, nint packet, uint dst, uint option, uint sessionIndex);
@@ -40,94 +40,9 @@ namespace SharpPluginLoader.Core
         }
 
         private delegate void UploadInternalCallsDelegate(IDictionary<string, nint> icalls, IDictionary<string, nint> addressCache);
-        private static readonly TimeSpan EventCooldown = TimeSpan.FromMilliseconds(500);
         private readonly Dictionary<string, PluginContext> _contexts = [];
-        private readonly FileSystemWatcher _watcher;
-        private readonly object _lock = new();
-        private readonly Dictionary<string, DateTime> _lastEventTimes = [];
-#if DEBUG
-        private readonly List<FileSystemWatcher> _symlinkWatchers = [];
-#endif
-
-        public PluginManager()
-        {
-            _watcher = new FileSystemWatcher("nativePC/plugins/CSharp");
-            _watcher.IncludeSubdirectories = true;
-
-            _watcher.Created += (_, args) =>
-            {
-                if (IsPlugin(args.FullPath))
-                {
-                    LoadPlugin(args.FullPath);
-                    AddressRepository.SavePluginRecords();
-                }
-            };
-            _watcher.Deleted += (_, args) => { if (IsPlugin(args.FullPath)) UnloadPlugin(args.FullPath); };
-            _watcher.Changed += (_, args) =>
-            {
-                if (!IsPlugin(args.FullPath) || args.ChangeType != WatcherChangeTypes.Changed)
-                    return;
-
-                lock (_lock)
-                {
-                    var lastEventTime = _lastEventTimes.GetValueOrDefault(args.FullPath);
-                    var nowTime = File.GetLastWriteTime(args.FullPath);
-                    if (nowTime - lastEventTime < EventCooldown)
-                        return;
-
-                    _lastEventTimes[args.FullPath] = nowTime;
-                }
-                
-                ReloadPlugin(args.FullPath, true);
-            };
-
-            _watcher.NotifyFilter = NotifyFilters.LastWrite;
-            _watcher.EnableRaisingEvents = true;
-
-#if DEBUG
-            var dirInfo = new DirectoryInfo("nativePC/plugins/CSharp");
-            foreach (var info in dirInfo.EnumerateFileSystemInfos("*", SearchOption.AllDirectories))
-            {
-                if (info.Attributes.HasFlag(FileAttributes.ReparsePoint | FileAttributes.Directory))
-                {
-                    var symlinkWatcher = new FileSystemWatcher(info.LinkTarget!);
-                    symlinkWatcher.IncludeSubdirectories = true;
-
-                    symlinkWatcher.Created += (_, args) =>
-                    {
-                        if (IsPlugin(args.FullPath))
-                        {
-                            LoadPlugin(args.FullPath);
-                            AddressRepository.SavePluginRecords();
-                        }
-                    };
-                    symlinkWatcher.Deleted += (_, args) => { if (IsPlugin(args.FullPath)) UnloadPlugin(args.FullPath); };
-                    symlinkWatcher.Changed += (_, args) =>
-                    {
-                        if (!IsPlugin(args.FullPath) || args.ChangeType != WatcherChangeTypes.Changed)
-                            return;
-
-                        lock (_lock)
-                        {
-                            var lastEventTime = _lastEventTimes.GetValueOrDefault(args.FullPath);
-                            var nowTime = File.GetLastWriteTime(args.FullPath);
-                            if (nowTime - lastEventTime < EventCooldown)
-                                return;
-
-                            _lastEventTimes[args.FullPath] = nowTime;
-                        }
-
-                        ReloadPlugin(args.FullPath, true);
-                    };
-
-                    symlinkWatcher.NotifyFilter = NotifyFilters.LastWrite;
-                    symlinkWatcher.EnableRaisingEvents = true;
-
-                    _symlinkWatchers.Add(symlinkWatcher);
-                }
-            }
-#endif
-        }
+        private readonly Dictionary<string, NativeCompanion> _nativeCompanions = new(StringComparer.OrdinalIgnoreCase);
+        private bool _nativeCompanionsQueried;
 
         private static string ResolvePluginPath(string path)
         {
@@ -221,12 +136,17 @@ namespace SharpPluginLoader.Core
         {
             foreach (var pluginPath in Directory.GetFiles(directory, "*.dll", SearchOption.AllDirectories))
             {
-                if (IsPlugin(pluginPath))
+                if (!IsPlugin(pluginPath))
+                    continue;
+
+                using (new TraceScope($"LoadPlugin {Path.GetFileNameWithoutExtension(pluginPath)}"))
                     LoadPlugin(pluginPath);
             }
 
             // After all plugins are loaded, we can save the plugin records cache.
             AddressRepository.SavePluginRecords();
+
+            ReleaseUnclaimedNativeCompanions();
         }
 
         /// <summary>
@@ -361,7 +281,7 @@ namespace SharpPluginLoader.Core
             // Figures out which events the plugin subscribes to and populate the PluginData object.
             PopulateEventSubscriptions(plugin, pluginData);
 
-            var (icalls, nativePlugin) = GetNativeInternalCalls(assembly, plugin, Path.ChangeExtension(absPath, ".Native.dll"));
+            var (icalls, nativePlugin) = GetNativeInternalCalls(plugin, Path.ChangeExtension(absPath, ".Native.dll"));
             TryUploadInternalCalls(assembly, plugin, icalls, AddressRepository.GetPluginRecords());
 
             lock (_contexts)
@@ -380,8 +300,22 @@ namespace SharpPluginLoader.Core
             return;
         }
 
-        private static unsafe (Dictionary<string, nint>, nint) GetNativeInternalCalls(Assembly assembly, IPlugin plugin, string path)
+        private unsafe (Dictionary<string, nint>, nint) GetNativeInternalCalls(IPlugin plugin, string path)
         {
+            // Companions are preloaded by the native plugin host, this only falls back to loading
+            // them here if the host didn't see them (e.g. when a plugin is added or reloaded later).
+            if (TryClaimNativeCompanion(path, out var companion))
+            {
+                if (companion.Module == 0)
+                    return ([], 0); // The native side already logged why
+
+                var calls = new Dictionary<string, nint>(companion.InternalCalls.Length);
+                foreach (var icall in companion.InternalCalls)
+                    calls[icall.Name] = icall.FunctionPointer;
+
+                return (calls, companion.Module);
+            }
+
             if (!File.Exists(path))
             {
                 return ([], 0);
@@ -426,6 +360,49 @@ namespace SharpPluginLoader.Core
             return (icallMap, nativePlugin);
         }
 
+        private bool TryClaimNativeCompanion(string path, out NativeCompanion companion)
+        {
+            lock (_nativeCompanions)
+            {
+                QueryNativeCompanions();
+
+                // Each companion is only handed out once, the plugin context owns it afterwards
+                return _nativeCompanions.Remove(Path.GetFullPath(path), out companion);
+            }
+        }
+
+        private void ReleaseUnclaimedNativeCompanions()
+        {
+            lock (_nativeCompanions)
+            {
+                QueryNativeCompanions();
+
+                foreach (var (path, companion) in _nativeCompanions)
+                {
+                    if (companion.Module == 0)
+                        continue;
+
+                    Log.Debug($"Native companion {path} has no loaded plugin, unloading it");
+                    WinApi.FreeLibrary(companion.Module);
+                }
+
+                _nativeCompanions.Clear();
+            }
+        }
+
+        // Blocks until the native plugin host is done loading, must be called with _nativeCompanions locked
+        private unsafe void QueryNativeCompanions()
+        {
+            if (_nativeCompanionsQueried)
+                return;
+
+            _nativeCompanionsQueried = true;
+
+            var companions = InternalCalls.GetNativeCompanions(out var count);
+            for (var i = 0; i < count; i++)
+                _nativeCompanions[Path.GetFullPath(companions[i].Path)] = companions[i];
+        }
+
         private static unsafe void TryUploadInternalCalls(Assembly assembly, IPlugin plugin,
             IDictionary<string, nint> nativeICalls, IDictionary<string, nint> addressCache)
         {
@@ -497,11 +474,19 @@ namespace SharpPluginLoader.Core
 
         public void InvokeOnUpdate(float deltaTime)
         {
+            // The main update is the only callback that runs exactly once per frame
+            FrameBudget.EndFrame();
+
             lock (_contexts)
             {
                 foreach (var context in _contexts.Values.Where(context => context.Data.OnUpdate))
                 {
-                    context.Plugin.OnUpdate(deltaTime);
+                    var timings = FrameBudget.Get(context.Plugin);
+                    if (timings.IsSuspended)
+                        continue;
+
+                    using (timings.Measure(FrameCallback.OnUpdate))
+                        context.Plugin.OnUpdate(deltaTime);
                 }
             }
         }
@@ -521,7 +506,15 @@ namespace SharpPluginLoader.Core
 
         public void ReloadPlugin(string pluginPath, bool updatePluginCache = false)
         {
+            // Reloads are requested by the native plugin watcher for any dll that changed
+            var exists = File.Exists(pluginPath);
+            if (exists && !IsPlugin(pluginPath))
+                return;
+
             UnloadPlugin(pluginPath);
+            if (!exists)
+                return;
+
             LoadPlugin(pluginPath);
             var context = GetPluginContextFromPath(pluginPath);
             if (context != null)
@@ -542,7 +535,10 @@ namespace SharpPluginLoader.Core
             lock (_contexts)
             {
                 foreach (var context in _contexts.Values)
+                {
+                    FrameBudget.Remove(context.Plugin);
                     context.Dispose();
+                }
                 _contexts.Clear();
             }
         }
@@ -571,6 +567,7 @@ namespace SharpPluginLoader.Core
                     return;
 
                 _contexts[key].Plugin.OnUnload();
+                FrameBudget.Remove(_contexts[key].Plugin);
                 _contexts[key].Dispose();
                 _contexts.Remove(key);
             }
@@ -66,90 +66,93 @@ namespace SharpPluginLoader.Core
 
         internal static void Initialize()
         {
+            // These only observe the quest state changes, so they share the loader's
+            // multicast hooks instead of each installing their own detour.
+
             // AcceptQuest: 141b64be0 (When you accept a quest)
-            _acceptQuestHook = Hook.Create<AcceptQuest>(AddressRepository.Get("Quest:AcceptQuest"), AcceptQuestHook);
+            MulticastHook.Subscribe(AddressRepository.Get("Quest:AcceptQuest"), AcceptQuestHook);
 
             // EnterQuest: 141b699a0 (When you arrive in the quest)
-            _enterQuestHook = Hook.Create<EnterQuest>(AddressRepository.Get("Quest:EnterQuest"), EnterQuestHook);
+            MulticastHook.Subscribe(AddressRepository.Get("Quest:EnterQuest"), EnterQuestHook);
 
             // ReturnFromQuest: 141b6f600 (When you click return from quest)
-            _returnFromQuestHook = Hook.Create<ReturnFromQuest>(AddressRepository.Get("Quest:ReturnFromQuest"), ReturnFromQuestHook);
+            MulticastHook.Subscribe(AddressRepository.Get("Quest:ReturnFromQuest"), ReturnFromQuestHook);
 
             // LeaveQuest: 141b660d0 (Return/Abandon/Fail/Complete)
-            _leaveQuestHook = Hook.Create<LeaveQuest>(AddressRepository.Get("Quest:LeaveQuest"), LeaveQuestHook);
+            MulticastHook.Subscribe(AddressRepository.Get("Quest:LeaveQuest"), LeaveQuestHook);
 
             // AbandonQuest: 141b707a0 (When you click abandon quest)
-            _abandonQuestHook = Hook.Create<AbandonQuest>(AddressRepository.Get("Quest:AbandonQuest"), AbandonQuestHook);
+            MulticastHook.Subscribe(AddressRepository.Get("Quest:AbandonQuest"), AbandonQuestHook);
 
             // CancelQuest: 141b655a0 (When you cancel the quest before entering)
-            _cancelQuestHook = Hook.Create<CancelQuest>(AddressRepository.Get("Quest:CancelQuest"), CancelQuestHook);
+            MulticastHook.Subscribe(AddressRepository.Get("Quest:CancelQuest"), CancelQuestHook);
 
             // EndQuest: 141b646c0 (When you complete/fail the quest)
-            _endQuestHook = Hook.Create<EndQuest>(AddressRepository.Get("Quest:EndQuest"), EndQuestHook);
+            MulticastHook.Subscribe(AddressRepository.Get("Quest:EndQuest"), EndQuestHook);
 
             // DepartOnQuest: 141b69140 (When you click depart on quest)
-            _departOnQuestHook = Hook.Create<DepartOnQuest>(AddressRepository.Get("Quest:DepartOnQuest"), DepartOnQuestHook);
+            MulticastHook.Subscribe(AddressRepository.Get("Quest:DepartOnQuest"), DepartOnQuestHook);
         }
 
 
-        private static void AcceptQuestHook(nint questMgr, int questId, bool unk)
+        // void AcceptQuest(nint questMgr, int questId, bool unk)
+        private static void AcceptQuestHook(ref HookContext ctx)
         {
+            var questId = (int)ctx.Rdx;
             foreach (var plugin in PluginManager.Instance.GetPlugins(p => p.OnQuestAccept))
                 plugin.OnQuestAccept(questId);
-
-            _acceptQuestHook.Original(questMgr, questId, unk);
         }
 
-        private static void EnterQuestHook(nint questMgr)
+        // void EnterQuest(nint questMgr)
+        private static void EnterQuestHook(ref HookContext ctx)
         {
+            MemoryProfiler.TakeSnapshot($"Enter quest {CurrentQuestId}");
+
             foreach (var plugin in PluginManager.Instance.GetPlugins(p => p.OnQuestEnter))
                 plugin.OnQuestEnter(CurrentQuestId);
-
-            _enterQuestHook.Original(questMgr);
         }
 
-        private static void LeaveQuestHook(nint questMgr)
+        // void LeaveQuest(nint questMgr)
+        private static void LeaveQuestHook(ref HookContext ctx)
         {
+            MemoryProfiler.TakeSnapshot($"Leave quest {CurrentQuestId}");
+
             foreach (var plugin in PluginManager.Instance.GetPlugins(p => p.OnQuestLeave))
                 plugin.OnQuestLeave(CurrentQuestId);
-
-            _leaveQuestHook.Original(questMgr);
         }
 
-        private static void AbandonQuestHook(nint questMgr, uint unk)
+        // void AbandonQuest(nint questMgr, uint unk)
+        private static void AbandonQuestHook(ref HookContext ctx)
         {
             foreach (var plugin in PluginManager.Instance.GetPlugins(p => p.OnQuestAbandon))
                 plugin.OnQuestAbandon(CurrentQuestId);
-
-            _abandonQuestHook.Original(questMgr, unk);
         }
 
-        private static void ReturnFromQuestHook(nint questMgr)
+        // void ReturnFromQuest(nint questMgr)
+        private static void ReturnFromQuestHook(ref HookContext ctx)
         {
             foreach (var plugin in PluginManager.Instance.GetPlugins(p => p.OnQuestReturn))
                 plugin.OnQuestReturn(CurrentQuestId);
-
-            _returnFromQuestHook.Original(questMgr);
         }
 
-        private static void CancelQuestHook(nint questMgr)
+        // void CancelQuest(nint questMgr)
+        private static void CancelQuestHook(ref HookContext ctx)
         {
             foreach (var plugin in PluginManager.Instance.GetPlugins(p => p.OnQuestCancel))
                 plugin.OnQuestCancel(CurrentQuestId);
-
-            _cancelQuestHook.Original(questMgr);
         }
 
-        private static void DepartOnQuestHook(nint questMgr, bool unk)
+        // void DepartOnQuest(nint questMgr, bool unk)
+        private static void DepartOnQuestHook(ref HookContext ctx)
         {
             foreach (var plugin in PluginManager.Instance.GetPlugins(p => p.OnQuestDepart))
                 plugin.OnQuestDepart(CurrentQuestId);
-
-            _departOnQuestHook.Original(questMgr, unk);
         }
 
-        private static void EndQuestHook(nint questMgr, bool unk1, nint frames, QuestEndReason reason)
+        // void EndQuest(nint questMgr, bool unk1, nint frames, QuestEndReason reason)
+        private static void EndQuestHook(ref HookContext ctx)
         {
+            var reason = (QuestEndReason)(uint)ctx.R9;
             switch (reason)
             {
                 case QuestEndReason.Complete:
@@ -168,29 +171,10 @@ namespace SharpPluginLoader.Core
                     Log.Debug($"Unknown quest end reason: {reason}");
                     break;
             }
-
-            _endQuestHook.Original(questMgr, unk1, frames, reason);
         }
 
-        private static Hook<AcceptQuest> _acceptQuestHook = null!;
-        private static Hook<EnterQuest> _enterQuestHook = null!;
-        private static Hook<LeaveQuest> _leaveQuestHook = null!;
-        private static Hook<AbandonQuest> _abandonQuestHook = null!;
-        private static Hook<ReturnFromQuest> _returnFromQuestHook = null!;
-        private static Hook<CancelQuest> _cancelQuestHook = null!;
-        private static Hook<DepartOnQuest> _departOnQuestHook = null!;
-        private static Hook<EndQuest> _endQuestHook = null!;
         private static readonly NativeFunction<nint, int, int, nint> GetQuestNameFunc = new(AddressRepository.Get("Quest:GetQuestName"));
 
-        private delegate void AcceptQuest(nint questMgr, int questId, bool unk);
-        private delegate void EnterQuest(nint questMgr);
-        private delegate void LeaveQuest(nint questMgr);
-        private delegate void AbandonQuest(nint questMgr, uint unk);
-        private delegate void ReturnFromQuest(nint questMgr);
-        private delegate void CancelQuest(nint questMgr);
-        private delegate void DepartOnQuest(nint questMgr, bool unk);
-        private delegate void EndQuest(nint questMgr, bool unk1, nint frames, QuestEndReason reason);
-
         private enum QuestEndReason : uint
         {
             Complete = 3,
@@ -0,0 +1,74 @@
+﻿using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+
+namespace SharpPluginLoader.Core.Rendering;
+
+/// <summary>
+/// An expandable buffer that primitives are submitted into. Storage is allocated in fixed size chunks
+/// that never move, so any number of threads can submit while the buffer grows.
+/// Chunks are kept once allocated and reused every frame.
+/// </summary>
+internal sealed unsafe class PrimitiveBuffer<T> where T : unmanaged
+{
+    public const int ChunkShift = 12;
+    public const int ChunkSize = 1 << ChunkShift;
+    public const int MaxChunks = 256;
+
+    private readonly T** _chunks = (T**)NativeMemory.AllocZeroed(MaxChunks, (nuint)sizeof(T*));
+    private readonly object _growLock = new();
+    private int _chunkCount;
+    private int _count;
+    private bool _warnedFull;
+
+    /// <summary>
+    /// The chunk table, read by the native renderer.
+    /// </summary>
+    public T** Chunks => _chunks;
+
+    /// <summary>
+    /// The number of primitives submitted this frame.
+    /// </summary>
+    public int Count => Math.Min(Volatile.Read(ref _count), Volatile.Read(ref _chunkCount) * ChunkSize);
+
+    [MethodImpl(MethodImplOptions.AggressiveInlining)]
+    public void Add(in T item)
+    {
+        var index = Interlocked.Increment(ref _count) - 1;
+        var chunk = index >> ChunkShift;
+        if (chunk >= Volatile.Read(ref _chunkCount) && !Grow(chunk))
+            return;
+
+        _chunks[chunk][index & (ChunkSize - 1)] = item;
+    }
+
+    public void Clear()
+    {
+        _count = 0;
+    }
+
+    [MethodImpl(MethodImplOptions.NoInlining)]
+    private bool Grow(int chunk)
+    {
+        if (chunk >= MaxChunks)
+        {
+            if (!_warnedFull)
+            {
+                _warnedFull = true;
+                Log.Warn($"[Primitives] More than {MaxChunks * ChunkSize} {typeof(T).Name}s submitted in one frame, the rest are dropped");
+            }
+
+            return false;
+        }
+
+        lock (_growLock)
+        {
+            while (_chunkCount <= chunk)
+            {
+                _chunks[_chunkCount] = (T*)NativeMemory.Alloc(ChunkSize, (nuint)sizeof(T));
+                Volatile.Write(ref _chunkCount, _chunkCount + 1);
+            }
+        }
+
+        return true;
+    }
+}
@@ -26,8 +26,7 @@ public static class Primitives
     {
         var sphere = new MtSphere { Center = position, Radius = radius };
         var color4 = (Vector4)color;
-        var index = Interlocked.Increment(ref _sphereIndex) - 1;
-        Spheres[index] = new ColoredSphere { Sphere = sphere, Color = color4 };
+        Spheres.Add(new ColoredSphere { Sphere = sphere, Color = color4 });
     }
 
     /// <summary>
@@ -40,8 +39,7 @@ public static class Primitives
     public static void RenderSphere(Vector3 position, float radius, Vector4 color)
     {
         var sphere = new MtSphere { Center = position, Radius = radius };
-        var index = Interlocked.Increment(ref _sphereIndex) - 1;
-        Spheres[index] = new ColoredSphere { Sphere = sphere, Color = color };
+        Spheres.Add(new ColoredSphere { Sphere = sphere, Color = color });
     }
 
     /// <summary>
@@ -53,8 +51,7 @@ public static class Primitives
     public static void RenderSphere(MtSphere sphere, MtColor color)
     {
         var color4 = (Vector4)color;
-        var index = Interlocked.Increment(ref _sphereIndex) - 1;
-        Spheres[index] = new ColoredSphere { Sphere = sphere, Color = color4 };
+        Spheres.Add(new ColoredSphere { Sphere = sphere, Color = color4 });
     }
 
     /// <summary>
@@ -65,8 +62,7 @@ public static class Primitives
     [MethodImpl(MethodImplOptions.AggressiveInlining)]
     public static void RenderSphere(MtSphere sphere, Vector4 color)
     {
-        var index = Interlocked.Increment(ref _sphereIndex) - 1;
-        Spheres[index] = new ColoredSphere { Sphere = sphere, Color = color };
+        Spheres.Add(new ColoredSphere { Sphere = sphere, Color = color });
     }
 
 
@@ -79,8 +75,7 @@ public static class Primitives
     public static void RenderObb(MtObb obb, MtColor color)
     {
         var color4 = (Vector4)color;
-        var index = Interlocked.Increment(ref _obbIndex) - 1;
-        Obbs[index] = new ColoredObb { Obb = obb, Color = color4 };
+        Obbs.Add(new ColoredObb { Obb = obb, Color = color4 });
     }
 
     /// <summary>
@@ -91,8 +86,7 @@ public static class Primitives
     [MethodImpl(MethodImplOptions.AggressiveInlining)]
     public static void RenderObb(MtObb obb, Vector4 color)
     {
-        var index = Interlocked.Increment(ref _obbIndex) - 1;
-        Obbs[index] = new ColoredObb { Obb = obb, Color = color };
+        Obbs.Add(new ColoredObb { Obb = obb, Color = color });
     }
 
 
@@ -105,8 +99,7 @@ public static class Primitives
     public static void RenderCapsule(MtCapsule capsule, MtColor color)
     {
         var color4 = (Vector4)color;
-        var index = Interlocked.Increment(ref _capsuleIndex) - 1;
-        Capsules[index] = new ColoredCapsule { Capsule = capsule, Color = color4 };
+        Capsules.Add(new ColoredCapsule { Capsule = capsule, Color = color4 });
     }
 
     /// <summary>
@@ -117,8 +110,7 @@ public static class Primitives
     [MethodImpl(MethodImplOptions.AggressiveInlining)]
     public static void RenderCapsule(MtCapsule capsule, Vector4 color)
     {
-        var index = Interlocked.Increment(ref _capsuleIndex) - 1;
-        Capsules[index] = new ColoredCapsule { Capsule = capsule, Color = color };
+        Capsules.Add(new ColoredCapsule { Capsule = capsule, Color = color });
     }
 
     /// <summary>
@@ -132,8 +124,7 @@ public static class Primitives
     {
         var line = new MtLineSegment { Point1 = start, Point2 = end };
         var color4 = (Vector4)color;
-        var index = Interlocked.Increment(ref _lineIndex) - 1;
-        Lines[index] = new ColoredLine { Line = line, Color = color4 };
+        Lines.Add(new ColoredLine { Line = line, Color = color4 });
     }
 
     /// <inheritdoc cref="RenderLine(Vector3,Vector3,MtColor)"/>
@@ -141,8 +132,7 @@ public static class Primitives
     public static void RenderLine(Vector3 start, Vector3 end, Vector4 color)
     {
         var line = new MtLineSegment { Point1 = start, Point2 = end };
-        var index = Interlocked.Increment(ref _lineIndex) - 1;
-        Lines[index] = new ColoredLine { Line = line, Color = color };
+        Lines.Add(new ColoredLine { Line = line, Color = color });
     }
 
     /// <summary>
@@ -153,56 +143,47 @@ public static class Primitives
     [MethodImpl(MethodImplOptions.AggressiveInlining)]
     public static void RenderLine(MtLineSegment line, MtColor color)
     {
-        var index = Interlocked.Increment(ref _lineIndex) - 1;
-        Lines[index] = new ColoredLine { Line = line, Color = color.ToVector4() };
+        Lines.Add(new ColoredLine { Line = line, Color = color.ToVector4() });
     }
 
     /// <inheritdoc cref="RenderLine(MtLineSegment,MtColor)"/>
     [MethodImpl(MethodImplOptions.AggressiveInlining)]
     public static void RenderLine(MtLineSegment line, Vector4 color)
     {
-        var index = Interlocked.Increment(ref _lineIndex) - 1;
-        Lines[index] = new ColoredLine { Line = line, Color = color };
+        Lines.Add(new ColoredLine { Line = line, Color = color });
     }
 
     [UnmanagedCallersOnly]
     private static unsafe void RetrievePrimitives(
-        ColoredSphere** outSpheres, long* sphereCount,
-        ColoredObb** outObbs, long* obbCount,
-        ColoredCapsule** outCapsules, long* capsuleCount,
-        ColoredLine** outLines, long* lineCount)
+        ColoredSphere*** outSpheres, long* sphereCount,
+        ColoredObb*** outObbs, long* obbCount,
+        ColoredCapsule*** outCapsules, long* capsuleCount,
+        ColoredLine*** outLines, long* lineCount)
     {
-        *outSpheres = Spheres.Pointer;
-        *outObbs = Obbs.Pointer;
-        *outCapsules = Capsules.Pointer;
-        *outLines = Lines.Pointer;
-
-        *sphereCount = _sphereIndex;
-        *obbCount = _obbIndex;
-        *capsuleCount = _capsuleIndex;
-        *lineCount = _lineIndex;
+        *outSpheres = Spheres.Chunks;
+        *outObbs = Obbs.Chunks;
+        *outCapsules = Capsules.Chunks;
+        *outLines = Lines.Chunks;
+
+        *sphereCount = Spheres.Count;
+        *obbCount = Obbs.Count;
+        *capsuleCount = Capsules.Count;
+        *lineCount = Lines.Count;
     }
 
     [UnmanagedCallersOnly]
     private static void ReleasePrimitives()
     {
-        _sphereIndex = 0;
-        _obbIndex = 0;
-        _capsuleIndex = 0;
-        _lineIndex = 0;
+        Spheres.Clear();
+        Obbs.Clear();
+        Capsules.Clear();
+        Lines.Clear();
     }
 
-    private const int MaxPrimitives = 2048;
-
-    private static readonly NativeArray<ColoredSphere> Spheres = NativeArray<ColoredSphere>.Create(MaxPrimitives);
-    private static readonly NativeArray<ColoredObb> Obbs = NativeArray<ColoredObb>.Create(MaxPrimitives);
-    private static readonly NativeArray<ColoredCapsule> Capsules = NativeArray<ColoredCapsule>.Create(MaxPrimitives);
-    private static readonly NativeArray<ColoredLine> Lines = NativeArray<ColoredLine>.Create(MaxPrimitives);
-
-    private static int _sphereIndex;
-    private static int _obbIndex;
-    private static int _capsuleIndex;
-    private static int _lineIndex;
+    private static readonly PrimitiveBuffer<ColoredSphere> Spheres = new();
+    private static readonly PrimitiveBuffer<ColoredObb> Obbs = new();
+    private static readonly PrimitiveBuffer<ColoredCapsule> Capsules = new();
+    private static readonly PrimitiveBuffer<ColoredLine> Lines = new();
 }
 
 [StructLayout(LayoutKind.Explicit, Size = 0x20)]
@@ -264,7 +264,14 @@ namespace SharpPluginLoader.Core.Rendering
         internal static void Render()
         {
             foreach (var plugin in PluginManager.Instance.GetPlugins(p => p.OnRender))
-                plugin.OnRender();
+            {
+                var timings = FrameBudget.Get(plugin);
+                if (timings.IsSuspended)
+                    continue;
+
+                using (timings.Measure(FrameCallback.OnRender))
+                    plugin.OnRender();
+            }
         }
 
         [UnmanagedCallersOnly]
@@ -300,10 +307,41 @@ namespace SharpPluginLoader.Core.Rendering
                                 ref MemoryUtil.AsRef(_renderingOptionPointers.LineThickness),
                                 1.0f, 10.0f);
 
+                            ImGui.Checkbox("Expand Lines in Vertex Shader",
+                                ref MemoryUtil.AsRef(_renderingOptionPointers.LineVertexPulling));
+                            if (ImGui.IsItemHovered())
+                                ImGui.SetTooltip("Draws lines without a geometry shader, faster for large numbers of lines");
+
+                            ImGui.Checkbox("Cull Primitives",
+                                ref MemoryUtil.AsRef(_renderingOptionPointers.CullingEnabled));
+
+                            ImGui.SliderFloat("Max Draw Distance",
+                                ref MemoryUtil.AsRef(_renderingOptionPointers.MaxDrawDistance),
+                                0.0f, 50000.0f, "%.0f");
+                            if (ImGui.IsItemHovered())
+                                ImGui.SetTooltip("0 draws primitives at any distance");
+
+                            ImGui.SliderFloat("Min Screen Size",
+                                ref MemoryUtil.AsRef(_renderingOptionPointers.MinScreenSize),
+                                0.0f, 0.05f, "%.3f");
+                            if (ImGui.IsItemHovered())
+                                ImGui.SetTooltip("Fraction of the screen height a primitive must cover to be drawn");
+
+                            var cullingStats = _renderingOptionPointers.CullingStats;
+                            ImGui.TextDisabled($"Primitives drawn: {cullingStats->Drawn}, culled: {cullingStats->Culled}");
+
                             ImGui.SliderFloat("Font Scale", ref io.FontGlobalScale, 0.5f, 2.0f);
 
                             ImGui.EndMenu();
                         }
+
+                        if (ImGui.BeginMenu("Diagnostics"))
+                        {
+                            ImGui.MenuItem("Hook Statistics", null, ref _showHookStatistics);
+                            ImGui.MenuItem("Frame Budget", null, ref _showFrameBudget);
+                            ImGui.MenuItem("Memory", null, ref _showMemory);
+                            ImGui.EndMenu();
+                        }
                         ImGui.EndMenuBar();
 
                         if (ImGui.IsItemDeactivated())
@@ -314,6 +352,11 @@ namespace SharpPluginLoader.Core.Rendering
 
                     foreach (var plugin in PluginManager.Instance.GetPlugins(pluginData => pluginData.OnImGuiRender))
                     {
+                        var timings = FrameBudget.Get(plugin);
+                        if (timings.IsSuspended)
+                            continue;
+
+                        using var scope = timings.Measure(FrameCallback.OnImGuiRender);
                         if (plugin.PluginData.ImGuiWrappedInTreeNode)
                         {
                             if (ImGui.TreeNodeEx(plugin.Name,
@@ -333,8 +376,24 @@ namespace SharpPluginLoader.Core.Rendering
                 ImGui.End();
             }
 
+            if (_showHookStatistics)
+                RenderHookStatistics();
+
+            if (_showFrameBudget)
+                RenderFrameBudget();
+
+            if (_showMemory)
+                RenderMemory();
+
             foreach (var plugin in PluginManager.Instance.GetPlugins(p => p.OnImGuiFreeRender))
-                plugin.OnImGuiFreeRender();
+            {
+                var timings = FrameBudget.Get(plugin);
+                if (timings.IsSuspended)
+                    continue;
+
+                using (timings.Measure(FrameCallback.OnImGuiFreeRender))
+                    plugin.OnImGuiFreeRender();
+            }
 
 #if DEBUG
             if (_showDemo)
@@ -363,6 +422,240 @@ namespace SharpPluginLoader.Core.Rendering
             _renderingOptionPointers = *pointers;
         }
 
+        private static void RenderHookStatistics()
+        {
+            ImGui.SetNextWindowSize(new Vector2(720, 360), ImGuiCond.FirstUseEver);
+            if (ImGui.Begin("Hook Statistics", ref _showHookStatistics))
+            {
+                if (ImGui.Button("Reset"))
+                    HookProfiler.Reset();
+
+                ImGui.SameLine();
+                if (ImGui.Button("Export CSV"))
+                {
+                    HookProfiler.ExportCsv(HookStatisticsPath);
+                    Log.Info($"Hook statistics written to {HookStatisticsPath}");
+                }
+
+                const ImGuiTableFlags flags = ImGuiTableFlags.Borders | ImGuiTableFlags.RowBg
+                    | ImGuiTableFlags.Resizable | ImGuiTableFlags.ScrollY;
+
+                if (ImGui.BeginTable("HookStatisticsTable", 7, flags))
+                {
+                    ImGui.TableSetupScrollFreeze(0, 1);
+                    ImGui.TableSetupColumn("Name", ImGuiTableColumnFlags.WidthStretch);
+                    ImGui.TableSetupColumn("Calls");
+                    ImGui.TableSetupColumn("Total (ms)");
+                    ImGui.TableSetupColumn("Mean (us)");
+                    ImGui.TableSetupColumn("P50 (us)");
+                    ImGui.TableSetupColumn("P99 (us)");
+                    ImGui.TableSetupColumn("Max (us)");
+                    ImGui.TableHeadersRow();
+
+                    foreach (var stat in HookProfiler.GetStatistics())
+                    {
+                        ImGui.TableNextRow();
+                        ImGui.TableNextColumn();
+                        ImGui.TextUnformatted(stat.Name);
+                        ImGui.TableNextColumn();
+                        ImGui.Text($"{stat.Calls}");
+                        ImGui.TableNextColumn();
+                        ImGui.Text($"{stat.TotalMs:F2}");
+                        ImGui.TableNextColumn();
+                        ImGui.Text($"{stat.MeanUs:F2}");
+                        ImGui.TableNextColumn();
+                        ImGui.Text($"{stat.P50Us:F2}");
+                        ImGui.TableNextColumn();
+                        ImGui.Text($"{stat.P99Us:F2}");
+                        ImGui.TableNextColumn();
+                        ImGui.Text($"{stat.MaxUs:F2}");
+                    }
+
+                    ImGui.EndTable();
+                }
+            }
+
+            ImGui.End();
+        }
+
+        private static void RenderFrameBudget()
+        {
+            ImGui.SetNextWindowSize(new Vector2(720, 400), ImGuiCond.FirstUseEver);
+            if (ImGui.Begin("Frame Budget", ref _showFrameBudget))
+            {
+                var config = FrameBudget.Config;
+                ImGui.Text($"Default budget: {config.BudgetMs:F2} ms, action: {config.Action}, " +
+                           $"after {config.Strikes} consecutive frames. Last {FrameBudget.WindowSize} frames:");
+
+                const ImGuiTableFlags flags = ImGuiTableFlags.Borders | ImGuiTableFlags.RowBg | ImGuiTableFlags.Resizable;
+
+                if (ImGui.BeginTable("FrameBudgetTable", 5, flags))
+                {
+                    ImGui.TableSetupColumn("Plugin", ImGuiTableColumnFlags.WidthStretch);
+                    ImGui.TableSetupColumn("Avg (ms)");
+                    ImGui.TableSetupColumn("P99 (ms)");
+                    ImGui.TableSetupColumn("Max (ms)");
+                    ImGui.TableSetupColumn("Budget (ms)");
+                    ImGui.TableHeadersRow();
+
+                    foreach (var timings in FrameBudget.All)
+                    {
+                        ImGui.TableNextRow();
+                        ImGui.TableNextColumn();
+
+                        var open = ImGui.TreeNodeEx(timings.Plugin.Name, ImGuiTreeNodeFlags.SpanFullWidth);
+                        if (timings.IsSuspended)
+                        {
+                            ImGui.SameLine();
+                            ImGui.TextColored(new Vector4(1.0f, 0.4f, 0.4f, 1.0f), "(suspended)");
+                            ImGui.SameLine();
+                            if (ImGui.SmallButton($"Resume##{timings.Plugin.Key}"))
+                                timings.Resume();
+                        }
+
+                        RenderWindowColumns(timings.Total);
+                        ImGui.TableNextColumn();
+                        ImGui.Text($"{timings.BudgetMs:F2}");
+
+                        if (!open)
+                            continue;
+
+                        foreach (var callback in Enum.GetValues<FrameCallback>())
+                        {
+                            ImGui.TableNextRow();
+                            ImGui.TableNextColumn();
+                            ImGui.TextUnformatted($"  {callback}");
+                            RenderWindowColumns(timings.GetWindow(callback));
+                            ImGui.TableNextColumn();
+                        }
+
+                        ImGui.TreePop();
+                    }
+
+                    ImGui.EndTable();
+                }
+
+                // The native side times the same callbacks including the transition and the loader's own work
+                if (ImGui.CollapsingHeader("Native"))
+                {
+                    var stats = HookProfiler.GetStatistics();
+                    foreach (var (callback, counter) in FrameBudget.NativeCounters)
+                    {
+                        var index = Array.FindIndex(stats, s => s.Name == counter);
+                        if (index == -1)
+                            continue;
+
+                        var plugins = FrameBudget.All.Sum(t => t.GetWindow(callback).Average);
+                        ImGui.Text($"{callback}: {stats[index].MeanUs / 1000.0:F3} ms mean, " +
+                                   $"{stats[index].P99Us / 1000.0:F3} ms p99, " +
+                                   $"{plugins:F3} ms in plugins ({counter})");
+                    }
+                }
+            }
+
+            ImGui.End();
+        }
+
+        private static void RenderMemory()
+        {
+            ImGui.SetNextWindowSize(new Vector2(720, 360), ImGuiCond.FirstUseEver);
+            if (ImGui.Begin("Memory", ref _showMemory))
+            {
+                var snapshots = MemoryProfiler.Snapshots;
+
+                if (ImGui.Button("Take Snapshot"))
+                {
+                    MemoryProfiler.TakeSnapshot($"Manual {snapshots.Count + 1}");
+                    snapshots = MemoryProfiler.Snapshots;
+                    _memoryBaseline = snapshots.Count - 1;
+                }
+
+                ImGui.SameLine();
+                _memoryBaseline = Math.Min(_memoryBaseline, snapshots.Count - 1);
+                var preview = _memoryBaseline < 0 ? "No baseline" : snapshots[_memoryBaseline].Label;
+                ImGui.SetNextItemWidth(240);
+                if (ImGui.BeginCombo("Baseline", preview))
+                {
+                    if (ImGui.Selectable("No baseline", _memoryBaseline < 0))
+                        _memoryBaseline = -1;
+
+                    for (var i = 0; i < snapshots.Count; i++)
+                    {
+                        if (ImGui.Selectable($"{snapshots[i].Label} ({snapshots[i].Time:T})##{i}", _memoryBaseline == i))
+                            _memoryBaseline = i;
+                    }
+
+                    ImGui.EndCombo();
+                }
+
+                ImGui.Text($"Managed heap: {FormatBytes(GC.GetTotalMemory(false))}");
+
+                const ImGuiTableFlags flags = ImGuiTableFlags.Borders | ImGuiTableFlags.RowBg | ImGuiTableFlags.Resizable;
+
+                if (ImGui.BeginTable("MemoryTable", 6, flags))
+                {
+                    ImGui.TableSetupColumn("Tag", ImGuiTableColumnFlags.WidthStretch);
+                    ImGui.TableSetupColumn("Live");
+                    ImGui.TableSetupColumn("Peak");
+                    ImGui.TableSetupColumn("Allocs/s");
+                    ImGui.TableSetupColumn("Bytes/s");
+                    ImGui.TableSetupColumn("Since Baseline");
+                    ImGui.TableHeadersRow();
+
+                    foreach (var stat in MemoryProfiler.GetStatistics())
+                    {
+                        var (allocations, bytes) = MemoryProfiler.GetAllocationRate(stat.Tag);
+
+                        ImGui.TableNextRow();
+                        ImGui.TableNextColumn();
+                        ImGui.TextUnformatted(stat.Tag);
+                        ImGui.TableNextColumn();
+                        ImGui.Text(FormatBytes((long)stat.LiveBytes));
+                        ImGui.TableNextColumn();
+                        ImGui.Text(FormatBytes((long)stat.PeakBytes));
+                        ImGui.TableNextColumn();
+                        ImGui.Text($"{allocations:F1}");
+                        ImGui.TableNextColumn();
+                        ImGui.Text(FormatBytes((long)bytes));
+                        ImGui.TableNextColumn();
+
+                        if (_memoryBaseline >= 0)
+                        {
+                            var delta = snapshots[_memoryBaseline].GetDelta(stat);
+                            var color = delta > 0 ? new Vector4(1.0f, 0.4f, 0.4f, 1.0f) : new Vector4(0.6f, 1.0f, 0.6f, 1.0f);
+                            ImGui.TextColored(color, $"{(delta > 0 ? "+" : "")}{FormatBytes(delta)}");
+                        }
+                    }
+
+                    ImGui.EndTable();
+                }
+            }
+
+            ImGui.End();
+        }
+
+        private static string FormatBytes(long bytes)
+        {
+            var magnitude = Math.Abs(bytes);
+            return magnitude switch
+            {
+                >= 1 << 30 => $"{bytes / (double)(1 << 30):F2} GiB",
+                >= 1 << 20 => $"{bytes / (double)(1 << 20):F2} MiB",
+                >= 1 << 10 => $"{bytes / (double)(1 << 10):F2} KiB",
+                _ => $"{bytes} B"
+            };
+        }
+
+        private static void RenderWindowColumns(RollingWindow window)
+        {
+            ImGui.TableNextColumn();
+            ImGui.Text($"{window.Average:F3}");
+            ImGui.TableNextColumn();
+            ImGui.Text($"{window.P99:F3}");
+            ImGui.TableNextColumn();
+            ImGui.Text($"{window.Max:F3}");
+        }
+
         private static void SetupImGuiStyle()
         {
             var style = ImGui.GetStyle();
@@ -475,6 +768,10 @@ namespace SharpPluginLoader.Core.Rendering
         private static Hook<MouseUpdateDelegate> _mouseUpdateHook = null!;
         private static bool _showMenu = false;
         private static bool _showDemo = false;
+        private static bool _showHookStatistics = false;
+        private static bool _showFrameBudget = false;
+        private static bool _showMemory = false;
+        private static int _memoryBaseline = -1;
         private static RenderingOptionPointers _renderingOptionPointers;
         private static Vector2 _viewportSize;
         private static Vector2 _windowSize;
@@ -503,6 +800,7 @@ namespace SharpPluginLoader.Core.Rendering
 
         private const Key DefaultMenuKey = Key.F9;
         private const Key DefaultDemoKey = Key.F10;
+        private const string HookStatisticsPath = "nativePC/plugins/CSharp/Loader/HookStatistics.csv";
     }
 
     [StructLayout(LayoutKind.Sequential)]
@@ -510,6 +808,18 @@ namespace SharpPluginLoader.Core.Rendering
     {
         public float* LineThickness;
         public bool* DrawPrimitivesAsWireframe;
+        public bool* LineVertexPulling;
+        public bool* CullingEnabled;
+        public float* MaxDrawDistance;
+        public float* MinScreenSize;
+        public PrimitiveCullingStats* CullingStats;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    internal struct PrimitiveCullingStats
+    {
+        public uint Drawn;
+        public uint Culled;
     }
 
     [StructLayout(LayoutKind.Sequential)]
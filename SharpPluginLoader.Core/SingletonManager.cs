@@ -69,6 +69,9 @@ public static class SingletonManager
 
         SingletonList.Clear();
         _initialized = true;
+
+        // Let the native side refresh its cached singleton pointers
+        InternalCalls.NotifySingletonsChanged();
     }
 
     internal static void Initialize()
@@ -0,0 +1,22 @@
+﻿using System.Diagnostics;
+
+namespace SharpPluginLoader.Core
+{
+    /// <summary>
+    /// Records a span in the native boot trace (SPL.BootTrace) for the lifetime of the scope.
+    /// Timestamps come from <see cref="Stopwatch.GetTimestamp"/>, which uses the same clock as the native tracer.
+    /// </summary>
+    internal readonly struct TraceScope : IDisposable
+    {
+        private readonly string _name;
+        private readonly long _start;
+
+        public TraceScope(string name)
+        {
+            _name = name;
+            _start = Stopwatch.GetTimestamp();
+        }
+
+        public void Dispose() => InternalCalls.RecordTraceSpan(_name, _start, Stopwatch.GetTimestamp());
+    }
+}
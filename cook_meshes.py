@@ -0,0 +1,211 @@
+"""
+Cooks the OBJ meshes of the primitive renderer into the binary mesh format the native loader
+uploads as is (see mhw-cs-plugin-loader/MeshFormat.h).
+
+For every mesh the cooker
+  - triangulates the faces and keeps only the positions (the renderer has no other attributes),
+  - merges vertices with identical positions,
+  - reorders the triangles for the post-transform vertex cache (Tom Forsyth's linear-speed
+    vertex cache optimization),
+  - reorders the vertices by first use, so the vertex fetches walk the buffer front to back.
+
+The cooked files are committed next to their sources and packed into the chunk by the asset lists.
+Rerun this after changing any of the OBJ files.
+
+Usage: python cook_meshes.py [input.obj output.mesh ...]
+"""
+
+import struct
+import sys
+from pathlib import Path
+
+ROOT = Path(__file__).parent
+ASSET_DIR = ROOT / 'Assets' / 'Common'
+MESHES = ['Sphere', 'Cube', 'Hemisphere', 'BottomHemisphere', 'Cylinder']
+
+# Must stay in sync with mesh_format in MeshFormat.h
+MAGIC = 0x4853454D  # "MESH"
+VERSION = 1
+MAX_VERTICES = 0x10000  # Indices are 16 bit
+
+# Forsyth's scoring parameters and the size of the cache it models
+CACHE_SIZE = 32
+CACHE_DECAY_POWER = 1.5
+LAST_TRIANGLE_SCORE = 0.75
+VALENCE_BOOST_SCALE = 2.0
+VALENCE_BOOST_POWER = 0.5
+
+# Cache size used to compare the optimized order against the authored one
+MEASURED_CACHE_SIZE = 16
+
+
+def parse_obj(path: Path) -> tuple[list[tuple[float, float, float]], list[int]]:
+    positions = []
+    indices = []
+
+    for line in path.read_text().splitlines():
+        parts = line.split()
+        if not parts:
+            continue
+
+        if parts[0] == 'v':
+            positions.append(tuple(float(c) for c in parts[1:4]))
+        elif parts[0] == 'f':
+            # v, v/vt, v//vn or v/vt/vn, negative indices are relative to the end
+            face = []
+            for part in parts[1:]:
+                index = int(part.split('/')[0])
+                face.append(index - 1 if index > 0 else len(positions) + index)
+
+            for i in range(1, len(face) - 1):
+                indices += [face[0], face[i], face[i + 1]]
+
+    return positions, indices
+
+
+def deduplicate(positions: list, indices: list[int]) -> tuple[list, list[int]]:
+    unique = {}
+    remap = []
+    for position in positions:
+        remap.append(unique.setdefault(position, len(unique)))
+
+    return list(unique), [remap[i] for i in indices]
+
+
+def vertex_score(cache_position: int, remaining_triangles: int) -> float:
+    if remaining_triangles == 0:
+        return -1.0
+
+    score = 0.0
+    if cache_position >= 0:
+        if cache_position < 3:
+            # The vertices of the triangle just drawn, fixed so it isn't favored to draw it again
+            score = LAST_TRIANGLE_SCORE
+        else:
+            scale = 1.0 / (CACHE_SIZE - 3)
+            score = (1.0 - (cache_position - 3) * scale) ** CACHE_DECAY_POWER
+
+    # Vertices with few triangles left are finished off first
+    return score + VALENCE_BOOST_SCALE * remaining_triangles ** -VALENCE_BOOST_POWER
+
+
+def optimize_vertex_cache(vertex_count: int, indices: list[int]) -> list[int]:
+    triangle_count = len(indices) // 3
+    vertex_triangles = [[] for _ in range(vertex_count)]
+    for triangle in range(triangle_count):
+        for vertex in indices[triangle * 3:triangle * 3 + 3]:
+            vertex_triangles[vertex].append(triangle)
+
+    remaining = [len(triangles) for triangles in vertex_triangles]
+    cache_position = [-1] * vertex_count
+    scores = [vertex_score(-1, remaining[v]) for v in range(vertex_count)]
+    triangle_scores = [sum(scores[v] for v in indices[t * 3:t * 3 + 3]) for t in range(triangle_count)]
+    drawn = [False] * triangle_count
+
+    cache = []
+    output = []
+    for _ in range(triangle_count):
+        # Best triangle touching the cache, or the best one overall when the cache ran dry
+        candidates = {t for v in cache for t in vertex_triangles[v] if not drawn[t]}
+        if not candidates:
+            candidates = (t for t in range(triangle_count) if not drawn[t])
+
+        best = max(candidates, key=lambda t: (triangle_scores[t], -t))
+        triangle = indices[best * 3:best * 3 + 3]
+        drawn[best] = True
+        output += triangle
+
+        for vertex in triangle:
+            remaining[vertex] -= 1
+            vertex_triangles[vertex].remove(best)
+
+        cache = triangle + [v for v in cache if v not in triangle]
+        evicted = cache[CACHE_SIZE:]
+        cache = cache[:CACHE_SIZE]
+
+        for vertex in evicted:
+            cache_position[vertex] = -1
+
+        for position, vertex in enumerate(cache):
+            cache_position[vertex] = position
+
+        for vertex in cache + evicted:
+            score = vertex_score(cache_position[vertex], remaining[vertex])
+            delta = score - scores[vertex]
+            scores[vertex] = score
+            for t in vertex_triangles[vertex]:
+                triangle_scores[t] += delta
+
+    return output
+
+
+def optimize_vertex_fetch(positions: list, indices: list[int]) -> tuple[list, list[int]]:
+    remap = {}
+    for index in indices:
+        remap.setdefault(index, len(remap))
+
+    ordered = [None] * len(remap)
+    for old, new in remap.items():
+        ordered[new] = positions[old]
+
+    return ordered, [remap[i] for i in indices]
+
+
+def average_cache_miss_ratio(indices: list[int]) -> float:
+    """Transformed vertices per triangle with a small FIFO cache, the conservative hardware case"""
+    cache = []
+    misses = 0
+    for index in indices:
+        if index not in cache:
+            misses += 1
+            cache.append(index)
+            if len(cache) > MEASURED_CACHE_SIZE:
+                cache.pop(0)
+
+    return misses / (len(indices) // 3)
+
+
+def cook(source: Path, destination: Path):
+    positions, indices = parse_obj(source)
+    raw_vertex_count = len(indices)
+
+    positions, indices = deduplicate(positions, indices)
+    if len(positions) > MAX_VERTICES:
+        raise ValueError(f'{source} has {len(positions)} vertices, 16 bit indices allow {MAX_VERTICES}')
+
+    # Some authored meshes are already in a good order, keep it when the optimizer can't beat it
+    authored_acmr = average_cache_miss_ratio(indices)
+    optimized = optimize_vertex_cache(len(positions), indices)
+    if average_cache_miss_ratio(optimized) < authored_acmr:
+        indices = optimized
+
+    positions, indices = optimize_vertex_fetch(positions, indices)
+
+    data = bytearray(struct.pack('<4I', MAGIC, VERSION, len(positions), len(indices)))
+    for x, y, z in positions:
+        data += struct.pack('<4f', x, y, z, 1.0)
+
+    data += struct.pack(f'<{len(indices)}H', *indices)
+    destination.write_bytes(data)
+
+    print(f'{source.name}: {raw_vertex_count} -> {len(positions)} vertices, {len(indices) // 3} triangles, '
+          f'ACMR {authored_acmr:.2f} -> {average_cache_miss_ratio(indices):.2f}, {len(data)} bytes')
+
+
+def main():
+    args = sys.argv[1:]
+    if args:
+        if len(args) % 2 != 0:
+            print(__doc__)
+            sys.exit(1)
+
+        pairs = [(Path(args[i]), Path(args[i + 1])) for i in range(0, len(args), 2)]
+    else:
+        pairs = [(ASSET_DIR / f'{name}.obj', ASSET_DIR / f'{name}.mesh') for name in MESHES]
+
+    for source, destination in pairs:
+        cook(source, destination)
+
+
+if __name__ == '__main__':
+    main()
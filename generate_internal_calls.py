@@ -0,0 +1,186 @@
+"""
+Generates the internal call binding table shared by the native loader and SharpPluginLoader.Core
+from the declarations in mhw-cs-plugin-loader/InternalCalls.json.
+
+Each declaration has a name and a signature, written like the type arguments of a C#
+`delegate* unmanaged<...>` (parameters first, return type last). The position of a declaration
+in the file is its id, so new internal calls must only ever be appended.
+
+Outputs:
+  mhw-cs-plugin-loader/InternalCallTable.h          - ids, names and signature hashes
+  SharpPluginLoader.Core/InternalCalls.Generated.cs - function pointer fields and the binder
+
+Usage: python generate_internal_calls.py
+"""
+
+import json
+from dataclasses import dataclass
+from pathlib import Path
+
+ROOT = Path(__file__).parent
+DECLARATIONS = ROOT / 'mhw-cs-plugin-loader' / 'InternalCalls.json'
+NATIVE_OUTPUT = ROOT / 'mhw-cs-plugin-loader' / 'InternalCallTable.h'
+MANAGED_OUTPUT = ROOT / 'SharpPluginLoader.Core' / 'InternalCalls.Generated.cs'
+
+# ABI class of each managed type. Must stay in sync with internal_calls::abi_class in CoreClr.h.
+# Integers, pointers and enums are classified by size, floating point types by kind.
+ABI_CLASSES = {
+    'void': 'v',
+    'bool': '1',
+    'byte': '1',
+    'sbyte': '1',
+    'short': '2',
+    'ushort': '2',
+    'char': '2',
+    'int': '4',
+    'uint': '4',
+    'long': '8',
+    'ulong': '8',
+    'nint': '8',
+    'nuint': '8',
+    'string': '8',
+    'float': 'f',
+    'double': 'd',
+}
+
+
+@dataclass
+class InternalCall:
+    id: int
+    name: str
+    signature: list[str]
+
+    @property
+    def abi(self) -> str:
+        *params, ret = self.signature
+        return f'{abi_class(ret)}({"".join(abi_class(p) for p in params)})'
+
+    @property
+    def hash(self) -> int:
+        return fnv1a(self.abi)
+
+
+def abi_class(managed_type: str) -> str:
+    managed_type = managed_type.strip()
+    if managed_type.startswith(('ref ', 'out ', 'in ')) or managed_type.endswith('*'):
+        return '8'
+
+    if managed_type not in ABI_CLASSES:
+        raise ValueError(f'Unsupported internal call type: {managed_type}')
+
+    return ABI_CLASSES[managed_type]
+
+
+def fnv1a(s: str) -> int:
+    h = 0x811C9DC5
+    for c in s.encode('ascii'):
+        h = ((h ^ c) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def load_declarations() -> list[InternalCall]:
+    with open(DECLARATIONS, 'r') as f:
+        declarations = json.load(f)
+
+    icalls = [InternalCall(i, d['Name'], d['Signature']) for i, d in enumerate(declarations)]
+    names = [icall.name for icall in icalls]
+    duplicates = {name for name in names if names.count(name) > 1}
+    if duplicates:
+        raise ValueError(f'Duplicate internal calls: {", ".join(sorted(duplicates))}')
+
+    return icalls
+
+
+def table_hash(icalls: list[InternalCall]) -> int:
+    return fnv1a(''.join(f'{icall.name}:{icall.abi};' for icall in icalls))
+
+
+def generate_native(icalls: list[InternalCall]):
+    lines = [
+        '// <auto-generated>',
+        '// Generated by generate_internal_calls.py from InternalCalls.json. Do not edit.',
+        '// </auto-generated>',
+        '#pragma once',
+        '',
+        '#include "SharpPluginLoader.h"',
+        '',
+        '#include <array>',
+        '',
+        'enum class InternalCallId : u32 {',
+    ]
+    lines += [f'    {icall.name} = {icall.id},' for icall in icalls]
+    lines += [
+        '',
+        '    Count',
+        '};',
+        '',
+        'namespace internal_calls {',
+        '',
+        'struct InternalCallInfo {',
+        '    const char* Name;',
+        '    u32 SignatureHash;',
+        '};',
+        '',
+        f'constexpr u32 TABLE_HASH = 0x{table_hash(icalls):08X};',
+        '',
+        'constexpr std::array<InternalCallInfo, (size_t)InternalCallId::Count> INTERNAL_CALLS = {{',
+    ]
+    lines += [f'    {{ "{icall.name}", 0x{icall.hash:08X} }}, // {icall.abi}' for icall in icalls]
+    lines += [
+        '}};',
+        '',
+        '}',
+        '',
+    ]
+
+    NATIVE_OUTPUT.write_text('\n'.join(lines))
+
+
+def generate_managed(icalls: list[InternalCall]):
+    lines = [
+        '// <auto-generated>',
+        '// Generated by generate_internal_calls.py from mhw-cs-plugin-loader/InternalCalls.json. Do not edit.',
+        '// </auto-generated>',
+        '',
+        'namespace SharpPluginLoader.Core',
+        '{',
+        '    internal static unsafe partial class InternalCalls',
+        '    {',
+        '#pragma warning disable CS0649 // Field is never assigned to, and will always have its default value',
+    ]
+    lines += [f'        public static delegate* unmanaged<{", ".join(icall.signature)}> {icall.name}Ptr;' for icall in icalls]
+    lines += [
+        '#pragma warning restore CS0649',
+        '    }',
+        '',
+        '    internal static unsafe class InternalCallTable',
+        '    {',
+        f'        public const int Count = {len(icalls)};',
+        f'        public const uint TableHash = 0x{table_hash(icalls):08X};',
+        '',
+        '        public static readonly string[] Names =',
+        '        [',
+    ]
+    lines += [f'            "{icall.name}",' for icall in icalls]
+    lines += [
+        '        ];',
+        '',
+        '        public static void Bind(nint* table)',
+        '        {',
+    ]
+    lines += [f'            InternalCalls.{icall.name}Ptr = (delegate* unmanaged<{", ".join(icall.signature)}>)table[{icall.id}];' for icall in icalls]
+    lines += [
+        '        }',
+        '    }',
+        '}',
+        '',
+    ]
+
+    MANAGED_OUTPUT.write_text('﻿' + '\n'.join(lines), encoding='utf-8')
+
+
+if __name__ == '__main__':
+    internal_calls = load_declarations()
+    generate_native(internal_calls)
+    generate_managed(internal_calls)
+    print(f'Generated {len(internal_calls)} internal calls')
@@ -1,15 +1,18 @@
 #include "AddressRepository.h"
 
+#include <algorithm>
 #include <execution>
 #include <filesystem>
 #include <memory>
 #include <string>
 #include <chrono>
+#include <vector>
 
 #include "Chunk.h"
 #include "Config.h"
 #include "Log.h"
 #include "PatternScan.h"
+#include "Trace.h"
 
 #include <nlohmann/json.hpp>
 #include "picosha2/picosha2.h"
@@ -19,6 +22,8 @@ std::unordered_map<std::string, uintptr_t> scan_for_address_records(json records
 std::string get_game_revision();
 
 void AddressRepository::initialize() {
+	TRACE_SCOPE("AddressRepository::initialize");
+
 	// Load address records json from the default chunk
 	std::shared_ptr<Chunk> default_chunk = std::make_shared<Chunk>(config::SPL_DEFAULT_CHUNK_PATH);
 	auto address_records = default_chunk.get()->get_file("/Resources/AddressRecords.json");
@@ -110,14 +115,19 @@ uintptr_t AddressRepository::get(const std::string& name) {
 std::unordered_map<std::string, uintptr_t> scan_for_address_records(json records_json) {
 	std::mutex map_lock;
 	std::unordered_map<std::string, uintptr_t> resolved_addresses;
-	std::for_each(std::execution::par, records_json.begin(), records_json.end(), [&map_lock, &resolved_addresses](const json& o) {
+	std::vector<std::string> missing_records;
+	std::for_each(std::execution::par, records_json.begin(), records_json.end(), [&map_lock, &resolved_addresses, &missing_records](const json& o) {
 		std::string name = o["Name"];
 		std::string pattern = o["Pattern"];
 		int64_t offset = o["Offset"];
+		TRACE_SCOPE(name, "address");
 
 		uintptr_t address = PatternScanner::find_first(Pattern::from_string(pattern));
 		if (address == 0) {
-			dlog::error("[AddressRepo] Failed to find address for: {}", name);
+			// Collected and reported once after the scan, so a broken record set
+			// doesn't emit one error line per record from every scan thread.
+			std::lock_guard lock(map_lock);
+			missing_records.push_back(name); // Copied, the trace span still refers to it
 			return;
 		}
 		address += offset;
@@ -128,6 +138,18 @@ std::unordered_map<std::string, uintptr_t> scan_for_address_records(json records
 			resolved_addresses[name] = address;
 		}
 	});
+
+	if (!missing_records.empty()) {
+		std::ranges::sort(missing_records);
+
+		std::string names;
+		for (const auto& name : missing_records) {
+			names += names.empty() ? name : ", " + name;
+		}
+
+		dlog::error("[AddressRepo] Failed to find addresses for {} records: {}", missing_records.size(), names);
+	}
+
 	return resolved_addresses;
 }
 
@@ -34,6 +34,9 @@ static constexpr auto concat = Join<Strs...>::value;
 // The current version of the loader, not used for anything yet
 constexpr inline auto SPL_VERSION = L"0.0.2"sv;
 
+// The path to the plugin directory
+constexpr inline auto SPL_PLUGIN_DIR = L"nativePC/plugins/CSharp/"sv;
+
 // The path to the loader directory
 constexpr inline auto SPL_LOADER_DIR = L"nativePC/plugins/CSharp/Loader/"sv;
 
@@ -93,6 +96,12 @@ static constexpr const char* SPL_DEFAULT_CHUNK_PATH = "nativePC/plugins/CSharp/L
 static constexpr const char* SPL_DEFAULT_CHUNK_PATH = "nativePC/plugins/CSharp/Loader/Default.bin";
 #endif
 
+// Shaders placed here are compiled at runtime and used instead of the precompiled ones in the default chunk
+static constexpr const char* SPL_SHADER_OVERRIDE_DIR = "nativePC/plugins/CSharp/Loader/Shaders";
+
 // The path of the address repository cache file
 static constexpr const char* SPL_ADDRESS_REPOSITORY_CACHE_PATH = "nativePC/plugins/CSharp/Loader/NativeAddressCache.json";
+
+// The path of the boot trace file (SPL.BootTrace)
+static constexpr const char* SPL_BOOT_TRACE_PATH = "nativePC/plugins/CSharp/Loader/BootTrace.json";
 }
\ No newline at end of file
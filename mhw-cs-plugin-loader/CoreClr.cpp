@@ -1,6 +1,7 @@
 #include "CoreClr.h"
 #include "Config.h"
 #include "Log.h"
+#include "Trace.h"
 #include "hostfxr.h"
 
 #include <Windows.h>
@@ -17,9 +18,10 @@ extern "C" static void public_log_interface(i32 level, const char* msg) {
 
 struct ManagedFunctionPointersInternal {
     ManagedFunctionPointers PublicFunctions;
-    void(*UploadInternalCalls)(void*, u32);
+    void(*UploadInternalCalls)(void**, u32, u32);
     void*(*FindCoreMethod)(const char*, const char*);
     void(*Initialize)();
+    void(*FindCoreMethods)(const char**, const char**, void**, u32);
 };
 
 CoreClr::CoreClr() {
@@ -27,6 +29,7 @@ CoreClr::CoreClr() {
 
     constexpr size_t BUFFER_SIZE = 1024;
 
+    trace::ScopedSpan load_hostfxr_span{ "CoreClr: load hostfxr" };
     char_t buffer[BUFFER_SIZE];
     size_t buffer_size = BUFFER_SIZE;
     const int result = get_hostfxr_path(buffer, &buffer_size, nullptr);
@@ -50,6 +53,9 @@ CoreClr::CoreClr() {
         return;
     }
 
+    load_hostfxr_span.end();
+    trace::ScopedSpan delegates_span{ "CoreClr: initialize runtime and get delegates" };
+
     hostfxr_handle ctx = nullptr;
     HRESULT hr = initialize(SPL_RUNTIME_CONFIG.data(), nullptr, &ctx);
     if (FAILED(hr)) {
@@ -76,7 +82,9 @@ CoreClr::CoreClr() {
     }
 
     close(ctx);
+    delegates_span.end();
 
+    trace::ScopedSpan bootstrapper_span{ "CoreClr: load bootstrapper" };
     const auto bootstrapper_path = std::filesystem::absolute(SPL_BOOTSTRAPPER_ASSEMBLY);
 
     dlog::debug("Loading bootstrapper from {}", bootstrapper_path.string());
@@ -110,6 +118,9 @@ CoreClr::CoreClr() {
         return;
     }
 
+    bootstrapper_span.end();
+
+    TRACE_SCOPE("CoreClr: initialize bootstrapper");
     ManagedFunctionPointersInternal managed_function_pointers_internal{};
     m_bootstrapper_initialize(public_log_interface, &managed_function_pointers_internal);
 
@@ -117,33 +128,104 @@ CoreClr::CoreClr() {
     m_upload_internal_calls = managed_function_pointers_internal.UploadInternalCalls;
     m_find_core_method = managed_function_pointers_internal.FindCoreMethod;
     m_core_initialize = managed_function_pointers_internal.Initialize;
-}
-
-void CoreClr::add_internal_call(std::string_view name, void* method) {
-    m_internal_calls.emplace_back(name.data(), method);
+    m_find_core_methods = managed_function_pointers_internal.FindCoreMethods;
 }
 
 void CoreClr::upload_internal_calls() {
-    m_upload_internal_calls(m_internal_calls.data(), static_cast<u32>(m_internal_calls.size()));
-    m_internal_calls.clear();
+    TRACE_SCOPE("CoreClr::upload_internal_calls");
+    m_upload_internal_calls(m_internal_calls.data(), static_cast<u32>(m_internal_calls.size()), internal_calls::TABLE_HASH);
 }
 
 void CoreClr::initialize_core_assembly() const {
+    TRACE_SCOPE("CoreClr::initialize_core_assembly");
     m_core_initialize();
 }
 
+void CoreClr::get_methods(std::wstring_view assembly, std::initializer_list<ManagedMethod> methods) const {
+    std::lock_guard lock(m_method_cache_mutex);
+
+    std::vector<const ManagedMethod*> pending;
+    std::vector<std::wstring> pending_keys;
+
+    for (const auto& method : methods) {
+        auto key = make_method_key(assembly, method.Type, method.Method);
+        if (const auto it = m_method_cache.find(key); it != m_method_cache.end()) {
+            *method.Target = it->second;
+            continue;
+        }
+
+        pending.push_back(&method);
+        pending_keys.push_back(std::move(key));
+    }
+
+    if (pending.empty()) {
+        return;
+    }
+
+    std::vector<void*> results(pending.size(), nullptr);
+
+    if (is_core_assembly(assembly)) {
+        std::vector<std::string> names;
+        names.reserve(pending.size() * 2);
+        for (const auto method : pending) {
+            names.emplace_back(method->Type.begin(), method->Type.end());
+            names.emplace_back(method->Method.begin(), method->Method.end());
+        }
+
+        std::vector<const char*> type_names(pending.size());
+        std::vector<const char*> method_names(pending.size());
+        for (size_t i = 0; i < pending.size(); ++i) {
+            type_names[i] = names[i * 2].c_str();
+            method_names[i] = names[i * 2 + 1].c_str();
+        }
+
+        m_find_core_methods(type_names.data(), method_names.data(), results.data(), (u32)pending.size());
+    } else {
+        for (size_t i = 0; i < pending.size(); ++i) {
+            results[i] = get_function_pointer(assembly, pending[i]->Type, pending[i]->Method);
+        }
+    }
+
+    for (size_t i = 0; i < pending.size(); ++i) {
+        *pending[i]->Target = results[i];
+        if (results[i]) {
+            m_method_cache.emplace(std::move(pending_keys[i]), results[i]);
+        }
+    }
+}
+
 void* CoreClr::get_method_internal(std::wstring_view assembly, std::wstring_view type, std::wstring_view method) const {
-    void* function_pointer = nullptr;
+    std::lock_guard lock(m_method_cache_mutex);
+
+    auto key = make_method_key(assembly, type, method);
+    if (const auto it = m_method_cache.find(key); it != m_method_cache.end()) {
+        return it->second;
+    }
 
-    if (assembly.starts_with(L"SharpPluginLoader.Core")) {
+    void* function_pointer;
+    if (is_core_assembly(assembly)) {
         const std::string type_utf8{ type.begin(), type.end() };
         const std::string method_utf8{ method.begin(), method.end() };
-        return m_find_core_method(type_utf8.c_str(), method_utf8.c_str());
+        function_pointer = m_find_core_method(type_utf8.c_str(), method_utf8.c_str());
+    } else {
+        function_pointer = get_function_pointer(assembly, type, method);
     }
 
+    // Failed lookups aren't cached, the assembly might not be loaded yet
+    if (function_pointer) {
+        m_method_cache.emplace(std::move(key), function_pointer);
+    }
+
+    return function_pointer;
+}
+
+void* CoreClr::get_function_pointer(std::wstring_view assembly, std::wstring_view type, std::wstring_view method) const {
+    void* function_pointer = nullptr;
+
     const auto qualified_name = std::format(L"{}, {}", type, assembly);
     dlog::debug(L"Getting function pointer for {} -> {}", qualified_name, method);
-    const auto hr = m_get_function_pointer(qualified_name.c_str(), method.data(), UNMANAGEDCALLERSONLY_METHOD, nullptr, nullptr, &function_pointer);
+    const std::wstring method_name{ method };
+    const auto hr = m_get_function_pointer(qualified_name.c_str(), method_name.c_str(), UNMANAGEDCALLERSONLY_METHOD, nullptr, nullptr, &function_pointer);
     if (FAILED(hr)) {
         dlog::debug(L"Failed to get function pointer for {}.{}: {}", type, method, hr);
         return nullptr;
@@ -151,3 +233,11 @@ void* CoreClr::get_method_internal(std::wstring_view assembly, std::wstring_view
     
     return function_pointer;
 }
+
+std::wstring CoreClr::make_method_key(std::wstring_view assembly, std::wstring_view type, std::wstring_view method) {
+    return std::format(L"{}|{}|{}", assembly, type, method);
+}
+
+bool CoreClr::is_core_assembly(std::wstring_view assembly) {
+    return assembly.starts_with(L"SharpPluginLoader.Core");
+}
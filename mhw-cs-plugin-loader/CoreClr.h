@@ -2,9 +2,17 @@
 
 #include <Windows.h>
 #include "coreclr_delegates.h"
+#include "InternalCallTable.h"
+#include "MemoryStats.h"
 #include "SharpPluginLoader.h"
 
+#include <array>
+#include <initializer_list>
+#include <mutex>
+#include <string>
 #include <string_view>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #ifdef _DEBUG
@@ -23,9 +31,52 @@ struct ManagedFunctionPointers {
     void(*ReloadPlugin)(const char*);
 };
 
-struct InternalCall {
-    const char* name;
-    void* method;
+namespace internal_calls {
+
+// ABI class of a parameter or return type. Must stay in sync with ABI_CLASSES in generate_internal_calls.py.
+// Integers, pointers and enums are classified by size, floating point types by kind.
+template<typename T>
+consteval char abi_class() {
+    if constexpr (std::is_void_v<T>) {
+        return 'v';
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return sizeof(T) == 4 ? 'f' : 'd';
+    } else if constexpr (std::is_pointer_v<T> || std::is_reference_v<T> || std::is_integral_v<T> || std::is_enum_v<T>) {
+        static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+        return (char)('0' + sizeof(T));
+    } else {
+        static_assert(!sizeof(T), "Unsupported internal call parameter type");
+        return 0;
+    }
+}
+
+consteval u32 fnv1a(const char* str, size_t length) {
+    u32 hash = 0x811C9DC5;
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ (u8)str[i]) * 0x01000193;
+    }
+
+    return hash;
+}
+
+// Hash of the signature in the form "R(PPP)", matching InternalCall.hash in generate_internal_calls.py.
+template<typename TRet, typename... TArgs>
+consteval u32 signature_hash() {
+    const char abi[] = { abi_class<TRet>(), '(', abi_class<TArgs>()..., ')' };
+    return fnv1a(abi, sizeof(abi));
+}
+
+}
+
+// A managed method to resolve as part of a batch, see CoreClr::get_methods.
+struct ManagedMethod {
+    template<typename TFunc>
+    ManagedMethod(std::wstring_view type, std::wstring_view method, TFunc** target)
+        : Type(type), Method(method), Target(reinterpret_cast<void**>(target)) {}
+
+    std::wstring_view Type;
+    std::wstring_view Method;
+    void** Target;
 };
 
 class CoreClr {
@@ -38,7 +89,21 @@ public:
         return static_cast<TFunc*>(get_method_internal(assembly, type, method));
     }
 
-    void add_internal_call(std::string_view name, void* method);
+    // Resolves all given methods from the same assembly, writing each result to its target.
+    // Methods from the core assembly that aren't cached yet are resolved in a single managed call.
+    void get_methods(std::wstring_view assembly, std::initializer_list<ManagedMethod> methods) const;
+
+    // Registers the native implementation of an internal call declared in InternalCalls.json.
+    template<InternalCallId Id, typename TRet, typename... TArgs>
+    void add_internal_call(TRet(*method)(TArgs...)) {
+        static_assert(
+            internal_calls::signature_hash<TRet, TArgs...>() == internal_calls::INTERNAL_CALLS[(u32)Id].SignatureHash,
+            "Internal call signature does not match its declaration in InternalCalls.json"
+        );
+
+        m_internal_calls[(u32)Id] = (void*)method;
+    }
+
     void upload_internal_calls();
 
     ManagedFunctionPointers get_managed_function_pointers() const {
@@ -49,6 +114,10 @@ public:
 
 private:
     void* get_method_internal(std::wstring_view assembly, std::wstring_view type, std::wstring_view method) const;
+    void* get_function_pointer(std::wstring_view assembly, std::wstring_view type, std::wstring_view method) const;
+
+    static std::wstring make_method_key(std::wstring_view assembly, std::wstring_view type, std::wstring_view method);
+    static bool is_core_assembly(std::wstring_view assembly);
 
 
 private:
@@ -63,9 +132,15 @@ private:
     BootstrapperFn m_bootstrapper_shutdown = nullptr;
     ManagedFunctionPointers m_managed_function_pointers{};
 
-    void(*m_upload_internal_calls)(void*, u32) = nullptr;
+    void(*m_upload_internal_calls)(void**, u32, u32) = nullptr;
     void*(*m_find_core_method)(const char*, const char*) = nullptr;
+    void(*m_find_core_methods)(const char**, const char**, void**, u32) = nullptr;
+
+    std::array<void*, (size_t)InternalCallId::Count> m_internal_calls{};
+    memory_stats::TrackedBytes m_internal_call_memory{ memory_stats::Tag::InternalCalls, sizeof(m_internal_calls) };
 
-    std::vector<InternalCall> m_internal_calls{};
+    // Resolved method pointers, keyed by assembly, type and method name
+    mutable std::unordered_map<std::wstring, void*> m_method_cache{};
+    mutable std::mutex m_method_cache_mutex{};
 };
 
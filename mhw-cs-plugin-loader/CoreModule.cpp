@@ -1,8 +1,13 @@
 #include "CoreModule.h"
 #include "CoreClr.h"
 #include "Config.h"
+#include "HookStats.h"
+#include "LoaderConfig.h"
 #include "Log.h"
 #include "NativePluginFramework.h"
+#include "PluginWatcherModule.h"
+
+#include <algorithm>
 
 void CoreModule::initialize(CoreClr* coreclr) {
     m_plugin_on_update = coreclr->get_method<void(float)>(
@@ -11,6 +16,8 @@ void CoreModule::initialize(CoreClr* coreclr) {
         L"OnUpdate"
     );
 
+    coreclr->add_internal_call<InternalCallId::GetFrameBudgetConfig>(get_frame_budget_config);
+
     const auto update = (void*)NativePluginFramework::get_repository_address("Main:Update");
     m_main_update_hook = safetyhook::create_inline(update, main_update_hook);
 
@@ -23,7 +30,24 @@ void CoreModule::shutdown() {
 
 void CoreModule::main_update_hook(const sMain* main) {
     const auto& self = NativePluginFramework::get_module<CoreModule>();
-    self->m_plugin_on_update(main->mDeltaSec);
+
+    // Without the present hook the main update is the only frame boundary we have
+    if (!preloader::LoaderConfig::snapshot().ImGuiRenderingEnabled) {
+        PluginWatcherModule::on_frame_boundary();
+    }
+
+    {
+        HOOK_STATS_SCOPE("CoreModule::main_update_hook");
+        self->m_plugin_on_update(main->mDeltaSec);
+    }
 
     return self->m_main_update_hook.call(main);
 }
+
+void CoreModule::get_frame_budget_config(FrameBudgetConfig* config) {
+    const auto& loader_config = preloader::LoaderConfig::snapshot();
+
+    config->BudgetMs = loader_config.FrameBudgetMs;
+    config->Action = (u32)loader_config.ParsedFrameBudgetAction;
+    config->Strikes = loader_config.FrameBudgetStrikes;
+}
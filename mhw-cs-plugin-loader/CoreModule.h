@@ -1,6 +1,7 @@
 #pragma once
 
 #include "NativeModule.h"
+#include "SharpPluginLoader.h"
 
 #include <safetyhook/safetyhook.hpp>
 #include <dti/sMain.h>
@@ -8,11 +9,19 @@
 
 class CoreModule final : public NativeModule {
 public:
+    // Mirrored by SharpPluginLoader.Core.FrameBudgetConfig
+    struct FrameBudgetConfig {
+        f32 BudgetMs;
+        u32 Action; // 0 = None, 1 = Log, 2 = Disable
+        u32 Strikes;
+    };
+
     void initialize(CoreClr* coreclr) override;
     void shutdown() override;
 
 private:
     static void main_update_hook(const sMain* main);
+    static void get_frame_budget_config(FrameBudgetConfig* config);
 
 private:
     void(*m_plugin_on_update)(float) = nullptr;
@@ -0,0 +1,488 @@
+#include "Culling.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define SPL_CULLING_SSE 1
+#include <immintrin.h>
+#endif
+
+namespace culling {
+using namespace instance_builder;
+
+namespace {
+
+// Scalar versions, used for the tail of a batch and as the reference for the kernels
+
+f32 plane_distance(const f32 plane[4], f32 x, f32 y, f32 z) {
+    return plane[0] * x + plane[1] * y + plane[2] * z + plane[3];
+}
+
+bool distance_visible(const Frustum& f, f32 distance_squared, f32 radius) {
+    const f32 max_distance = f.MaxDistance + radius;
+    return f.MaxDistance <= 0.0f || distance_squared <= max_distance * max_distance;
+}
+
+bool screen_size_visible(const Frustum& f, f32 x, f32 y, f32 z, f32 radius) {
+    if (f.MinScreenSize <= 0.0f) {
+        return true;
+    }
+
+    // Anything the camera is inside of covers the whole screen
+    const f32 w = plane_distance(f.ClipW, x, y, z);
+    return w <= radius || radius * f.ScreenScale >= f.MinScreenSize * w;
+}
+
+f32 distance_squared_to_eye(const Frustum& f, f32 x, f32 y, f32 z) {
+    const f32 dx = x - f.Eye[0];
+    const f32 dy = y - f.Eye[1];
+    const f32 dz = z - f.Eye[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+bool sphere_scalar(const Frustum& f, f32 x, f32 y, f32 z, f32 r) {
+    for (const auto& plane : f.Planes) {
+        if (plane_distance(plane, x, y, z) < -r) {
+            return false;
+        }
+    }
+
+    return distance_visible(f, distance_squared_to_eye(f, x, y, z), r)
+        && screen_size_visible(f, x, y, z, r);
+}
+
+bool obb_scalar(const Frustum& f, const ObbColumns& in, size_t i) {
+    // Half axes of the box, the rows of coord scaled by the extents
+    f32 axes[3][3];
+    for (size_t axis = 0; axis < 3; ++axis) {
+        for (size_t j = 0; j < 3; ++j) {
+            axes[axis][j] = in[obb::Coord + axis * 4 + j][i] * in[obb::ExtentX + axis][i];
+        }
+    }
+
+    const f32 x = in[obb::Coord + 12][i];
+    const f32 y = in[obb::Coord + 13][i];
+    const f32 z = in[obb::Coord + 14][i];
+
+    for (const auto& plane : f.Planes) {
+        f32 r = 0.0f;
+        for (const auto& axis : axes) {
+            r += std::abs(plane[0] * axis[0] + plane[1] * axis[1] + plane[2] * axis[2]);
+        }
+
+        if (plane_distance(plane, x, y, z) < -r) {
+            return false;
+        }
+    }
+
+    f32 radius_squared = 0.0f;
+    for (const auto& axis : axes) {
+        radius_squared += axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    }
+
+    const f32 r = std::sqrt(radius_squared);
+    return distance_visible(f, distance_squared_to_eye(f, x, y, z), r)
+        && screen_size_visible(f, x, y, z, r);
+}
+
+// A capsule, or a line with a radius of 0
+bool segment_scalar(const Frustum& f, const f32 p0[3], const f32 p1[3], f32 r, bool test_screen_size) {
+    for (const auto& plane : f.Planes) {
+        const f32 d0 = plane_distance(plane, p0[0], p0[1], p0[2]);
+        const f32 d1 = plane_distance(plane, p1[0], p1[1], p1[2]);
+        if ((std::max)(d0, d1) < -r) {
+            return false;
+        }
+    }
+
+    // Closest point on the segment to the eye
+    const f32 d[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    const f32 length_squared = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+    const f32 along = (f.Eye[0] - p0[0]) * d[0] + (f.Eye[1] - p0[1]) * d[1] + (f.Eye[2] - p0[2]) * d[2];
+    const f32 t = length_squared > 0.0f ? std::clamp(along / length_squared, 0.0f, 1.0f) : 0.0f;
+
+    const f32 distance_squared = distance_squared_to_eye(f, p0[0] + d[0] * t, p0[1] + d[1] * t, p0[2] + d[2] * t);
+    if (!distance_visible(f, distance_squared, r)) {
+        return false;
+    }
+
+    if (!test_screen_size) {
+        return true;
+    }
+
+    return screen_size_visible(f,
+        (p0[0] + p1[0]) * 0.5f, (p0[1] + p1[1]) * 0.5f, (p0[2] + p1[2]) * 0.5f,
+        std::sqrt(length_squared) * 0.5f + r);
+}
+
+#if SPL_CULLING_SSE
+
+// 4 primitives per iteration. The AVX path of the instance builder is not mirrored here,
+// the tests are a handful of multiply-adds per plane and SSE already keeps up with the gather.
+
+struct SseFrustum {
+    __m128 Planes[Frustum::PLANE_COUNT][4];
+    __m128 Eye[3];
+    __m128 ClipW[4];
+    __m128 ScreenScale;
+    __m128 MaxDistance;
+    __m128 MinScreenSize;
+    bool TestDistance;
+    bool TestScreenSize;
+
+    explicit SseFrustum(const Frustum& f) {
+        for (size_t i = 0; i < Frustum::PLANE_COUNT; ++i) {
+            for (size_t j = 0; j < 4; ++j) {
+                Planes[i][j] = _mm_set1_ps(f.Planes[i][j]);
+            }
+        }
+
+        for (size_t j = 0; j < 3; ++j) {
+            Eye[j] = _mm_set1_ps(f.Eye[j]);
+        }
+
+        for (size_t j = 0; j < 4; ++j) {
+            ClipW[j] = _mm_set1_ps(f.ClipW[j]);
+        }
+
+        ScreenScale = _mm_set1_ps(f.ScreenScale);
+        MaxDistance = _mm_set1_ps(f.MaxDistance);
+        MinScreenSize = _mm_set1_ps(f.MinScreenSize);
+        TestDistance = f.MaxDistance > 0.0f;
+        TestScreenSize = f.MinScreenSize > 0.0f;
+    }
+};
+
+__m128 dot3(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+}
+
+__m128 plane_distance(const __m128 plane[4], __m128 x, __m128 y, __m128 z) {
+    return _mm_add_ps(dot3(plane[0], plane[1], plane[2], x, y, z), plane[3]);
+}
+
+__m128 abs_ps(__m128 v) {
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+__m128 distance_squared_to_eye(const SseFrustum& f, __m128 x, __m128 y, __m128 z) {
+    const __m128 dx = _mm_sub_ps(x, f.Eye[0]);
+    const __m128 dy = _mm_sub_ps(y, f.Eye[1]);
+    const __m128 dz = _mm_sub_ps(z, f.Eye[2]);
+    return dot3(dx, dy, dz, dx, dy, dz);
+}
+
+__m128 distance_visible(const SseFrustum& f, __m128 distance_squared, __m128 radius) {
+    const __m128 max_distance = _mm_add_ps(f.MaxDistance, radius);
+    return _mm_cmple_ps(distance_squared, _mm_mul_ps(max_distance, max_distance));
+}
+
+__m128 screen_size_visible(const SseFrustum& f, __m128 x, __m128 y, __m128 z, __m128 radius) {
+    const __m128 w = plane_distance(f.ClipW, x, y, z);
+    const __m128 inside = _mm_cmple_ps(w, radius);
+    const __m128 large_enough = _mm_cmpge_ps(_mm_mul_ps(radius, f.ScreenScale), _mm_mul_ps(f.MinScreenSize, w));
+    return _mm_or_ps(inside, large_enough);
+}
+
+void store_mask(__m128 mask, u8* visible) {
+    const int bits = _mm_movemask_ps(mask);
+    visible[0] = (u8)(bits & 1);
+    visible[1] = (u8)((bits >> 1) & 1);
+    visible[2] = (u8)((bits >> 2) & 1);
+    visible[3] = (u8)((bits >> 3) & 1);
+}
+
+size_t spheres_sse(const Frustum& frustum, const SphereColumns& in, size_t begin, size_t end, u8* visible) {
+    const SseFrustum f(frustum);
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        const __m128 x = _mm_loadu_ps(in[sphere::X] + i);
+        const __m128 y = _mm_loadu_ps(in[sphere::Y] + i);
+        const __m128 z = _mm_loadu_ps(in[sphere::Z] + i);
+        const __m128 r = _mm_loadu_ps(in[sphere::Radius] + i);
+        const __m128 neg_r = _mm_sub_ps(_mm_setzero_ps(), r);
+
+        __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const auto& plane : f.Planes) {
+            mask = _mm_and_ps(mask, _mm_cmpge_ps(plane_distance(plane, x, y, z), neg_r));
+        }
+
+        if (f.TestDistance) {
+            mask = _mm_and_ps(mask, distance_visible(f, distance_squared_to_eye(f, x, y, z), r));
+        }
+
+        if (f.TestScreenSize) {
+            mask = _mm_and_ps(mask, screen_size_visible(f, x, y, z, r));
+        }
+
+        store_mask(mask, visible + i);
+    }
+
+    return i;
+}
+
+size_t obbs_sse(const Frustum& frustum, const ObbColumns& in, size_t begin, size_t end, u8* visible) {
+    const SseFrustum f(frustum);
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 axes[3][3];
+        for (size_t axis = 0; axis < 3; ++axis) {
+            const __m128 extent = _mm_loadu_ps(in[obb::ExtentX + axis] + i);
+            for (size_t j = 0; j < 3; ++j) {
+                axes[axis][j] = _mm_mul_ps(_mm_loadu_ps(in[obb::Coord + axis * 4 + j] + i), extent);
+            }
+        }
+
+        const __m128 x = _mm_loadu_ps(in[obb::Coord + 12] + i);
+        const __m128 y = _mm_loadu_ps(in[obb::Coord + 13] + i);
+        const __m128 z = _mm_loadu_ps(in[obb::Coord + 14] + i);
+
+        __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const auto& plane : f.Planes) {
+            __m128 r = _mm_setzero_ps();
+            for (const auto& axis : axes) {
+                r = _mm_add_ps(r, abs_ps(dot3(plane[0], plane[1], plane[2], axis[0], axis[1], axis[2])));
+            }
+
+            const __m128 neg_r = _mm_sub_ps(_mm_setzero_ps(), r);
+            mask = _mm_and_ps(mask, _mm_cmpge_ps(plane_distance(plane, x, y, z), neg_r));
+        }
+
+        if (f.TestDistance || f.TestScreenSize) {
+            __m128 radius_squared = _mm_setzero_ps();
+            for (const auto& axis : axes) {
+                radius_squared = _mm_add_ps(radius_squared, dot3(axis[0], axis[1], axis[2], axis[0], axis[1], axis[2]));
+            }
+
+            const __m128 r = _mm_sqrt_ps(radius_squared);
+            if (f.TestDistance) {
+                mask = _mm_and_ps(mask, distance_visible(f, distance_squared_to_eye(f, x, y, z), r));
+            }
+
+            if (f.TestScreenSize) {
+                mask = _mm_and_ps(mask, screen_size_visible(f, x, y, z, r));
+            }
+        }
+
+        store_mask(mask, visible + i);
+    }
+
+    return i;
+}
+
+// p0 and p1 are the first of 3 consecutive columns holding x, y and z
+template<typename TColumns>
+size_t segments_sse(const Frustum& frustum, const TColumns& in, size_t p0, size_t p1, const f32* radius,
+    bool test_screen_size, size_t begin, size_t end, u8* visible) {
+    const SseFrustum f(frustum);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        const __m128 x0 = _mm_loadu_ps(in[p0] + i);
+        const __m128 y0 = _mm_loadu_ps(in[p0 + 1] + i);
+        const __m128 z0 = _mm_loadu_ps(in[p0 + 2] + i);
+        const __m128 x1 = _mm_loadu_ps(in[p1] + i);
+        const __m128 y1 = _mm_loadu_ps(in[p1 + 1] + i);
+        const __m128 z1 = _mm_loadu_ps(in[p1 + 2] + i);
+        const __m128 r = radius ? _mm_loadu_ps(radius + i) : zero;
+        const __m128 neg_r = _mm_sub_ps(zero, r);
+
+        __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const auto& plane : f.Planes) {
+            const __m128 d0 = plane_distance(plane, x0, y0, z0);
+            const __m128 d1 = plane_distance(plane, x1, y1, z1);
+            mask = _mm_and_ps(mask, _mm_cmpge_ps(_mm_max_ps(d0, d1), neg_r));
+        }
+
+        const __m128 dx = _mm_sub_ps(x1, x0);
+        const __m128 dy = _mm_sub_ps(y1, y0);
+        const __m128 dz = _mm_sub_ps(z1, z0);
+        const __m128 length_squared = dot3(dx, dy, dz, dx, dy, dz);
+
+        if (f.TestDistance) {
+            const __m128 along = dot3(_mm_sub_ps(f.Eye[0], x0), _mm_sub_ps(f.Eye[1], y0), _mm_sub_ps(f.Eye[2], z0), dx, dy, dz);
+
+            // Degenerate segments divide by zero, the mask turns the result into t = 0
+            __m128 t = _mm_and_ps(_mm_cmpgt_ps(length_squared, zero), _mm_div_ps(along, length_squared));
+            t = _mm_min_ps(_mm_max_ps(t, zero), one);
+
+            const __m128 distance_squared = distance_squared_to_eye(f,
+                _mm_add_ps(x0, _mm_mul_ps(dx, t)),
+                _mm_add_ps(y0, _mm_mul_ps(dy, t)),
+                _mm_add_ps(z0, _mm_mul_ps(dz, t)));
+            mask = _mm_and_ps(mask, distance_visible(f, distance_squared, r));
+        }
+
+        if (test_screen_size && f.TestScreenSize) {
+            const __m128 bounding_radius = _mm_add_ps(_mm_mul_ps(_mm_sqrt_ps(length_squared), half), r);
+            mask = _mm_and_ps(mask, screen_size_visible(f,
+                _mm_mul_ps(_mm_add_ps(x0, x1), half),
+                _mm_mul_ps(_mm_add_ps(y0, y1), half),
+                _mm_mul_ps(_mm_add_ps(z0, z1), half),
+                bounding_radius));
+        }
+
+        store_mask(mask, visible + i);
+    }
+
+    return i;
+}
+
+#endif
+
+u8 select_lod(const Frustum& f, f32 w, f32 radius, const LodThresholds& thresholds) {
+    if (w <= radius) {
+        return 0;
+    }
+
+    const f32 size = radius * f.ScreenScale;
+    for (size_t lod = 0; lod < thresholds.size(); ++lod) {
+        if (size >= thresholds[lod] * w) {
+            return (u8)lod;
+        }
+    }
+
+    return (u8)thresholds.size();
+}
+
+void normalize_plane(f32 plane[4]) {
+    const f32 length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+
+    // Happens for the near plane of an infinite reversed-Z projection, which then culls nothing
+    if (length < 1e-6f) {
+        plane[0] = plane[1] = plane[2] = 0.0f;
+        plane[3] = 1.0f;
+        return;
+    }
+
+    for (size_t i = 0; i < 4; ++i) {
+        plane[i] /= length;
+    }
+}
+
+}
+
+Frustum extract_frustum(const f32 view[16], const f32 proj[16], const Settings& settings) {
+    f32 vp[16];
+    for (size_t row = 0; row < 4; ++row) {
+        for (size_t col = 0; col < 4; ++col) {
+            f32 sum = 0.0f;
+            for (size_t k = 0; k < 4; ++k) {
+                sum += view[row * 4 + k] * proj[k * 4 + col];
+            }
+
+            vp[row * 4 + col] = sum;
+        }
+    }
+
+    // With row vectors clip = (p, 1) * vp, so each clip coordinate is the dot product with a column
+    const auto column = [&](size_t col, size_t row) { return vp[row * 4 + col]; };
+
+    Frustum f{};
+    for (size_t j = 0; j < 4; ++j) {
+        f.Planes[0][j] = column(3, j) + column(0, j); // -w <= x
+        f.Planes[1][j] = column(3, j) - column(0, j); //  x <= w
+        f.Planes[2][j] = column(3, j) + column(1, j); // -w <= y
+        f.Planes[3][j] = column(3, j) - column(1, j); //  y <= w
+        f.Planes[4][j] = column(2, j);                //  0 <= z
+        f.ClipW[j] = column(3, j);
+    }
+
+    for (auto& plane : f.Planes) {
+        normalize_plane(plane);
+    }
+
+    // The view matrix is [R 0; t 1], so the eye is at -t * R^T
+    for (size_t j = 0; j < 3; ++j) {
+        f.Eye[j] = -(view[12] * view[j * 4] + view[13] * view[j * 4 + 1] + view[14] * view[j * 4 + 2]);
+    }
+
+    f.ScreenScale = proj[5];
+    f.MaxDistance = settings.MaxDistance;
+    f.MinScreenSize = settings.MinScreenSize;
+
+    return f;
+}
+
+void cull_spheres(const Frustum& frustum, const SphereColumns& in, size_t begin, size_t end, u8* visible, Isa isa) {
+    size_t done = begin;
+
+#if SPL_CULLING_SSE
+    if (isa != Isa::Scalar) {
+        done = spheres_sse(frustum, in, begin, end, visible);
+    }
+#endif
+
+    for (size_t i = done; i < end; ++i) {
+        visible[i] = sphere_scalar(frustum, in[sphere::X][i], in[sphere::Y][i], in[sphere::Z][i], in[sphere::Radius][i]);
+    }
+}
+
+void cull_obbs(const Frustum& frustum, const ObbColumns& in, size_t begin, size_t end, u8* visible, Isa isa) {
+    size_t done = begin;
+
+#if SPL_CULLING_SSE
+    if (isa != Isa::Scalar) {
+        done = obbs_sse(frustum, in, begin, end, visible);
+    }
+#endif
+
+    for (size_t i = done; i < end; ++i) {
+        visible[i] = obb_scalar(frustum, in, i);
+    }
+}
+
+void cull_capsules(const Frustum& frustum, const CapsuleColumns& in, size_t begin, size_t end, u8* visible, Isa isa) {
+    size_t done = begin;
+
+#if SPL_CULLING_SSE
+    if (isa != Isa::Scalar) {
+        done = segments_sse(frustum, in, capsule::P0X, capsule::P1X, in[capsule::Radius], true, begin, end, visible);
+    }
+#endif
+
+    for (size_t i = done; i < end; ++i) {
+        const f32 p0[3] = { in[capsule::P0X][i], in[capsule::P0Y][i], in[capsule::P0Z][i] };
+        const f32 p1[3] = { in[capsule::P1X][i], in[capsule::P1Y][i], in[capsule::P1Z][i] };
+        visible[i] = segment_scalar(frustum, p0, p1, in[capsule::Radius][i], true);
+    }
+}
+
+void cull_lines(const Frustum& frustum, const LineColumns& in, size_t begin, size_t end, u8* visible, Isa isa) {
+    size_t done = begin;
+
+#if SPL_CULLING_SSE
+    if (isa != Isa::Scalar) {
+        done = segments_sse(frustum, in, line::P0X, line::P1X, nullptr, false, begin, end, visible);
+    }
+#endif
+
+    for (size_t i = done; i < end; ++i) {
+        const f32 p0[3] = { in[line::P0X][i], in[line::P0Y][i], in[line::P0Z][i] };
+        const f32 p1[3] = { in[line::P1X][i], in[line::P1Y][i], in[line::P1Z][i] };
+        visible[i] = segment_scalar(frustum, p0, p1, 0.0f, false);
+    }
+}
+
+void select_sphere_lods(const Frustum& frustum, const SphereColumns& in, size_t begin, size_t end, const LodThresholds& thresholds, u8* lods) {
+    for (size_t i = begin; i < end; ++i) {
+        const f32 w = plane_distance(frustum.ClipW, in[sphere::X][i], in[sphere::Y][i], in[sphere::Z][i]);
+        lods[i] = select_lod(frustum, w, in[sphere::Radius][i], thresholds);
+    }
+}
+
+void select_capsule_lods(const Frustum& frustum, const CapsuleColumns& in, size_t begin, size_t end, const LodThresholds& thresholds, u8* lods) {
+    for (size_t i = begin; i < end; ++i) {
+        const f32 w0 = plane_distance(frustum.ClipW, in[capsule::P0X][i], in[capsule::P0Y][i], in[capsule::P0Z][i]);
+        const f32 w1 = plane_distance(frustum.ClipW, in[capsule::P1X][i], in[capsule::P1Y][i], in[capsule::P1Z][i]);
+        lods[i] = select_lod(frustum, (std::min)(w0, w1), in[capsule::Radius][i], thresholds);
+    }
+}
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "InstanceBuilder.h"
+#include "SharpPluginLoader.h"
+
+#include <array>
+
+// CPU visibility tests for the debug primitives, run on the instance builder's columns before
+// anything is built or uploaded. Every kernel writes one byte per primitive (1 = visible), the
+// caller then compacts the columns with it.
+//
+// Like the instance builder this has no dependency on Windows or D3D. Matrices are row-major and
+// used with row vectors, the way the game stores them.
+namespace culling {
+
+namespace line {
+enum Column : size_t { P0X, P0Y, P0Z, P1X, P1Y, P1Z, Count };
+}
+
+using LineColumns = instance_builder::Columns<line::Count>;
+
+struct Settings {
+    f32 MaxDistance = 0.0f;   // Primitives farther away than this are culled, 0 disables the test
+    f32 MinScreenSize = 0.0f; // Fraction of the viewport height a primitive must cover, 0 disables the test
+};
+
+struct Frustum {
+    // Left, right, bottom, top and near plane, normalized. A point is inside when dot(plane, (p, 1)) >= 0.
+    static constexpr size_t PLANE_COUNT = 5;
+
+    f32 Planes[PLANE_COUNT][4];
+    f32 Eye[3];
+    f32 ClipW[4];     // Clip space w of a point is dot(ClipW, (p, 1)), the view depth for perspective projections
+    f32 ScreenScale;  // Projected size of a sphere is Radius * ScreenScale / w
+    f32 MaxDistance;
+    f32 MinScreenSize;
+};
+
+// The planes are taken from the columns of view * proj. The far plane is left out, the game
+// may use an infinite or reversed depth range, MaxDistance covers what it would cull.
+Frustum extract_frustum(const f32 view[16], const f32 proj[16], const Settings& settings);
+
+// Test the primitives [begin, end) of `in`, writing the results to the same indices of `visible`.
+// Disjoint ranges can be tested concurrently.
+void cull_spheres(const Frustum& frustum, const instance_builder::SphereColumns& in, size_t begin, size_t end, u8* visible, instance_builder::Isa isa);
+void cull_obbs(const Frustum& frustum, const instance_builder::ObbColumns& in, size_t begin, size_t end, u8* visible, instance_builder::Isa isa);
+void cull_capsules(const Frustum& frustum, const instance_builder::CapsuleColumns& in, size_t begin, size_t end, u8* visible, instance_builder::Isa isa);
+// Lines have a fixed thickness in pixels, so they are never culled for their screen size
+void cull_lines(const Frustum& frustum, const LineColumns& in, size_t begin, size_t end, u8* visible, instance_builder::Isa isa);
+
+// Screen-space level of detail, level 0 being the most detailed mesh. A primitive uses the first
+// level whose threshold its projected size (the same measure as MinScreenSize) reaches, and the
+// last level when it reaches none of them. Primitives the camera is inside of always use level 0.
+constexpr size_t LOD_COUNT = 3;
+using LodThresholds = std::array<f32, LOD_COUNT - 1>;
+
+void select_sphere_lods(const Frustum& frustum, const instance_builder::SphereColumns& in, size_t begin, size_t end, const LodThresholds& thresholds, u8* lods);
+// Both hemispheres of a capsule use the level of its end closer to the camera
+void select_capsule_lods(const Frustum& frustum, const instance_builder::CapsuleColumns& in, size_t begin, size_t end, const LodThresholds& thresholds, u8* lods);
+
+}
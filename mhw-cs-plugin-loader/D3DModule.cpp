@@ -4,8 +4,10 @@
 
 #include "CoreClr.h"
 #include "Config.h"
+#include "HookStats.h"
 #include "Log.h"
 #include "NativePluginFramework.h"
+#include "SingletonModule.h"
 
 #include <Windows.h>
 #include <imgui_impl.h>
@@ -20,13 +22,14 @@
 #include "ChunkModule.h"
 #include "HResultHandler.h"
 #include "LoaderConfig.h"
+#include "PluginWatcherModule.h"
 #include "PatternScan.h"
 
 // DirectXTK12 References SerializeRootSignature so we need to link this
 #pragma comment(lib, "d3d12.lib")
 
 void D3DModule::initialize(CoreClr* coreclr) {
-    if (!preloader::LoaderConfig::get().get_imgui_rendering_enabled()) {
+    if (!preloader::LoaderConfig::snapshot().ImGuiRenderingEnabled) {
         dlog::debug("Skipping D3D module initialization because imgui rendering is disabled");
         return;
     }
@@ -34,43 +37,20 @@ void D3DModule::initialize(CoreClr* coreclr) {
     // Directory for delay loaded DLLs
     AddDllDirectory(TEXT("nativePC/plugins/CSharp/Loader"));
 
-    m_core_render = coreclr->get_method<void()>(
-        config::SPL_CORE_ASSEMBLY_NAME,
-        L"SharpPluginLoader.Core.Rendering.Renderer",
-        L"Render"
-    );
-    m_core_imgui_render = coreclr->get_method<ImDrawData * ()>(
-        config::SPL_CORE_ASSEMBLY_NAME,
-        L"SharpPluginLoader.Core.Rendering.Renderer",
-        L"ImGuiRender"
-    );
-    m_core_initialize_imgui = coreclr->get_method<ImGuiContext*(MtSize, MtSize, bool, const char*)>(
-        config::SPL_CORE_ASSEMBLY_NAME,
-        L"SharpPluginLoader.Core.Rendering.Renderer",
-        L"Initialize"
-    );
-    m_core_get_custom_fonts = coreclr->get_method<int(CustomFont**)>(
-        config::SPL_CORE_ASSEMBLY_NAME,
-        L"SharpPluginLoader.Core.Rendering.Renderer",
-        L"GetCustomFonts"
-    );
-    m_core_resolve_custom_fonts = coreclr->get_method<void()>(
-        config::SPL_CORE_ASSEMBLY_NAME,
-        L"SharpPluginLoader.Core.Rendering.Renderer",
-        L"ResolveCustomFonts"
-    );
-    m_get_singleton = coreclr->get_method<void* (const char*)>(
-        config::SPL_CORE_ASSEMBLY_NAME,
-        L"SharpPluginLoader.Core.SingletonManager",
-        L"GetSingletonNative"
-    );
+    coreclr->get_methods(config::SPL_CORE_ASSEMBLY_NAME, {
+        { L"SharpPluginLoader.Core.Rendering.Renderer", L"Render", &m_core_render },
+        { L"SharpPluginLoader.Core.Rendering.Renderer", L"ImGuiRender", &m_core_imgui_render },
+        { L"SharpPluginLoader.Core.Rendering.Renderer", L"Initialize", &m_core_initialize_imgui },
+        { L"SharpPluginLoader.Core.Rendering.Renderer", L"GetCustomFonts", &m_core_get_custom_fonts },
+        { L"SharpPluginLoader.Core.Rendering.Renderer", L"ResolveCustomFonts", &m_core_resolve_custom_fonts }
+    });
 
     const auto play = (void*)NativePluginFramework::get_repository_address("GUITitle:Play");
     m_title_menu_ready_hook = safetyhook::create_inline(play, title_menu_ready_hook);
 
-    coreclr->add_internal_call("LoadTexture", (void*)load_texture);
-    coreclr->add_internal_call("UnloadTexture", (void*)unload_texture);
-    coreclr->add_internal_call("RegisterTexture", (void*)register_texture);
+    coreclr->add_internal_call<InternalCallId::LoadTexture>(load_texture);
+    coreclr->add_internal_call<InternalCallId::UnloadTexture>(unload_texture);
+    coreclr->add_internal_call<InternalCallId::RegisterTexture>(register_texture);
 }
 
 void D3DModule::shutdown() {
@@ -365,7 +345,7 @@ void D3DModule::initialize_for_d3d12_alt() {
     m_d3d_present_hook_alt = safetyhook::create_mid(present_call, [](safetyhook::Context& ctx) {
         const auto self = NativePluginFramework::get_module<D3DModule>();
         const auto prm = NativePluginFramework::get_module<PrimitiveRenderingModule>();
-        const auto& config = preloader::LoaderConfig::get();
+        const auto& config = preloader::LoaderConfig::snapshot();
 
         const auto swap_chain = (IDXGISwapChain*)ctx.rcx;
 
@@ -385,10 +365,11 @@ void D3DModule::initialize_for_d3d12_alt() {
                     self->m_d3d12_srv_heap
                 );
             }
+        }
 
-            if (config.get_primitive_rendering_enabled()) {
-                prm->late_init(self.get(), swap_chain);
-            }
+        // Checked every frame, primitive rendering can be switched on by reloading the loader config
+        if (config.PrimitiveRenderingEnabled && !prm->is_initialized()) {
+            prm->late_init(self, swap_chain);
         }
 
         if (!self->m_d3d12_command_queue) {
@@ -396,7 +377,7 @@ void D3DModule::initialize_for_d3d12_alt() {
             return;
         }
 
-        const auto facility = (uintptr_t)self->m_get_singleton("sFacility");
+        const auto facility = (uintptr_t)SingletonModule::get(Singleton::Facility);
 
         // Check if Steamworks is active. This is a very hacky fix for the AutoSteamworks app,
         // which sometimes sends invalid input events that trip up ImGui.
@@ -412,7 +393,7 @@ void D3DModule::initialize_for_d3d12_alt() {
         self->m_is_inside_present = false;
     });
 
-    const auto render_singleton = (uintptr_t)m_get_singleton("sMhRender");
+    const auto render_singleton = (uintptr_t)SingletonModule::get(Singleton::MhRender);
     const auto renderer = *(uintptr_t*)(render_singleton + 0x78);
 
     m_d3d12_command_queue = *(ID3D12CommandQueue**)(renderer + 0x20);
@@ -439,7 +420,7 @@ void D3DModule::initialize_for_d3d11_alt() {
     m_d3d_present_hook_alt = safetyhook::create_mid(present_call, [](safetyhook::Context& ctx) {
         const auto self = NativePluginFramework::get_module<D3DModule>();
         const auto prm = NativePluginFramework::get_module<PrimitiveRenderingModule>();
-        const auto& config = preloader::LoaderConfig::get();
+        const auto& config = preloader::LoaderConfig::snapshot();
 
         const auto swap_chain = (IDXGISwapChain*)ctx.rcx;
 
@@ -455,10 +436,11 @@ void D3DModule::initialize_for_d3d11_alt() {
             if (!self->m_texture_manager) {
                 self->m_texture_manager = std::make_unique<TextureManager>(self->m_d3d11_device, self->m_d3d11_device_context);
             }
+        }
 
-            if (config.get_primitive_rendering_enabled()) {
-                prm->late_init(self.get(), swap_chain);
-            }
+        // Checked every frame, primitive rendering can be switched on by reloading the loader config
+        if (config.PrimitiveRenderingEnabled && !prm->is_initialized()) {
+            prm->late_init(self, swap_chain);
         }
 
         self->d3d11_present_hook_core(swap_chain, prm);
@@ -487,8 +469,8 @@ void D3DModule::d3d12_initialize_imgui(IDXGISwapChain* swap_chain) {
         (u32)(client_rect.bottom - client_rect.top) 
     };
     
-    const auto& config = preloader::LoaderConfig::get();
-    const auto context = m_core_initialize_imgui(viewport_size, window_size, true, config.get_menu_key().c_str());
+    const auto& config = preloader::LoaderConfig::snapshot();
+    const auto context = m_core_initialize_imgui(viewport_size, window_size, true, config.MenuKey.c_str());
 
     igSetCurrentContext(context);
 
@@ -620,8 +602,8 @@ void D3DModule::d3d11_initialize_imgui(IDXGISwapChain* swap_chain) {
         (u32)(client_rect.bottom - client_rect.top) 
     };
 
-    const auto& config = preloader::LoaderConfig::get();
-    const auto context = m_core_initialize_imgui(viewport_size, window_size, false, config.get_menu_key().c_str());
+    const auto& config = preloader::LoaderConfig::snapshot();
+    const auto context = m_core_initialize_imgui(viewport_size, window_size, false, config.MenuKey.c_str());
     igSetCurrentContext(context);
 
     imgui_load_fonts();
@@ -707,12 +689,12 @@ void D3DModule::imgui_load_fonts() {
 TextureHandle D3DModule::register_texture(void* texture) {
     const auto& self = NativePluginFramework::get_module<D3DModule>();
     if (!self->m_texture_manager) {
-        dlog::error("Cannot register texture during Buffer Resize event");
+        DLOG_ERROR_LIMITED("Cannot register texture during Buffer Resize event");
         return nullptr;
     }
 
     if (self->m_is_d3d12 && !self->m_d3d12_command_queue) {
-        dlog::error("Cannot register texture during Buffer Resize event (D3D12)");
+        DLOG_ERROR_LIMITED("Cannot register texture during Buffer Resize event (D3D12)");
         return nullptr;
     }
 
@@ -722,12 +704,12 @@ TextureHandle D3DModule::register_texture(void* texture) {
 TextureHandle D3DModule::load_texture(const char* path, u32* out_width, u32* out_height) {
     const auto& self = NativePluginFramework::get_module<D3DModule>();
     if (!self->m_texture_manager) {
-        dlog::error("Cannot load texture during Buffer Resize event");
+        DLOG_ERROR_LIMITED("Cannot load texture during Buffer Resize event");
         return nullptr;
     }
 
     if (self->m_is_d3d12 && !self->m_d3d12_command_queue) {
-        dlog::error("Cannot load texture during Buffer Resize event (D3D12)");
+        DLOG_ERROR_LIMITED("Cannot load texture during Buffer Resize event (D3D12)");
         return nullptr;
     }
 
@@ -765,7 +747,7 @@ auto invoke_if(const std::optional<std::shared_ptr<T>>& opt, F func, Args&&... a
 HRESULT D3DModule::d3d12_present_hook(IDXGISwapChain* swap_chain, UINT sync_interval, UINT flags) {
     const auto self = NativePluginFramework::get_module<D3DModule>();
     const auto prm = NativePluginFramework::get_module<PrimitiveRenderingModule>();
-    const auto& config = preloader::LoaderConfig::get();
+    const auto& config = preloader::LoaderConfig::snapshot();
 
     if (self->m_is_inside_present) {
         return self->m_d3d_present_hook.call<HRESULT>(swap_chain, sync_interval, flags);
@@ -783,17 +765,18 @@ HRESULT D3DModule::d3d12_present_hook(IDXGISwapChain* swap_chain, UINT sync_inte
                 self->m_d3d12_srv_heap
             );
         }
+    }
 
-        if (config.get_primitive_rendering_enabled()) {
-            prm->late_init(self.get(), swap_chain);
-        }
+    // Checked every frame, primitive rendering can be switched on by reloading the loader config
+    if (config.PrimitiveRenderingEnabled && !prm->is_initialized()) {
+        prm->late_init(self, swap_chain);
     }
 
     if (!self->m_d3d12_command_queue) {
         return self->m_d3d_present_hook.call<HRESULT>(swap_chain, sync_interval, flags);
     }
 
-    const auto facility = (uintptr_t)self->m_get_singleton("sFacility");
+    const auto facility = (uintptr_t)SingletonModule::get(Singleton::Facility);
 
     // Check if Steamworks is active. This is a very hacky fix for the AutoSteamworks app,
     // which sometimes sends invalid input events that trip up ImGui.
@@ -804,7 +787,13 @@ HRESULT D3DModule::d3d12_present_hook(IDXGISwapChain* swap_chain, UINT sync_inte
         return self->m_d3d_present_hook.call<HRESULT>(swap_chain, sync_interval, flags);
     }
 
-    self->d3d12_present_hook_core(swap_chain, prm);
+    // Frame boundary, nothing managed is running on this thread
+    PluginWatcherModule::on_frame_boundary();
+
+    {
+        HOOK_STATS_SCOPE("D3DModule::d3d12_present_hook");
+        self->d3d12_present_hook_core(swap_chain, prm);
+    }
 
     const HRESULT result = self->m_d3d_present_hook.call<HRESULT>(swap_chain, sync_interval, flags);
     self->m_is_inside_present = false;
@@ -812,12 +801,16 @@ HRESULT D3DModule::d3d12_present_hook(IDXGISwapChain* swap_chain, UINT sync_inte
     return result;
 }
 
-void D3DModule::d3d12_present_hook_core(IDXGISwapChain* swap_chain, const std::shared_ptr<PrimitiveRenderingModule>& prm) {
+void D3DModule::d3d12_present_hook_core(IDXGISwapChain* swap_chain, PrimitiveRenderingModule* prm) {
     const auto swap_chain3 = (IDXGISwapChain3*)swap_chain;
-    const auto& config = preloader::LoaderConfig::get();
+    const auto& config = preloader::LoaderConfig::snapshot();
+
+    if (config.PrimitiveRenderingEnabled) {
+        {
+            HOOK_STATS_SCOPE("D3DModule::core_render");
+            m_core_render();
+        }
 
-    if (config.get_primitive_rendering_enabled()) {
-        m_core_render();
         prm->render_primitives_for_d3d12(swap_chain3, m_d3d12_command_queue);
     }
 
@@ -825,7 +818,11 @@ void D3DModule::d3d12_present_hook_core(IDXGISwapChain* swap_chain, const std::s
     ImGui_ImplDX12_NewFrame();
     ImGui_ImplWin32_NewFrame();
 
-    ImDrawData* draw_data = m_core_imgui_render();
+    ImDrawData* draw_data;
+    {
+        HOOK_STATS_SCOPE("D3DModule::core_imgui_render");
+        draw_data = m_core_imgui_render();
+    }
 
     const FrameContext& frame_ctx = m_d3d12_frame_contexts[swap_chain3->GetCurrentBackBufferIndex()];
     frame_ctx.CommandAllocator->Reset();
@@ -866,12 +863,16 @@ void D3DModule::d3d12_present_hook_core(IDXGISwapChain* swap_chain, const std::s
 void D3DModule::d3d12_execute_command_lists_hook(ID3D12CommandQueue* command_queue, UINT num_command_lists, ID3D12CommandList* const* command_lists) {
     const auto self = NativePluginFramework::get_module<D3DModule>();
 
-    if (!self->m_d3d12_command_queue && command_queue->GetDesc().Type == D3D12_COMMAND_LIST_TYPE_DIRECT) {
-        dlog::debug("Found D3D12 command queue");
-        self->m_d3d12_command_queue = command_queue;
+    {
+        HOOK_STATS_SCOPE("D3DModule::d3d12_execute_command_lists_hook");
+
+        if (!self->m_d3d12_command_queue && command_queue->GetDesc().Type == D3D12_COMMAND_LIST_TYPE_DIRECT) {
+            dlog::debug("Found D3D12 command queue");
+            self->m_d3d12_command_queue = command_queue;
 
-        if (self->m_texture_manager) {
-            self->m_texture_manager->update_command_queue(command_queue);
+            if (self->m_texture_manager) {
+                self->m_texture_manager->update_command_queue(command_queue);
+            }
         }
     }
 
@@ -880,10 +881,16 @@ void D3DModule::d3d12_execute_command_lists_hook(ID3D12CommandQueue* command_que
 
 UINT64 D3DModule::d3d12_signal_hook(ID3D12CommandQueue* command_queue, ID3D12Fence* fence, UINT64 value) {
     const auto self = NativePluginFramework::get_module<D3DModule>();
+    const auto prm = NativePluginFramework::get_module<PrimitiveRenderingModule>();
 
-    if (self->m_d3d12_command_queue == command_queue) {
-        self->m_d3d12_fence = fence;
-        self->m_d3d12_fence_value = value;
+    {
+        HOOK_STATS_SCOPE("D3DModule::d3d12_signal_hook");
+
+        // The primitive renderer signals its own fence on the game's queue
+        if (self->m_d3d12_command_queue == command_queue && fence != prm->get_d3d12_fence()) {
+            self->m_d3d12_fence = fence;
+            self->m_d3d12_fence_value = value;
+        }
     }
 
     return self->m_d3d_signal_hook.call<UINT64>(command_queue, fence, value);
@@ -913,7 +920,7 @@ HRESULT D3DModule::d3d_resize_buffers_hook(IDXGISwapChain* swap_chain, UINT buff
 HRESULT D3DModule::d3d11_present_hook(IDXGISwapChain* swap_chain, UINT sync_interval, UINT flags) {
     const auto self = NativePluginFramework::get_module<D3DModule>();
     const auto prm = NativePluginFramework::get_module<PrimitiveRenderingModule>();
-    const auto& config = preloader::LoaderConfig::get();
+    const auto& config = preloader::LoaderConfig::snapshot();
 
     if (self->m_is_inside_present) {
         return self->m_d3d_present_hook.call<HRESULT>(swap_chain, sync_interval, flags);
@@ -927,13 +934,19 @@ HRESULT D3DModule::d3d11_present_hook(IDXGISwapChain* swap_chain, UINT sync_inte
         if (!self->m_texture_manager) {
             self->m_texture_manager = std::make_unique<TextureManager>(self->m_d3d11_device, self->m_d3d11_device_context);
         }
-        
-        if (config.get_primitive_rendering_enabled()) {
-            prm->late_init(self.get(), swap_chain);
-        }
     }
 
-    self->d3d11_present_hook_core(swap_chain, prm);
+    // Checked every frame, primitive rendering can be switched on by reloading the loader config
+    if (config.PrimitiveRenderingEnabled && !prm->is_initialized()) {
+        prm->late_init(self, swap_chain);
+    }
+
+    PluginWatcherModule::on_frame_boundary();
+
+    {
+        HOOK_STATS_SCOPE("D3DModule::d3d11_present_hook");
+        self->d3d11_present_hook_core(swap_chain, prm);
+    }
 
     const auto result = self->m_d3d_present_hook.call<HRESULT>(swap_chain, sync_interval, flags);
     self->m_is_inside_present = false;
@@ -941,18 +954,26 @@ HRESULT D3DModule::d3d11_present_hook(IDXGISwapChain* swap_chain, UINT sync_inte
     return result;
 }
 
-void D3DModule::d3d11_present_hook_core(IDXGISwapChain* swap_chain, const std::shared_ptr<PrimitiveRenderingModule>& prm) const {
-    const auto& config = preloader::LoaderConfig::get();
+void D3DModule::d3d11_present_hook_core(IDXGISwapChain* swap_chain, PrimitiveRenderingModule* prm) const {
+    const auto& config = preloader::LoaderConfig::snapshot();
+
+    if (config.PrimitiveRenderingEnabled) {
+        {
+            HOOK_STATS_SCOPE("D3DModule::core_render");
+            m_core_render();
+        }
 
-    if (config.get_primitive_rendering_enabled()) {
-        m_core_render();
         prm->render_primitives_for_d3d11(m_d3d11_device_context);
     }
 
     ImGui_ImplDX11_NewFrame();
     ImGui_ImplWin32_NewFrame();
 
-    const auto draw_data = m_core_imgui_render();
+    ImDrawData* draw_data;
+    {
+        HOOK_STATS_SCOPE("D3DModule::core_imgui_render");
+        draw_data = m_core_imgui_render();
+    }
 
     ImGui_ImplDX11_RenderDrawData(draw_data);
 
@@ -969,6 +990,7 @@ extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg
 LRESULT D3DModule::my_window_proc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam) {
     const auto self = NativePluginFramework::get_module<D3DModule>();
     if (self->m_is_initialized) {
+        HOOK_STATS_SCOPE("D3DModule::my_window_proc");
         ImGui_ImplWin32_WndProcHandler(hwnd, msg, wparam, lparam);
     }
     return CallWindowProc(self->m_game_window_proc, hwnd, msg, wparam, lparam);
@@ -14,10 +14,15 @@
 
 #include <vector>
 
+class ChunkModule;
+class SingletonModule;
+
 class D3DModule final : public NativeModule {
     template<typename T> using ComPtr = Microsoft::WRL::ComPtr<T>;
 
 public:
+    using Dependencies = ModuleList<ChunkModule, SingletonModule>;
+
     void initialize(CoreClr* coreclr) override;
     void shutdown() override;
 
@@ -44,12 +49,12 @@ private:
     static void title_menu_ready_hook(void* gui);
 
     static HRESULT d3d12_present_hook(IDXGISwapChain* swap_chain, UINT sync_interval, UINT flags);
-    void d3d12_present_hook_core(IDXGISwapChain* swap_chain, const std::shared_ptr<PrimitiveRenderingModule>& prm);
+    void d3d12_present_hook_core(IDXGISwapChain* swap_chain, PrimitiveRenderingModule* prm);
     static void d3d12_execute_command_lists_hook(ID3D12CommandQueue* command_queue, UINT num_command_lists, ID3D12CommandList* const* command_lists);
     static UINT64 d3d12_signal_hook(ID3D12CommandQueue* command_queue, ID3D12Fence* fence, UINT64 value);
 
     static HRESULT d3d11_present_hook(IDXGISwapChain* swap_chain, UINT sync_interval, UINT flags);
-    void d3d11_present_hook_core(IDXGISwapChain* swap_chain, const std::shared_ptr<PrimitiveRenderingModule>& prm) const;
+    void d3d11_present_hook_core(IDXGISwapChain* swap_chain, PrimitiveRenderingModule* prm) const;
 
     static HRESULT d3d_resize_buffers_hook(IDXGISwapChain* swap_chain, UINT buffer_count, UINT w, UINT h, DXGI_FORMAT format, UINT flags);
     static LRESULT my_window_proc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam);
@@ -125,7 +130,6 @@ private:
     void(*m_core_render)() = nullptr;
     int(*m_core_get_custom_fonts)(CustomFont** out_fonts) = nullptr;
     void(*m_core_resolve_custom_fonts)() = nullptr;
-    void* (*m_get_singleton)(const char* name) = nullptr;
 
     friend class PrimitiveRenderingModule;
 
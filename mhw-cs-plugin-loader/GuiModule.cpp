@@ -3,6 +3,7 @@
 #include "Config.h"
 #include "Log.h"
 #include "NativePluginFramework.h"
+#include "SingletonModule.h"
 
 #include <dti/dti_types.h>
 
@@ -32,11 +33,6 @@ void GuiModule::initialize(CoreClr* coreclr) {
         L"SharpPluginLoader.Core.Gui",
         L"PropagateDialogResult"
     );
-    m_get_singleton = coreclr->get_method<void* (const char*)>(
-        config::SPL_CORE_ASSEMBLY_NAME,
-        L"SharpPluginLoader.Core.SingletonManager",
-        L"GetSingletonNative"
-    );
 
     if (m_propagate_dialog_result == nullptr) {
         dlog::error("Failed to get method SharpPluginLoader.Core.Gui.PropagateDialogResult");
@@ -56,7 +52,7 @@ void GuiModule::initialize(CoreClr* coreclr) {
 
     m_dialog_vtable[2] = (void*)m_propagate_dialog_result;
 
-    coreclr->add_internal_call("QueueYesNoDialog", display_dialog);
+    coreclr->add_internal_call<InternalCallId::QueueYesNoDialog>(display_dialog);
 
     m_display_dialog = (decltype(m_display_dialog))NativePluginFramework::get_repository_address("Gui:DisplayYesNoDialog");
     dlog::debug("DisplayYesNoDialog = {:p}", (void*)m_display_dialog);
@@ -80,7 +76,7 @@ void GuiModule::display_dialog(const char* message) {
     elements[1].vft = gui->m_dialog_vtable.data();
     elements[1].m_self = &elements[1];
 
-    gui->m_display_dialog(gui->m_get_singleton("sMhGUI"), elements);
+    gui->m_display_dialog(SingletonModule::get(Singleton::MhGUI), elements);
 }
 
 GuiElement* GuiModule::gui_element_set_vtable(const GuiElement* self, GuiElement* other) {
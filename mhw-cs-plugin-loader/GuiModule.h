@@ -4,9 +4,12 @@
 #include <array>
 
 struct GuiElement;
+class SingletonModule;
 
 class GuiModule final : public NativeModule {
 public:
+    using Dependencies = ModuleList<SingletonModule>;
+
     void initialize(CoreClr* coreclr) override;
     void shutdown() override;
 
@@ -15,7 +18,6 @@ private:
     static GuiElement* gui_element_set_vtable(const GuiElement* self, GuiElement* other);
 
 private:
-    void*(*m_get_singleton)(const char* name) = nullptr;
     void(*m_propagate_dialog_result)(void*, void*, int) = nullptr;
     void(*m_display_dialog)(void*, void*) = nullptr;
 
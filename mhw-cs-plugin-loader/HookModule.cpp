@@ -0,0 +1,178 @@
+#include "HookModule.h"
+#include "CoreClr.h"
+#include "Config.h"
+#include "Log.h"
+#include "NativePluginFramework.h"
+
+#include <algorithm>
+#include <format>
+
+std::array<HookModule::Target, HookModule::MAX_TARGETS> HookModule::s_targets{};
+
+void HookModule::initialize(CoreClr* coreclr) {
+    s_dispatch_managed = coreclr->get_method<void(uintptr_t, safetyhook::Context*)>(
+        config::SPL_CORE_ASSEMBLY_NAME,
+        L"SharpPluginLoader.Core.Memory.MulticastHook",
+        L"Dispatch"
+    );
+
+    coreclr->add_internal_call<InternalCallId::HookAddManagedSubscriber>(add_managed_subscriber);
+    coreclr->add_internal_call<InternalCallId::HookRemoveManagedSubscriber>(remove_managed_subscriber);
+}
+
+void HookModule::shutdown() {
+    std::lock_guard lock(m_mutex);
+
+    for (u32 i = 0; i < m_target_count; ++i) {
+        auto& target = s_targets[i];
+        target.Subscribers.store(nullptr, std::memory_order_release);
+        target.Hook = {};
+        target.Snapshots.clear();
+        target.ManagedSubscribers = 0;
+        target.Address = 0;
+    }
+
+    m_target_count = 0;
+    s_dispatch_managed = nullptr;
+}
+
+u32 HookModule::subscribe(uintptr_t target, Callback callback, void* user_data, i32 priority) {
+    std::lock_guard lock(m_mutex);
+
+    const auto entry = find_or_create_target(target);
+    if (!entry) {
+        return 0;
+    }
+
+    const auto current = entry->Subscribers.load(std::memory_order_relaxed);
+    auto subscribers = current ? *current : std::vector<Subscriber>{};
+
+    const u32 id = m_next_id++;
+    insert_sorted(subscribers, { callback, user_data, priority, id });
+    publish(*entry, std::move(subscribers));
+
+    return id;
+}
+
+void HookModule::unsubscribe(uintptr_t target, u32 id) {
+    std::lock_guard lock(m_mutex);
+
+    const auto entry = std::find_if(s_targets.begin(), s_targets.begin() + m_target_count, [target](const Target& t) {
+        return t.Address == target;
+    });
+    if (entry == s_targets.begin() + m_target_count) {
+        return;
+    }
+
+    const auto current = entry->Subscribers.load(std::memory_order_relaxed);
+    if (!current) {
+        return;
+    }
+
+    auto subscribers = *current;
+    std::erase_if(subscribers, [id](const Subscriber& s) { return s.Id == id; });
+    publish(*entry, std::move(subscribers));
+}
+
+HookModule::Target* HookModule::find_or_create_target(uintptr_t target) {
+    for (u32 i = 0; i < m_target_count; ++i) {
+        if (s_targets[i].Address == target) {
+            return &s_targets[i];
+        }
+    }
+
+    if (m_target_count == MAX_TARGETS) {
+        dlog::error("[HookModule] Cannot hook 0x{:X}, all {} hook slots are in use", target, MAX_TARGETS);
+        return nullptr;
+    }
+
+    const u32 slot = m_target_count;
+    auto hook = SafetyHookMid::create((void*)target, get_dispatcher(slot));
+    if (!hook) {
+        dlog::error("[HookModule] Failed to hook 0x{:X}", target);
+        return nullptr;
+    }
+
+    auto& entry = s_targets[slot];
+    entry.Address = target;
+    entry.StatsCounter = hook_stats::register_counter(std::format("HookModule 0x{:X}", target));
+    entry.ManagedStatsCounter = hook_stats::register_counter(std::format("HookModule 0x{:X} (managed)", target));
+    entry.Hook = std::move(*hook);
+    ++m_target_count;
+
+    dlog::debug("[HookModule] Hooked 0x{:X} in slot {}", target, slot);
+    return &entry;
+}
+
+void HookModule::publish(Target& target, std::vector<Subscriber>&& subscribers) {
+    auto snapshot = std::make_unique<const std::vector<Subscriber>>(std::move(subscribers));
+    target.Subscribers.store(snapshot.get(), std::memory_order_release);
+    target.Snapshots.push_back(std::move(snapshot));
+}
+
+void HookModule::insert_sorted(std::vector<Subscriber>& subscribers, const Subscriber& subscriber) {
+    // Descending priority, subscribers with equal priority run in subscription order
+    const auto it = std::upper_bound(subscribers.begin(), subscribers.end(), subscriber, [](const Subscriber& a, const Subscriber& b) {
+        return a.Priority > b.Priority;
+    });
+
+    subscribers.insert(it, subscriber);
+}
+
+bool HookModule::add_managed_subscriber(uintptr_t target) {
+    if (!s_dispatch_managed) {
+        dlog::error("[HookModule] Managed hook dispatcher is not available");
+        return false;
+    }
+
+    const auto self = NativePluginFramework::get_module<HookModule>();
+    std::lock_guard lock(self->m_mutex);
+
+    const auto entry = self->find_or_create_target(target);
+    if (!entry) {
+        return false;
+    }
+
+    // All managed subscribers share a single entry, the managed side keeps its own (sorted) list
+    if (entry->ManagedSubscribers++ == 0) {
+        const auto current = entry->Subscribers.load(std::memory_order_relaxed);
+        auto subscribers = current ? *current : std::vector<Subscriber>{};
+
+        insert_sorted(subscribers, { dispatch_managed, entry, MANAGED_PRIORITY, 0 });
+        publish(*entry, std::move(subscribers));
+    }
+
+    return true;
+}
+
+void HookModule::remove_managed_subscriber(uintptr_t target) {
+    const auto self = NativePluginFramework::get_module<HookModule>();
+    std::lock_guard lock(self->m_mutex);
+
+    for (u32 i = 0; i < self->m_target_count; ++i) {
+        auto& entry = s_targets[i];
+        if (entry.Address != target || entry.ManagedSubscribers == 0) {
+            continue;
+        }
+
+        if (--entry.ManagedSubscribers == 0) {
+            auto subscribers = *entry.Subscribers.load(std::memory_order_relaxed);
+            std::erase_if(subscribers, [](const Subscriber& s) { return s.Fn == dispatch_managed; });
+            publish(entry, std::move(subscribers));
+        }
+
+        return;
+    }
+}
+
+void HookModule::dispatch_managed(safetyhook::Context& ctx, void* user_data) {
+    const auto target = (Target*)user_data;
+
+    hook_stats::ScopedTimer timer{ target->ManagedStatsCounter };
+    s_dispatch_managed(target->Address, &ctx);
+}
+
+safetyhook::MidHookFn HookModule::get_dispatcher(size_t slot) {
+    static constexpr auto dispatchers = make_dispatchers(std::make_index_sequence<MAX_TARGETS>{});
+    return dispatchers[slot];
+}
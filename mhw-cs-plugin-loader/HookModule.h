@@ -0,0 +1,93 @@
+#pragma once
+#include "HookStats.h"
+#include "NativeModule.h"
+#include "SharpPluginLoader.h"
+
+#include <safetyhook/safetyhook.hpp>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Multicast hooks on the entry of game functions. Each target address gets a single
+// mid-function detour, no matter how many subscribers it has. Subscribers receive the
+// register context at the function's entry (so arguments are in rcx, rdx, r8 and r9)
+// and may modify it before the original function runs.
+//
+// The subscriber list of a target is an immutable snapshot that is swapped on change,
+// so dispatching never takes a lock. Native subscribers are called directly, all managed
+// subscribers of a target share one transition into managed code (at priority 0).
+class HookModule final : public NativeModule {
+public:
+    using Callback = void(*)(safetyhook::Context& ctx, void* user_data);
+
+    // Maximum number of distinct target addresses
+    static constexpr size_t MAX_TARGETS = 128;
+    // Priority at which the managed subscribers of a target are dispatched
+    static constexpr i32 MANAGED_PRIORITY = 0;
+
+    void initialize(CoreClr* coreclr) override;
+    void shutdown() override;
+
+    // Subscribes a native callback to the entry of `target`. Subscribers with a higher priority run first.
+    // Returns a subscription id that can be passed to unsubscribe, or 0 on failure.
+    u32 subscribe(uintptr_t target, Callback callback, void* user_data, i32 priority = 0);
+    void unsubscribe(uintptr_t target, u32 id);
+
+private:
+    struct Subscriber {
+        Callback Fn;
+        void* UserData;
+        i32 Priority;
+        u32 Id;
+    };
+
+    struct Target {
+        uintptr_t Address = 0;
+        SafetyHookMid Hook{};
+        u32 ManagedSubscribers = 0;
+        u32 StatsCounter = hook_stats::MAX_COUNTERS;
+        u32 ManagedStatsCounter = hook_stats::MAX_COUNTERS;
+        std::atomic<const std::vector<Subscriber>*> Subscribers = nullptr;
+        // Previous snapshots, a dispatch may still be reading them. Freed on shutdown.
+        std::vector<std::unique_ptr<const std::vector<Subscriber>>> Snapshots;
+    };
+
+    Target* find_or_create_target(uintptr_t target);
+    static void publish(Target& target, std::vector<Subscriber>&& subscribers);
+    static void insert_sorted(std::vector<Subscriber>& subscribers, const Subscriber& subscriber);
+
+    static bool add_managed_subscriber(uintptr_t target);
+    static void remove_managed_subscriber(uintptr_t target);
+    static void dispatch_managed(safetyhook::Context& ctx, void* user_data);
+
+    template<size_t Slot>
+    static void dispatch(safetyhook::Context& ctx) {
+        hook_stats::ScopedTimer timer{ s_targets[Slot].StatsCounter };
+
+        const auto subscribers = s_targets[Slot].Subscribers.load(std::memory_order_acquire);
+        if (subscribers) {
+            for (const auto& subscriber : *subscribers) {
+                subscriber.Fn(ctx, subscriber.UserData);
+            }
+        }
+    }
+
+    template<size_t... Slots>
+    static constexpr auto make_dispatchers(std::index_sequence<Slots...>) {
+        return std::array<safetyhook::MidHookFn, sizeof...(Slots)>{ &dispatch<Slots>... };
+    }
+
+    static safetyhook::MidHookFn get_dispatcher(size_t slot);
+
+private:
+    std::mutex m_mutex;
+    u32 m_target_count = 0;
+    u32 m_next_id = 1;
+
+    static inline void(*s_dispatch_managed)(uintptr_t target, safetyhook::Context* ctx) = nullptr;
+    static std::array<Target, MAX_TARGETS> s_targets;
+};
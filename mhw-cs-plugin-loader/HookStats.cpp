@@ -0,0 +1,283 @@
+#include "HookStats.h"
+
+#include <Windows.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace hook_stats {
+namespace {
+
+struct CounterShard {
+    std::atomic<u64> Calls;
+    std::atomic<u64> Total;
+    std::atomic<u64> Max;
+    std::array<std::atomic<u64>, BUCKET_COUNT> Buckets;
+
+    void add(const CounterShard& other) {
+        Calls.store(Calls.load(std::memory_order_relaxed) + other.Calls.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        Total.store(Total.load(std::memory_order_relaxed) + other.Total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        Max.store((std::max)(Max.load(std::memory_order_relaxed), other.Max.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+
+        for (u32 i = 0; i < BUCKET_COUNT; ++i) {
+            Buckets[i].store(Buckets[i].load(std::memory_order_relaxed) + other.Buckets[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+
+    void clear() {
+        Calls.store(0, std::memory_order_relaxed);
+        Total.store(0, std::memory_order_relaxed);
+        Max.store(0, std::memory_order_relaxed);
+
+        for (auto& bucket : Buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+// Only ever written by the thread that owns it, readers sum up all shards.
+struct Shard {
+    std::array<CounterShard, MAX_COUNTERS> Counters{};
+};
+
+struct Counter {
+    const std::string* Name = nullptr;
+    Clock Source;
+    u32 References = 0; // 0 for a free slot
+};
+
+// Never destroyed, threads can still exit (and retire their shard) while the DLL is being unloaded
+struct Registry {
+    std::mutex Mutex;
+    std::array<Counter, MAX_COUNTERS> Counters{};
+    u32 SlotCount = 0; // Slots that were ever used, free ones below it are reused first
+    // Every name ever registered. Statistics hand out pointers to these, so they outlive their counter.
+    std::unordered_set<std::string> Names;
+    std::vector<std::unique_ptr<Shard>> Shards;
+    Shard Retired{}; // What threads that have exited recorded
+};
+
+Registry& get_registry() {
+    static auto registry = new Registry();
+    return *registry;
+}
+
+// Owns the calling thread's shard. When the thread exits its counts move into Registry::Retired
+// and the shard is freed, so thread pools that come and go don't keep adding shards.
+struct ThreadShard {
+    Shard* Value = nullptr;
+
+    ~ThreadShard() {
+        if (!Value) {
+            return;
+        }
+
+        auto& registry = get_registry();
+        std::lock_guard lock(registry.Mutex);
+
+        for (u32 i = 0; i < MAX_COUNTERS; ++i) {
+            registry.Retired.Counters[i].add(Value->Counters[i]);
+        }
+
+        std::erase_if(registry.Shards, [this](const auto& shard) { return shard.get() == Value; });
+        Value = nullptr;
+    }
+};
+
+thread_local ThreadShard t_shard;
+
+// Reference points for calibrating the TSC against QueryPerformanceCounter. The longer the
+// process runs, the more accurate the calibration gets, without ever having to wait for it.
+const u64 s_tsc_origin = __rdtsc();
+const i64 s_qpc_origin = [] {
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+}();
+
+Shard& get_shard() {
+    if (!t_shard.Value) {
+        auto shard = std::make_unique<Shard>();
+        t_shard.Value = shard.get();
+
+        auto& registry = get_registry();
+        std::lock_guard lock(registry.Mutex);
+        registry.Shards.push_back(std::move(shard));
+    }
+
+    return *t_shard.Value;
+}
+
+void increment(std::atomic<u64>& value, u64 amount) {
+    // Single writer per shard, so no locked read-modify-write is needed
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+f64 qpc_ticks_per_us() {
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return (f64)frequency.QuadPart / 1'000'000.0;
+}
+
+f64 tsc_ticks_per_us() {
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+
+    const f64 elapsed_us = (f64)(counter.QuadPart - s_qpc_origin) / qpc_ticks_per_us();
+    if (elapsed_us <= 0.0) {
+        return 1.0;
+    }
+
+    return (f64)(__rdtsc() - s_tsc_origin) / elapsed_us;
+}
+
+f64 percentile(const std::array<u64, BUCKET_COUNT>& buckets, u64 calls, f64 fraction) {
+    const u64 threshold = (std::max)((u64)((f64)calls * fraction), (u64)1);
+
+    u64 cumulative = 0;
+    for (u32 i = 0; i < BUCKET_COUNT; ++i) {
+        cumulative += buckets[i];
+        if (cumulative >= threshold) {
+            return (f64)(1ull << i);
+        }
+    }
+
+    return (f64)(1ull << (BUCKET_COUNT - 1));
+}
+
+}
+
+u32 register_counter(std::string_view name, Clock clock) {
+    auto& registry = get_registry();
+    std::lock_guard lock(registry.Mutex);
+
+    u32 free_slot = MAX_COUNTERS;
+    for (u32 i = 0; i < registry.SlotCount; ++i) {
+        auto& counter = registry.Counters[i];
+        if (counter.References == 0) {
+            free_slot = (std::min)(free_slot, i);
+        } else if (*counter.Name == name) {
+            ++counter.References;
+            return i;
+        }
+    }
+
+    if (free_slot == MAX_COUNTERS) {
+        if (registry.SlotCount == MAX_COUNTERS) {
+            return MAX_COUNTERS;
+        }
+
+        free_slot = registry.SlotCount++;
+    }
+
+    const auto interned = registry.Names.emplace(name).first;
+    registry.Counters[free_slot] = { &*interned, clock, 1 };
+    return free_slot;
+}
+
+void unregister_counter(u32 counter) {
+    if (counter >= MAX_COUNTERS) {
+        return;
+    }
+
+    auto& registry = get_registry();
+    std::lock_guard lock(registry.Mutex);
+
+    auto& entry = registry.Counters[counter];
+    if (entry.References == 0 || --entry.References != 0) {
+        return;
+    }
+
+    // The slot starts out empty when it is reused
+    for (const auto& shard : registry.Shards) {
+        shard->Counters[counter].clear();
+    }
+
+    registry.Retired.Counters[counter].clear();
+}
+
+u32 register_managed_counter(const char* name) {
+    return register_counter(name, Clock::Qpc);
+}
+
+void record(u32 counter, u64 elapsed) {
+    if (counter >= MAX_COUNTERS) {
+        return;
+    }
+
+    auto& shard = get_shard().Counters[counter];
+    const u32 bucket = (std::min)((u32)std::bit_width(elapsed), BUCKET_COUNT - 1);
+
+    increment(shard.Calls, 1);
+    increment(shard.Total, elapsed);
+    increment(shard.Buckets[bucket], 1);
+
+    if (elapsed > shard.Max.load(std::memory_order_relaxed)) {
+        shard.Max.store(elapsed, std::memory_order_relaxed);
+    }
+}
+
+u32 get_statistics(HookStatistics* stats, u32 capacity) {
+    auto& registry = get_registry();
+    std::lock_guard lock(registry.Mutex);
+
+    const f64 ticks_per_us[] = { tsc_ticks_per_us(), qpc_ticks_per_us() };
+    u32 written = 0;
+
+    for (u32 i = 0; i < registry.SlotCount && written < capacity; ++i) {
+        const auto& entry = registry.Counters[i];
+        if (entry.References == 0) {
+            continue;
+        }
+
+        CounterShard sum{};
+        sum.add(registry.Retired.Counters[i]);
+        for (const auto& shard : registry.Shards) {
+            sum.add(shard->Counters[i]);
+        }
+
+        std::array<u64, BUCKET_COUNT> buckets{};
+        for (u32 b = 0; b < BUCKET_COUNT; ++b) {
+            buckets[b] = sum.Buckets[b].load(std::memory_order_relaxed);
+        }
+
+        const u64 calls = sum.Calls.load(std::memory_order_relaxed);
+        const u64 total = sum.Total.load(std::memory_order_relaxed);
+        const f64 scale = ticks_per_us[(u32)entry.Source];
+        stats[written++] = {
+            .Name = entry.Name->c_str(),
+            .Calls = calls,
+            .TotalMs = (f64)total / scale / 1000.0,
+            .MeanUs = calls ? (f64)total / (f64)calls / scale : 0.0,
+            .P50Us = calls ? percentile(buckets, calls, 0.50) / scale : 0.0,
+            .P99Us = calls ? percentile(buckets, calls, 0.99) / scale : 0.0,
+            .MaxUs = (f64)sum.Max.load(std::memory_order_relaxed) / scale
+        };
+    }
+
+    return written;
+}
+
+void reset() {
+    auto& registry = get_registry();
+    std::lock_guard lock(registry.Mutex);
+
+    for (const auto& shard : registry.Shards) {
+        for (auto& counter : shard->Counters) {
+            counter.clear();
+        }
+    }
+
+    for (auto& counter : registry.Retired.Counters) {
+        counter.clear();
+    }
+}
+
+}
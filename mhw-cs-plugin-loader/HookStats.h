@@ -0,0 +1,76 @@
+#pragma once
+
+#include "SharpPluginLoader.h"
+
+#include <intrin.h>
+
+#include <string_view>
+
+// Always-on call counters and latency histograms for the code SPL runs inside game hooks.
+// Every thread records into its own shard, so recording is a handful of uncontended stores.
+// Shards are only summed up when statistics are queried, and freed when their thread exits.
+namespace hook_stats {
+
+constexpr u32 MAX_COUNTERS = 128;
+// Latency histograms use log2 buckets, bucket i counts samples in [2^(i-1), 2^i) clock ticks.
+constexpr u32 BUCKET_COUNT = 32;
+
+enum class Clock : u32 {
+    Tsc, // __rdtsc() cycles, used by native hooks
+    Qpc  // QueryPerformanceCounter ticks (Stopwatch.GetTimestamp() in managed code)
+};
+
+// Mirrored by SharpPluginLoader.Core.HookStatistics
+struct HookStatistics {
+    const char* Name;
+    u64 Calls;
+    f64 TotalMs;
+    f64 MeanUs;
+    f64 P50Us; // Percentiles are the upper bound of the bucket they fall into
+    f64 P99Us;
+    f64 MaxUs;
+};
+
+// Returns the id of the counter with the given name, creating it if necessary.
+// Returns MAX_COUNTERS (which record ignores) if all counters are in use.
+u32 register_counter(std::string_view name, Clock clock = Clock::Tsc);
+
+// Releases one registration of a counter. Once every registration is released, the counter's data is
+// cleared in all shards and its id may be handed out again. A call still being recorded at that moment
+// can leave a sample behind in the next counter to use the id.
+void unregister_counter(u32 counter);
+
+// Records one call that took `elapsed` ticks of the counter's clock.
+void record(u32 counter, u64 elapsed);
+
+// Fills `stats` with up to `capacity` counters. Returns the number of counters written.
+u32 get_statistics(HookStatistics* stats, u32 capacity);
+
+// Clears all counters. Calls being recorded concurrently may survive the reset.
+void reset();
+
+// Internal call used by the managed side, managed counters use Clock::Qpc.
+u32 register_managed_counter(const char* name);
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(u32 counter) : m_counter(counter), m_start(__rdtsc()) {}
+    ~ScopedTimer() { record(m_counter, __rdtsc() - m_start); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    u32 m_counter;
+    u64 m_start;
+};
+
+}
+
+#define HOOK_STATS_CONCAT_IMPL(a, b) a##b
+#define HOOK_STATS_CONCAT(a, b) HOOK_STATS_CONCAT_IMPL(a, b)
+
+// Times the rest of the enclosing scope under the given (string literal) counter name.
+#define HOOK_STATS_SCOPE(name) \
+    static const u32 HOOK_STATS_CONCAT(hook_stats_counter_, __LINE__) = ::hook_stats::register_counter(name); \
+    ::hook_stats::ScopedTimer HOOK_STATS_CONCAT(hook_stats_timer_, __LINE__){ HOOK_STATS_CONCAT(hook_stats_counter_, __LINE__) }
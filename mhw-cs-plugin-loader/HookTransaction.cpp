@@ -0,0 +1,103 @@
+#include "HookTransaction.h"
+
+#include "Log.h"
+#include "Trace.h"
+
+#include <Windows.h>
+
+#include <unordered_set>
+
+namespace {
+
+bool is_executable(void* address) {
+    MEMORY_BASIC_INFORMATION mbi;
+    if (VirtualQuery(address, &mbi, sizeof(mbi)) == 0 || mbi.State != MEM_COMMIT) {
+        return false;
+    }
+
+    constexpr DWORD EXECUTABLE = PAGE_EXECUTE | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+    return (mbi.Protect & EXECUTABLE) != 0 && (mbi.Protect & PAGE_GUARD) == 0;
+}
+
+const char* error_name(const safetyhook::InlineHook::Error& error) {
+    using Error = safetyhook::InlineHook::Error;
+    switch (error.type) {
+    case Error::BAD_ALLOCATION: return "bad allocation";
+    case Error::FAILED_TO_DECODE_INSTRUCTION: return "failed to decode instruction";
+    case Error::SHORT_JUMP_IN_TRAMPOLINE: return "short jump in trampoline";
+    case Error::IP_RELATIVE_INSTRUCTION_OUT_OF_RANGE: return "ip relative instruction out of range";
+    case Error::UNSUPPORTED_INSTRUCTION_IN_TRAMPOLINE: return "unsupported instruction in trampoline";
+    default: return "unknown error";
+    }
+}
+
+}
+
+void HookTransaction::add(SafetyHookInline& hook, void* target, void* destination, std::string_view name) {
+    m_requests.push_back({ &hook, target, destination, std::string(name) });
+}
+
+bool HookTransaction::validate() const {
+    bool valid = true;
+    std::unordered_set<void*> targets;
+
+    for (const auto& request : m_requests) {
+        if (!request.Target || !is_executable(request.Target)) {
+            dlog::error("[HookTransaction] Target of {} (0x{:X}) is not executable memory", request.Name, (uintptr_t)request.Target);
+            valid = false;
+        } else if (!targets.insert(request.Target).second) {
+            dlog::error("[HookTransaction] Target of {} (0x{:X}) is hooked twice", request.Name, (uintptr_t)request.Target);
+            valid = false;
+        }
+
+        if (!request.Destination) {
+            dlog::error("[HookTransaction] Destination of {} is null", request.Name);
+            valid = false;
+        }
+    }
+
+    return valid;
+}
+
+bool HookTransaction::commit() {
+    TRACE_SCOPE("HookTransaction::commit");
+
+    if (!validate()) {
+        m_requests.clear();
+        return false;
+    }
+
+    std::vector<SafetyHookInline> hooks;
+    hooks.reserve(m_requests.size());
+
+    // No freeze of our own around this. Creating a hook decodes the target and allocates its
+    // trampoline first, then safetyhook suspends the other threads only for the jump it writes.
+    // Allocating while the other threads are suspended could deadlock on a heap lock one of them holds.
+    for (const auto& request : m_requests) {
+        auto result = SafetyHookInline::create(request.Target, request.Destination);
+        if (!result) {
+            dlog::error(
+                "[HookTransaction] Failed to hook {} at 0x{:X}: {}, rolling back {} hooks",
+                request.Name, (uintptr_t)request.Target, error_name(result.error()), hooks.size()
+            );
+
+            // Roll back in reverse order
+            while (!hooks.empty()) {
+                hooks.pop_back();
+            }
+
+            m_requests.clear();
+            return false;
+        }
+
+        hooks.push_back(std::move(*result));
+    }
+
+    for (size_t i = 0; i < m_requests.size(); ++i) {
+        *m_requests[i].Hook = std::move(hooks[i]);
+    }
+
+    dlog::debug("[HookTransaction] Installed {} hooks", m_requests.size());
+    m_requests.clear();
+    return true;
+}
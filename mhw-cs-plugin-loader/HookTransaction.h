@@ -0,0 +1,43 @@
+#pragma once
+
+#include <safetyhook/safetyhook.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Collects inline hooks and installs them as a unit. All targets are validated up front, so
+// nothing is patched if any of them is unusable. The hooks are then created one by one, and if
+// one of them still fails, the ones that were already installed are removed again and none of
+// the output hooks are touched.
+//
+// Each hook's trampoline is prepared while the process runs normally, the other threads are only
+// suspended for the few bytes written to its target. Until commit returns, another thread can see
+// some of the targets hooked and others not, so this is meant for places where the targets are
+// not yet running concurrently, e.g. during startup in the preloader.
+class HookTransaction {
+public:
+    // Queues an inline hook. `hook` is only assigned if the transaction commits successfully.
+    void add(SafetyHookInline& hook, void* target, void* destination, std::string_view name);
+
+    template<class TTarget, class TDestination>
+    void add(SafetyHookInline& hook, TTarget target, TDestination destination, std::string_view name) {
+        add(hook, reinterpret_cast<void*>(target), reinterpret_cast<void*>(destination), name);
+    }
+
+    // Installs all queued hooks. Returns false (with nothing installed) if any of them failed.
+    bool commit();
+
+private:
+    struct Request {
+        SafetyHookInline* Hook;
+        void* Target;
+        void* Destination;
+        std::string Name;
+    };
+
+    bool validate() const;
+
+private:
+    std::vector<Request> m_requests;
+};
@@ -0,0 +1,445 @@
+#include "InstanceBuilder.h"
+
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define SPL_INSTANCE_BUILDER_SSE 1
+#include <immintrin.h>
+#endif
+
+// MSVC allows AVX intrinsics in any function, elsewhere the AVX kernels are only built when compiling for AVX
+#if SPL_INSTANCE_BUILDER_SSE && (defined(_MSC_VER) || defined(__AVX__))
+#define SPL_INSTANCE_BUILDER_AVX 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace instance_builder {
+namespace {
+
+// Scalar versions, used for the tail of a batch and as the reference for the kernels
+
+void sphere_scalar(const SphereColumns& in, size_t i, InstanceData& out) {
+    const f32 r = in[sphere::Radius][i];
+
+    const f32 m[16] = {
+        r, 0.0f, 0.0f, in[sphere::X][i],
+        0.0f, r, 0.0f, in[sphere::Y][i],
+        0.0f, 0.0f, r, in[sphere::Z][i],
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+
+    std::memcpy(out.Transform, m, sizeof m);
+}
+
+void obb_scalar(const ObbColumns& in, size_t i, InstanceData& out) {
+    // scale * coord, transposed
+    for (size_t row = 0; row < 4; ++row) {
+        for (size_t col = 0; col < 4; ++col) {
+            const f32 scale = col < 3 ? in[obb::ExtentX + col][i] : 1.0f;
+            out.Transform[row * 4 + col] = in[obb::Coord + col * 4 + row][i] * scale;
+        }
+    }
+}
+
+void write_transposed(const f32 rotation[3][3], const f32 scale[3], const f32 translation[3], InstanceData& out) {
+    for (size_t row = 0; row < 3; ++row) {
+        for (size_t col = 0; col < 3; ++col) {
+            out.Transform[row * 4 + col] = rotation[col][row] * scale[col];
+        }
+
+        out.Transform[row * 4 + 3] = translation[row];
+    }
+
+    out.Transform[12] = 0.0f;
+    out.Transform[13] = 0.0f;
+    out.Transform[14] = 0.0f;
+    out.Transform[15] = 1.0f;
+}
+
+void capsule_scalar(const CapsuleColumns& in, size_t i, InstanceData& cylinder, InstanceData& top, InstanceData& bottom) {
+    f32 p0[3] = { in[capsule::P0X][i], in[capsule::P0Y][i], in[capsule::P0Z][i] };
+    f32 p1[3] = { in[capsule::P1X][i], in[capsule::P1Y][i], in[capsule::P1Z][i] };
+    if (p0[1] > p1[1]) {
+        std::swap(p0, p1);
+    }
+
+    const f32 d[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    const f32 length = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    const f32 inv_length = length > 0.0f ? 1.0f / length : 0.0f;
+
+    // Rotation from the Y axis onto the capsule axis, R = I + [v]x + [v]x^2 / (1 + c) with v = (0,1,0) x axis.
+    // The axis always points up after the swap, so 1 + c never reaches zero.
+    const f32 x = d[0] * inv_length;
+    const f32 y = d[1] * inv_length;
+    const f32 z = d[2] * inv_length;
+    const f32 k = 1.0f / (1.0f + y);
+
+    const f32 rotation[3][3] = {
+        { 1.0f - k * x * x, -x, -k * x * z },
+        { x, 1.0f - k * (x * x + z * z), z },
+        { -k * x * z, -z, 1.0f - k * z * z }
+    };
+
+    const f32 r = in[capsule::Radius][i];
+    const f32 scale_hemisphere[3] = { r, r, r };
+    const f32 scale_cylinder[3] = { r, length * 0.5f, r };
+    const f32 center[3] = { (p0[0] + p1[0]) * 0.5f, (p0[1] + p1[1]) * 0.5f, (p0[2] + p1[2]) * 0.5f };
+
+    write_transposed(rotation, scale_cylinder, center, cylinder);
+    write_transposed(rotation, scale_hemisphere, p1, top);
+    write_transposed(rotation, scale_hemisphere, p0, bottom);
+}
+
+#if SPL_INSTANCE_BUILDER_SSE
+
+struct SseOps {
+    using V = __m128;
+    static constexpr size_t WIDTH = 4;
+
+    static V load(const f32* p) { return _mm_loadu_ps(p); }
+    static V set(f32 v) { return _mm_set1_ps(v); }
+    static V add(V a, V b) { return _mm_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm_div_ps(a, b); }
+    static V sqrt(V a) { return _mm_sqrt_ps(a); }
+    static V greater(V a, V b) { return _mm_cmpgt_ps(a, b); }
+    static V select(V mask, V a, V b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+
+    // m holds the transposed matrix (m[row][col]), one instance per lane
+    static void store(const V (&m)[4][4], InstanceData* out) {
+        for (size_t row = 0; row < 4; ++row) {
+            V c0 = m[row][0], c1 = m[row][1], c2 = m[row][2], c3 = m[row][3];
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+            _mm_storeu_ps(out[0].Transform + row * 4, c0);
+            _mm_storeu_ps(out[1].Transform + row * 4, c1);
+            _mm_storeu_ps(out[2].Transform + row * 4, c2);
+            _mm_storeu_ps(out[3].Transform + row * 4, c3);
+        }
+    }
+};
+
+#endif
+
+#if SPL_INSTANCE_BUILDER_AVX
+
+struct AvxOps {
+    using V = __m256;
+    static constexpr size_t WIDTH = 8;
+
+    static V load(const f32* p) { return _mm256_loadu_ps(p); }
+    static V set(f32 v) { return _mm256_set1_ps(v); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm256_div_ps(a, b); }
+    static V sqrt(V a) { return _mm256_sqrt_ps(a); }
+    static V greater(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static V select(V mask, V a, V b) { return _mm256_blendv_ps(b, a, mask); }
+
+    static void store(const V (&m)[4][4], InstanceData* out) {
+        for (size_t row = 0; row < 4; ++row) {
+            // 4x8 transpose, the low 128 bits hold instances 0-3 and the high 128 bits instances 4-7
+            const V t0 = _mm256_unpacklo_ps(m[row][0], m[row][1]);
+            const V t1 = _mm256_unpackhi_ps(m[row][0], m[row][1]);
+            const V t2 = _mm256_unpacklo_ps(m[row][2], m[row][3]);
+            const V t3 = _mm256_unpackhi_ps(m[row][2], m[row][3]);
+
+            const V r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            const V r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            const V r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            const V r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+            _mm_storeu_ps(out[0].Transform + row * 4, _mm256_castps256_ps128(r0));
+            _mm_storeu_ps(out[1].Transform + row * 4, _mm256_castps256_ps128(r1));
+            _mm_storeu_ps(out[2].Transform + row * 4, _mm256_castps256_ps128(r2));
+            _mm_storeu_ps(out[3].Transform + row * 4, _mm256_castps256_ps128(r3));
+            _mm_storeu_ps(out[4].Transform + row * 4, _mm256_extractf128_ps(r0, 1));
+            _mm_storeu_ps(out[5].Transform + row * 4, _mm256_extractf128_ps(r1, 1));
+            _mm_storeu_ps(out[6].Transform + row * 4, _mm256_extractf128_ps(r2, 1));
+            _mm_storeu_ps(out[7].Transform + row * 4, _mm256_extractf128_ps(r3, 1));
+        }
+    }
+};
+
+#endif
+
+#if SPL_INSTANCE_BUILDER_SSE
+
+// Each kernel processes whole batches of [begin, end) and returns where it stopped,
+// the remaining tail is done by the scalar version.
+
+template<typename Ops>
+size_t spheres_simd(const SphereColumns& in, size_t begin, size_t end, InstanceData* out) {
+    using V = typename Ops::V;
+    const V zero = Ops::set(0.0f);
+    const V one = Ops::set(1.0f);
+
+    size_t i = begin;
+    for (; i + Ops::WIDTH <= end; i += Ops::WIDTH) {
+        const V r = Ops::load(in[sphere::Radius] + i);
+
+        const V m[4][4] = {
+            { r, zero, zero, Ops::load(in[sphere::X] + i) },
+            { zero, r, zero, Ops::load(in[sphere::Y] + i) },
+            { zero, zero, r, Ops::load(in[sphere::Z] + i) },
+            { zero, zero, zero, one }
+        };
+
+        Ops::store(m, out + i);
+    }
+
+    return i;
+}
+
+template<typename Ops>
+size_t obbs_simd(const ObbColumns& in, size_t begin, size_t end, InstanceData* out) {
+    using V = typename Ops::V;
+
+    size_t i = begin;
+    for (; i + Ops::WIDTH <= end; i += Ops::WIDTH) {
+        const V extent[3] = {
+            Ops::load(in[obb::ExtentX] + i),
+            Ops::load(in[obb::ExtentY] + i),
+            Ops::load(in[obb::ExtentZ] + i)
+        };
+
+        V m[4][4];
+        for (size_t row = 0; row < 4; ++row) {
+            for (size_t col = 0; col < 4; ++col) {
+                const V coord = Ops::load(in[obb::Coord + col * 4 + row] + i);
+                m[row][col] = col < 3 ? Ops::mul(coord, extent[col]) : coord;
+            }
+        }
+
+        Ops::store(m, out + i);
+    }
+
+    return i;
+}
+
+template<typename Ops>
+size_t capsules_simd(const CapsuleColumns& in, size_t begin, size_t end, InstanceData* cylinders, InstanceData* tops, InstanceData* bottoms) {
+    using V = typename Ops::V;
+    const V zero = Ops::set(0.0f);
+    const V one = Ops::set(1.0f);
+    const V half = Ops::set(0.5f);
+
+    size_t i = begin;
+    for (; i + Ops::WIDTH <= end; i += Ops::WIDTH) {
+        const V a[3] = { Ops::load(in[capsule::P0X] + i), Ops::load(in[capsule::P0Y] + i), Ops::load(in[capsule::P0Z] + i) };
+        const V b[3] = { Ops::load(in[capsule::P1X] + i), Ops::load(in[capsule::P1Y] + i), Ops::load(in[capsule::P1Z] + i) };
+
+        // p0 is the lower end, p1 the upper one
+        const V swap = Ops::greater(a[1], b[1]);
+        V p0[3], p1[3], d[3];
+        for (size_t c = 0; c < 3; ++c) {
+            p0[c] = Ops::select(swap, b[c], a[c]);
+            p1[c] = Ops::select(swap, a[c], b[c]);
+            d[c] = Ops::sub(p1[c], p0[c]);
+        }
+
+        const V length = Ops::sqrt(Ops::add(Ops::add(Ops::mul(d[0], d[0]), Ops::mul(d[1], d[1])), Ops::mul(d[2], d[2])));
+        const V inv_length = Ops::select(Ops::greater(length, zero), Ops::div(one, length), zero);
+
+        const V x = Ops::mul(d[0], inv_length);
+        const V y = Ops::mul(d[1], inv_length);
+        const V z = Ops::mul(d[2], inv_length);
+        const V k = Ops::div(one, Ops::add(one, y));
+
+        const V kxz = Ops::mul(k, Ops::mul(x, z));
+        const V xx = Ops::mul(x, x);
+        const V zz = Ops::mul(z, z);
+        const V neg_x = Ops::sub(zero, x);
+        const V neg_z = Ops::sub(zero, z);
+
+        const V rotation[3][3] = {
+            { Ops::sub(one, Ops::mul(k, xx)), neg_x, Ops::sub(zero, kxz) },
+            { x, Ops::sub(one, Ops::mul(k, Ops::add(xx, zz))), z },
+            { Ops::sub(zero, kxz), neg_z, Ops::sub(one, Ops::mul(k, zz)) }
+        };
+
+        const V r = Ops::load(in[capsule::Radius] + i);
+        const V half_length = Ops::mul(length, half);
+        const V center[3] = {
+            Ops::mul(Ops::add(p0[0], p1[0]), half),
+            Ops::mul(Ops::add(p0[1], p1[1]), half),
+            Ops::mul(Ops::add(p0[2], p1[2]), half)
+        };
+
+        const auto write = [&](const V (&scale)[3], const V (&translation)[3], InstanceData* out) {
+            V m[4][4];
+            for (size_t row = 0; row < 3; ++row) {
+                for (size_t col = 0; col < 3; ++col) {
+                    m[row][col] = Ops::mul(rotation[col][row], scale[col]);
+                }
+
+                m[row][3] = translation[row];
+            }
+
+            m[3][0] = zero;
+            m[3][1] = zero;
+            m[3][2] = zero;
+            m[3][3] = one;
+
+            Ops::store(m, out + i);
+        };
+
+        const V scale_hemisphere[3] = { r, r, r };
+        const V scale_cylinder[3] = { r, half_length, r };
+
+        write(scale_cylinder, center, cylinders);
+        write(scale_hemisphere, p1, tops);
+        write(scale_hemisphere, p0, bottoms);
+    }
+
+    return i;
+}
+
+#endif
+
+template<typename TColumns>
+void copy_colors(const TColumns& in, size_t begin, size_t end, InstanceData* out) {
+    for (size_t i = begin; i < end; ++i) {
+        out[i].Color = in.Colors[i];
+    }
+}
+
+}
+
+Isa detect_isa() {
+#if SPL_INSTANCE_BUILDER_AVX && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+
+    // AVX needs OS support for saving the YMM registers as well
+    const bool os_saves_ymm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+    if ((info[2] & (1 << 28)) && os_saves_ymm) {
+        return Isa::Avx;
+    }
+
+    return Isa::Sse;
+#elif SPL_INSTANCE_BUILDER_AVX
+    return __builtin_cpu_supports("avx") ? Isa::Avx : Isa::Sse;
+#elif SPL_INSTANCE_BUILDER_SSE
+    return Isa::Sse;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+const char* get_isa_name(Isa isa) {
+    switch (isa) {
+    case Isa::Scalar: return "Scalar";
+    case Isa::Sse: return "SSE";
+    case Isa::Avx: return "AVX";
+    }
+
+    return "Unknown";
+}
+
+void build_spheres(const SphereColumns& in, size_t begin, size_t end, InstanceData* out, Isa isa) {
+    size_t done = begin;
+
+#if SPL_INSTANCE_BUILDER_AVX
+    if (isa == Isa::Avx) {
+        done = spheres_simd<AvxOps>(in, begin, end, out);
+    }
+#endif
+#if SPL_INSTANCE_BUILDER_SSE
+    if (isa == Isa::Sse) {
+        done = spheres_simd<SseOps>(in, begin, end, out);
+    }
+#endif
+
+    for (size_t i = done; i < end; ++i) {
+        sphere_scalar(in, i, out[i]);
+    }
+
+    copy_colors(in, begin, end, out);
+}
+
+void build_obbs(const ObbColumns& in, size_t begin, size_t end, InstanceData* out, Isa isa) {
+    size_t done = begin;
+
+#if SPL_INSTANCE_BUILDER_AVX
+    if (isa == Isa::Avx) {
+        done = obbs_simd<AvxOps>(in, begin, end, out);
+    }
+#endif
+#if SPL_INSTANCE_BUILDER_SSE
+    if (isa == Isa::Sse) {
+        done = obbs_simd<SseOps>(in, begin, end, out);
+    }
+#endif
+
+    for (size_t i = done; i < end; ++i) {
+        obb_scalar(in, i, out[i]);
+    }
+
+    copy_colors(in, begin, end, out);
+}
+
+void build_capsules(const CapsuleColumns& in, size_t begin, size_t end, InstanceData* cylinders, InstanceData* tops, InstanceData* bottoms, Isa isa) {
+    size_t done = begin;
+
+#if SPL_INSTANCE_BUILDER_AVX
+    if (isa == Isa::Avx) {
+        done = capsules_simd<AvxOps>(in, begin, end, cylinders, tops, bottoms);
+    }
+#endif
+#if SPL_INSTANCE_BUILDER_SSE
+    if (isa == Isa::Sse) {
+        done = capsules_simd<SseOps>(in, begin, end, cylinders, tops, bottoms);
+    }
+#endif
+
+    for (size_t i = done; i < end; ++i) {
+        capsule_scalar(in, i, cylinders[i], tops[i], bottoms[i]);
+    }
+
+    copy_colors(in, begin, end, cylinders);
+    copy_colors(in, begin, end, tops);
+    copy_colors(in, begin, end, bottoms);
+}
+
+void InstanceBuilder::resize(size_t spheres, size_t obbs, size_t capsules) {
+    m_spheres.resize(spheres);
+    m_obbs.resize(obbs);
+    m_capsules.resize(capsules);
+
+    m_sphere_instances.resize(spheres);
+    m_obb_instances.resize(obbs);
+    m_cylinder_instances.resize(capsules);
+    m_top_instances.resize(capsules);
+    m_bottom_instances.resize(capsules);
+}
+
+void InstanceBuilder::build_spheres(size_t begin, size_t end) {
+    instance_builder::build_spheres(m_spheres, begin, end, m_sphere_instances.data(), m_isa);
+}
+
+void InstanceBuilder::build_obbs(size_t begin, size_t end) {
+    instance_builder::build_obbs(m_obbs, begin, end, m_obb_instances.data(), m_isa);
+}
+
+void InstanceBuilder::build_capsules(size_t begin, size_t end) {
+    instance_builder::build_capsules(m_capsules, begin, end,
+        m_cylinder_instances.data(), m_top_instances.data(), m_bottom_instances.data(), m_isa);
+}
+
+void InstanceBuilder::build() {
+    resize(m_spheres.Count, m_obbs.Count, m_capsules.Count);
+
+    build_spheres(0, m_spheres.Count);
+    build_obbs(0, m_obbs.Count);
+    build_capsules(0, m_capsules.Count);
+}
+
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "MemoryStats.h"
+#include "SharpPluginLoader.h"
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <utility>
+
+// Builds the per-instance data (world matrix and color) the primitive renderer uploads.
+// Input is structure-of-arrays, the kernels compute 4 (SSE) or 8 (AVX) transforms at a time
+// into a CPU staging arena, which the renderer then copies into the mapped GPU buffers in one go.
+//
+// This has no dependency on Windows or D3D, the math matches what the renderer used to do
+// per primitive with DirectXMath (row vectors, matrices transposed for HLSL).
+namespace instance_builder {
+
+struct Rgba {
+    f32 R, G, B, A;
+};
+
+// Layout matches PrimitiveRenderingModule::Instance
+struct InstanceData {
+    f32 Transform[16]; // Transposed world matrix
+    Rgba Color;
+};
+static_assert(sizeof(InstanceData) == 80);
+
+enum class Isa : u32 {
+    Scalar,
+    Sse,
+    Avx
+};
+
+// The widest instruction set the CPU (and OS) supports that kernels were compiled for
+Isa detect_isa();
+const char* get_isa_name(Isa isa);
+
+// One array per column, all holding Count elements
+template<size_t N>
+struct Columns {
+    static constexpr size_t COLUMN_COUNT = N;
+
+    std::array<memory_stats::Vector<f32, memory_stats::Tag::Primitives>, N> Data;
+    memory_stats::Vector<Rgba, memory_stats::Tag::Primitives> Colors;
+    size_t Count = 0;
+
+    // Keeps the capacity, so the arena stops allocating once it has seen the largest frame
+    void resize(size_t count) {
+        for (auto& column : Data) {
+            column.resize(count);
+        }
+
+        Colors.resize(count);
+        Count = count;
+    }
+
+    // Removes the elements whose `keep` entry is 0, preserving the order of the rest. Returns the new count.
+    size_t compact(const u8* keep) {
+        size_t count = 0;
+        for (size_t i = 0; i < Count; ++i) {
+            if (!keep[i]) {
+                continue;
+            }
+
+            if (count != i) {
+                for (auto& column : Data) {
+                    column[count] = column[i];
+                }
+
+                Colors[count] = Colors[i];
+            }
+
+            ++count;
+        }
+
+        Count = count;
+        return count;
+    }
+
+    // Stable counting sort by `keys` (each below KeyCount), `scratch` receives the old storage.
+    // offsets[k] is where the elements with key k start, offsets[KeyCount] is Count.
+    template<size_t KeyCount>
+    void sort_by_key(const u8* keys, Columns& scratch, std::array<size_t, KeyCount + 1>& offsets) {
+        std::array<size_t, KeyCount> counts{};
+        for (size_t i = 0; i < Count; ++i) {
+            ++counts[keys[i]];
+        }
+
+        offsets[0] = 0;
+        for (size_t key = 0; key < KeyCount; ++key) {
+            offsets[key + 1] = offsets[key] + counts[key];
+        }
+
+        // Everything has the same key, nothing to move
+        for (const size_t count : counts) {
+            if (count == Count) {
+                return;
+            }
+        }
+
+        scratch.resize(Count);
+
+        auto next = offsets;
+        for (size_t i = 0; i < Count; ++i) {
+            const size_t to = next[keys[i]]++;
+            for (size_t column = 0; column < N; ++column) {
+                scratch.Data[column][to] = Data[column][i];
+            }
+
+            scratch.Colors[to] = Colors[i];
+        }
+
+        std::swap(Data, scratch.Data);
+        std::swap(Colors, scratch.Colors);
+    }
+
+    f32* operator[](size_t column) { return Data[column].data(); }
+    const f32* operator[](size_t column) const { return Data[column].data(); }
+};
+
+namespace sphere {
+enum Column : size_t { X, Y, Z, Radius, Count };
+}
+
+namespace obb {
+// Coord is the 4x4 row-major orientation and translation, one column per element
+enum Column : size_t { ExtentX, ExtentY, ExtentZ, Coord, Count = Coord + 16 };
+}
+
+namespace capsule {
+enum Column : size_t { P0X, P0Y, P0Z, P1X, P1Y, P1Z, Radius, Count };
+}
+
+using SphereColumns = Columns<sphere::Count>;
+using ObbColumns = Columns<obb::Count>;
+using CapsuleColumns = Columns<capsule::Count>;
+
+// Build the instances [begin, end) of `in` into the same indices of `out`.
+// Disjoint ranges can be built concurrently.
+void build_spheres(const SphereColumns& in, size_t begin, size_t end, InstanceData* out, Isa isa);
+void build_obbs(const ObbColumns& in, size_t begin, size_t end, InstanceData* out, Isa isa);
+// A capsule is drawn as a cylinder and two hemispheres, each gets its own instance
+void build_capsules(const CapsuleColumns& in, size_t begin, size_t end, InstanceData* cylinders, InstanceData* tops, InstanceData* bottoms, Isa isa);
+
+// The staging arena of a frame. Fill the columns, call build, then copy the instances to the GPU.
+// To build on several threads, resize first and then fill and build disjoint ranges per thread.
+class InstanceBuilder {
+public:
+    using InstanceArray = memory_stats::Vector<InstanceData, memory_stats::Tag::Primitives>;
+
+    explicit InstanceBuilder(Isa isa = detect_isa()) : m_isa(isa) {}
+
+    SphereColumns& spheres() { return m_spheres; }
+    ObbColumns& obbs() { return m_obbs; }
+    CapsuleColumns& capsules() { return m_capsules; }
+
+    // Sizes the columns and the instance arrays
+    void resize(size_t spheres, size_t obbs, size_t capsules);
+
+    void build_spheres(size_t begin, size_t end);
+    void build_obbs(size_t begin, size_t end);
+    void build_capsules(size_t begin, size_t end);
+
+    // Builds every instance on the calling thread
+    void build();
+
+    std::span<const InstanceData> sphere_instances() const { return { m_sphere_instances.data(), m_spheres.Count }; }
+    std::span<const InstanceData> obb_instances() const { return { m_obb_instances.data(), m_obbs.Count }; }
+    std::span<const InstanceData> cylinder_instances() const { return { m_cylinder_instances.data(), m_capsules.Count }; }
+    std::span<const InstanceData> top_instances() const { return { m_top_instances.data(), m_capsules.Count }; }
+    std::span<const InstanceData> bottom_instances() const { return { m_bottom_instances.data(), m_capsules.Count }; }
+
+    Isa isa() const { return m_isa; }
+
+private:
+    Isa m_isa;
+
+    SphereColumns m_spheres;
+    ObbColumns m_obbs;
+    CapsuleColumns m_capsules;
+
+    InstanceArray m_sphere_instances;
+    InstanceArray m_obb_instances;
+    InstanceArray m_cylinder_instances;
+    InstanceArray m_top_instances;
+    InstanceArray m_bottom_instances;
+};
+
+}
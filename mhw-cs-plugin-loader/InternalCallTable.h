@@ -0,0 +1,111 @@
+// <auto-generated>
+// Generated by generate_internal_calls.py from InternalCalls.json. Do not edit.
+// </auto-generated>
+#pragma once
+
+#include "SharpPluginLoader.h"
+
+#include <array>
+
+enum class InternalCallId : u32 {
+    QueueYesNoDialog = 0,
+    LoadChunk = 1,
+    RequestChunk = 2,
+    GetDefaultChunk = 3,
+    ChunkGetFile = 4,
+    ChunkGetFolder = 5,
+    FileGetContents = 6,
+    FileGetSize = 7,
+    BeginTimeline = 8,
+    EndTimeline = 9,
+    BeginTimelineGroup = 10,
+    EndTimelineGroup = 11,
+    TimelineTrack = 12,
+    Bitfield = 13,
+    NotificationSuccess = 14,
+    NotificationError = 15,
+    NotificationWarning = 16,
+    NotificationInfo = 17,
+    Notification = 18,
+    RenderNotifications = 19,
+    RenderSphere = 20,
+    RenderObb = 21,
+    RenderCapsule = 22,
+    RenderLine = 23,
+    LoadTexture = 24,
+    UnloadTexture = 25,
+    RegisterTexture = 26,
+    GetRepositoryAddress = 27,
+    GetGameRevision = 28,
+    GetLogStatistics = 29,
+    NotifySingletonsChanged = 30,
+    RecordTraceSpan = 31,
+    HookAddManagedSubscriber = 32,
+    HookRemoveManagedSubscriber = 33,
+    GetHookStatistics = 34,
+    ResetHookStatistics = 35,
+    RegisterHookCounter = 36,
+    RecordHookSample = 37,
+    GetFrameBudgetConfig = 38,
+    GetNativeCompanions = 39,
+    GetMemoryStatistics = 40,
+    UnregisterHookCounter = 41,
+
+    Count
+};
+
+namespace internal_calls {
+
+struct InternalCallInfo {
+    const char* Name;
+    u32 SignatureHash;
+};
+
+constexpr u32 TABLE_HASH = 0x9BA21F46;
+
+constexpr std::array<InternalCallInfo, (size_t)InternalCallId::Count> INTERNAL_CALLS = {{
+    { "QueueYesNoDialog", 0xC4B771E8 }, // v(8)
+    { "LoadChunk", 0xC4B771E8 }, // v(8)
+    { "RequestChunk", 0x6FC521C2 }, // 8(8)
+    { "GetDefaultChunk", 0xD48B0FFC }, // 8()
+    { "ChunkGetFile", 0x622ED0E4 }, // 8(88)
+    { "ChunkGetFolder", 0x622ED0E4 }, // 8(88)
+    { "FileGetContents", 0x6FC521C2 }, // 8(8)
+    { "FileGetSize", 0x6FC521C2 }, // 8(8)
+    { "BeginTimeline", 0x4924A55F }, // 1(8ff84)
+    { "EndTimeline", 0x55B3AEEE }, // v()
+    { "BeginTimelineGroup", 0xCEE6C98F }, // 1(88)
+    { "EndTimelineGroup", 0x55B3AEEE }, // v()
+    { "TimelineTrack", 0x8D3165EB }, // 1(8848)
+    { "Bitfield", 0xD725527F }, // 1(888)
+    { "NotificationSuccess", 0x9998F9E2 }, // v(84)
+    { "NotificationError", 0x9998F9E2 }, // v(84)
+    { "NotificationWarning", 0x9998F9E2 }, // v(84)
+    { "NotificationInfo", 0x9998F9E2 }, // v(84)
+    { "Notification", 0x13689F56 }, // v(4488)
+    { "RenderNotifications", 0x55B3AEEE }, // v()
+    { "RenderSphere", 0x71A34846 }, // v(88)
+    { "RenderObb", 0x71A34846 }, // v(88)
+    { "RenderCapsule", 0x71A34846 }, // v(88)
+    { "RenderLine", 0x71A34846 }, // v(88)
+    { "LoadTexture", 0xE0DCD08A }, // 8(888)
+    { "UnloadTexture", 0xC4B771E8 }, // v(8)
+    { "RegisterTexture", 0x6FC521C2 }, // 8(8)
+    { "GetRepositoryAddress", 0x6FC521C2 }, // 8(8)
+    { "GetGameRevision", 0xD48B0FFC }, // 8()
+    { "GetLogStatistics", 0xC4B771E8 }, // v(8)
+    { "NotifySingletonsChanged", 0x55B3AEEE }, // v()
+    { "RecordTraceSpan", 0xC7350B60 }, // v(888)
+    { "HookAddManagedSubscriber", 0xF269EE1F }, // 1(8)
+    { "HookRemoveManagedSubscriber", 0xC4B771E8 }, // v(8)
+    { "GetHookStatistics", 0x27CCA7CC }, // 4(84)
+    { "ResetHookStatistics", 0x55B3AEEE }, // v()
+    { "RegisterHookCounter", 0xD4CB9B06 }, // 4(8)
+    { "RecordHookSample", 0x4657E16A }, // v(48)
+    { "GetFrameBudgetConfig", 0xC4B771E8 }, // v(8)
+    { "GetNativeCompanions", 0x6FC521C2 }, // 8(8)
+    { "GetMemoryStatistics", 0x27CCA7CC }, // 4(84)
+    { "UnregisterHookCounter", 0x2CAD8844 }, // v(4)
+}};
+
+}
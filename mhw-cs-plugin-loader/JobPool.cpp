@@ -0,0 +1,102 @@
+#include "JobPool.h"
+
+#include <algorithm>
+
+JobPool::JobPool(size_t worker_count) {
+    m_workers.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        m_workers.emplace_back([this](std::stop_token stop) { worker_main(stop); });
+    }
+}
+
+JobPool::~JobPool() {
+    for (auto& worker : m_workers) {
+        worker.request_stop();
+    }
+
+    m_workers.clear();
+}
+
+size_t JobPool::default_worker_count() {
+    const size_t hardware_threads = std::thread::hardware_concurrency();
+    return std::clamp<size_t>(hardware_threads, 1, 8) - 1;
+}
+
+void JobPool::run(size_t count, size_t grain, ChunkFn fn, void* context) {
+    // A few chunks per thread, so threads that start late still get a share
+    const size_t max_chunks = thread_count() * 4;
+    const size_t target_chunk_count = (std::min)((count + grain - 1) / (std::max)(grain, (size_t)1), max_chunks);
+    const size_t chunk_size = (count + target_chunk_count - 1) / target_chunk_count;
+    // Rounding the size up can leave the last chunks empty (33 over 32 chunks is 17 chunks of 2), drop them
+    const size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+
+    Job job = {
+        .Fn = fn,
+        .Context = context,
+        .Count = count,
+        .ChunkSize = chunk_size,
+        .ChunkCount = chunk_count
+    };
+
+    {
+        std::scoped_lock lock(m_mutex);
+        m_job = job;
+        m_next_chunk.store(0, std::memory_order_relaxed);
+        ++m_generation;
+    }
+
+    m_work_cv.notify_all();
+
+    run_chunks(job);
+
+    // Every chunk has been claimed at this point, the ones still running belong to active workers
+    std::unique_lock lock(m_mutex);
+    m_done_cv.wait(lock, [this] { return m_active_workers == 0; });
+}
+
+void JobPool::run_chunks(const Job& job) {
+    while (true) {
+        const size_t chunk = m_next_chunk.fetch_add(1, std::memory_order_relaxed);
+        if (chunk >= job.ChunkCount) {
+            return;
+        }
+
+        const size_t begin = chunk * job.ChunkSize;
+        const size_t end = (std::min)(begin + job.ChunkSize, job.Count);
+        job.Fn(job.Context, begin, end);
+    }
+}
+
+void JobPool::worker_main(std::stop_token stop) {
+    u64 generation = 0;
+
+    while (true) {
+        Job job;
+
+        {
+            std::unique_lock lock(m_mutex);
+            if (!m_work_cv.wait(lock, stop, [&] { return m_generation != generation; })) {
+                return;
+            }
+
+            generation = m_generation;
+
+            // Woke up after the job was already finished by the other threads
+            if (m_next_chunk.load(std::memory_order_relaxed) >= m_job.ChunkCount) {
+                continue;
+            }
+
+            job = m_job;
+            ++m_active_workers;
+        }
+
+        run_chunks(job);
+
+        {
+            std::scoped_lock lock(m_mutex);
+            --m_active_workers;
+        }
+
+        m_done_cv.notify_one();
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "SharpPluginLoader.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// A small pool of persistent worker threads for splitting per-frame work into parallel jobs.
+// The calling thread takes part in the work, so a pool with no workers simply runs everything inline.
+//
+// Jobs only get an index range to work on, they are expected to write their results by index.
+// Which thread runs which range is not deterministic, the results of a job are.
+// Jobs are submitted from one thread at a time.
+class JobPool {
+public:
+    explicit JobPool(size_t worker_count = default_worker_count());
+    ~JobPool();
+
+    JobPool(const JobPool&) = delete;
+    JobPool& operator=(const JobPool&) = delete;
+
+    // One less than the number of hardware threads (the caller is the last one), capped at 7
+    static size_t default_worker_count();
+
+    // Number of threads a job is spread over, the calling thread included
+    size_t thread_count() const { return m_workers.size() + 1; }
+
+    // Splits [0, count) into chunks of at least `grain` elements and calls fn(begin, end) for each of them.
+    // Returns once every chunk is done. Counts up to `grain` are run inline without waking the workers.
+    // `fn` must not throw.
+    template<typename F>
+    void parallel_for(size_t count, size_t grain, F&& fn) {
+        if (count == 0) {
+            return;
+        }
+
+        if (m_workers.empty() || count <= grain) {
+            fn((size_t)0, count);
+            return;
+        }
+
+        run(count, grain, [](void* context, size_t begin, size_t end) {
+            (*static_cast<std::remove_reference_t<F>*>(context))(begin, end);
+        }, &fn);
+    }
+
+private:
+    using ChunkFn = void(*)(void* context, size_t begin, size_t end);
+
+    struct Job {
+        ChunkFn Fn = nullptr;
+        void* Context = nullptr;
+        size_t Count = 0;
+        size_t ChunkSize = 0;
+        size_t ChunkCount = 0;
+    };
+
+    void run(size_t count, size_t grain, ChunkFn fn, void* context);
+    void run_chunks(const Job& job);
+    void worker_main(std::stop_token stop);
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable_any m_work_cv;
+    std::condition_variable m_done_cv;
+
+    Job m_job;
+    u64 m_generation = 0;
+    std::atomic<size_t> m_next_chunk = 0;
+    size_t m_active_workers = 0;
+
+    // Declared last, so the workers are joined before anything they use is destroyed
+    std::vector<std::jthread> m_workers;
+};
@@ -0,0 +1,47 @@
+#include "LineBuilder.h"
+
+namespace line_builder {
+using namespace culling;
+
+namespace {
+
+u32 to_unorm8(f32 value) {
+    // Written so NaN fails both comparisons and ends up as 0
+    const f32 clamped = value > 0.0f ? (value < 1.0f ? value : 1.0f) : 0.0f;
+    return (u32)(clamped * 255.0f + 0.5f);
+}
+
+}
+
+u32 pack_color(const instance_builder::Rgba& color) {
+    return to_unorm8(color.R)
+        | to_unorm8(color.G) << 8
+        | to_unorm8(color.B) << 16
+        | to_unorm8(color.A) << 24;
+}
+
+void build_vertices(const LineColumns& in, size_t begin, size_t end, Vertex* out) {
+    for (size_t i = begin; i < end; ++i) {
+        out[i * 2] = {
+            .Position = { in[line::P0X][i], in[line::P0Y][i], in[line::P0Z][i], 1.0f },
+            .Color = in.Colors[i]
+        };
+        out[i * 2 + 1] = {
+            .Position = { in[line::P1X][i], in[line::P1Y][i], in[line::P1Z][i], 1.0f },
+            .Color = in.Colors[i]
+        };
+    }
+}
+
+void build_segments(const LineColumns& in, size_t begin, size_t end, Segment* out) {
+    for (size_t i = begin; i < end; ++i) {
+        out[i] = {
+            .P0 = { in[line::P0X][i], in[line::P0Y][i], in[line::P0Z][i] },
+            .Color = pack_color(in.Colors[i]),
+            .P1 = { in[line::P1X][i], in[line::P1Y][i], in[line::P1Z][i] },
+            .Padding = 0
+        };
+    }
+}
+
+}
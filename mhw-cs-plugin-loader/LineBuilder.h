@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Culling.h"
+#include "SharpPluginLoader.h"
+
+// Packs the gathered (and culled) line columns into what the two line paths upload:
+//   - a vertex pair per line for the geometry shader path, drawn as a line list and expanded
+//     into quads by LineRenderingGS
+//   - one Segment per line for the vertex pulling path, read from a structured buffer by
+//     LineRenderingPullVS, which builds the quad of segment i from the vertex ids of instance i
+//
+// Like the instance builder this has no dependency on Windows or D3D.
+namespace line_builder {
+
+// Layout matches the input layout of LineRenderingVS
+struct Vertex {
+    f32 Position[4];
+    instance_builder::Rgba Color;
+};
+static_assert(sizeof(Vertex) == 32);
+
+// Layout matches Segment in LineRenderingPullVS.hlsl, half the size of the two vertices it replaces
+struct Segment {
+    f32 P0[3];
+    u32 Color; // RGBA8 UNORM, R in the lowest byte
+    f32 P1[3];
+    u32 Padding;
+};
+static_assert(sizeof(Segment) == 32);
+
+// Every segment is drawn as one instance of a 4 vertex triangle strip
+constexpr u32 SEGMENT_VERTEX_COUNT = 4;
+
+// Clamps to [0, 1] and rounds to the nearest 8 bit value, NaN becomes 0
+u32 pack_color(const instance_builder::Rgba& color);
+
+// Build the lines [begin, end) of `in` into out[begin * 2, end * 2).
+// Disjoint ranges can be built concurrently.
+void build_vertices(const culling::LineColumns& in, size_t begin, size_t end, Vertex* out);
+// Build the lines [begin, end) of `in` into out[begin, end).
+// Disjoint ranges can be built concurrently.
+void build_segments(const culling::LineColumns& in, size_t begin, size_t end, Segment* out);
+
+}
@@ -3,6 +3,8 @@
 #include <filesystem>
 #include <fstream>
 
+#include <loader.h>
+
 #include "Config.h"
 
 namespace preloader
@@ -20,6 +22,11 @@ namespace preloader
                 {"ImGuiRenderingEnabled", c.ImGuiRenderingEnabled},
                 {"PrimitiveRenderingEnabled", c.PrimitiveRenderingEnabled},
                 {"MenuKey", c.MenuKey},
+                {"AsyncClrBootstrap", c.AsyncClrBootstrap},
+                {"BootTrace", c.BootTrace},
+                {"FrameBudgetMs", c.FrameBudgetMs},
+                {"FrameBudgetAction", c.FrameBudgetAction},
+                {"FrameBudgetStrikes", c.FrameBudgetStrikes},
             }}
         };
     }
@@ -36,6 +43,11 @@ namespace preloader
             spl.at("ImGuiRenderingEnabled").get_to(c.ImGuiRenderingEnabled);
             spl.at("PrimitiveRenderingEnabled").get_to(c.PrimitiveRenderingEnabled);
             c.MenuKey = spl.value("MenuKey", "F9");
+            c.AsyncClrBootstrap = spl.value("AsyncClrBootstrap", false);
+            c.BootTrace = spl.value("BootTrace", false);
+            c.FrameBudgetMs = spl.value("FrameBudgetMs", 4.0f);
+            c.FrameBudgetAction = spl.value("FrameBudgetAction", "Log");
+            c.FrameBudgetStrikes = spl.value("FrameBudgetStrikes", 120u);
         }
         else {
             c.ImGuiRenderingEnabled = true;
@@ -51,18 +63,20 @@ namespace preloader
 
     LoaderConfig::LoaderConfig()
     {
+        ConfigFile config;
+
         // Attempt to load file from disk
         if (std::filesystem::exists(config::SPL_LOADER_CONFIG_FILE))
         {
             std::ifstream file(config::SPL_LOADER_CONFIG_FILE);
             json data = json::parse(file);
-            this->config = data.get<ConfigFile>();
+            config = data.get<ConfigFile>();
             file.close();
         }
         else
         {
             // No existing config, create a default and save to disk.
-            this->config = ConfigFile
+            config = ConfigFile
             {
                 .LogFile = true,
                 .LogCmd = true,
@@ -75,9 +89,188 @@ namespace preloader
         // Make sure any new options are added to the config file
         std::ofstream outfile(config::SPL_LOADER_CONFIG_FILE);
         if (outfile.is_open()) {
-            json data = this->config;
+            json data = config;
             outfile << std::setw(4) << data << "\n";
             outfile.close();
         }
+
+        publish(make_snapshot(std::move(config)));
+    }
+
+    LoaderConfig::~LoaderConfig()
+    {
+        // Runs during process detach, joining here could deadlock on the loader lock
+        if (m_watcher.joinable()) {
+            m_watcher.detach();
+        }
+    }
+
+    std::unique_ptr<LoaderConfigSnapshot> LoaderConfig::make_snapshot(ConfigFile config)
+    {
+        auto snapshot = std::make_unique<LoaderConfigSnapshot>();
+        static_cast<ConfigFile&>(*snapshot) = std::move(config);
+
+        if (snapshot->LogLevel == "DEBUG") {
+            snapshot->ParsedLogLevel = ConsoleLogLevel::Debug;
+        } else if (snapshot->LogLevel == "INFO") {
+            snapshot->ParsedLogLevel = ConsoleLogLevel::Info;
+        } else if (snapshot->LogLevel == "WARNING") {
+            snapshot->ParsedLogLevel = ConsoleLogLevel::Warning;
+        } else if (snapshot->LogLevel == "ERROR") {
+            snapshot->ParsedLogLevel = ConsoleLogLevel::Error;
+        } else {
+            loader::LOG(loader::ERR) << "[SPL] Invalid log level: " << snapshot->LogLevel;
+            snapshot->ParsedLogLevel = ConsoleLogLevel::Error;
+        }
+
+        if (snapshot->FrameBudgetAction == "Disable") {
+            snapshot->ParsedFrameBudgetAction = FrameBudgetMode::Disable;
+        } else if (snapshot->FrameBudgetAction == "Log") {
+            snapshot->ParsedFrameBudgetAction = FrameBudgetMode::Log;
+        } else {
+            if (snapshot->FrameBudgetAction != "None") {
+                loader::LOG(loader::WARN) << "[SPL] Unknown FrameBudgetAction '" << snapshot->FrameBudgetAction
+                    << "', expected None, Log or Disable";
+            }
+
+            snapshot->ParsedFrameBudgetAction = FrameBudgetMode::None;
+        }
+
+        if (snapshot->FrameBudgetStrikes == 0) {
+            snapshot->FrameBudgetStrikes = 1;
+        }
+
+        return snapshot;
+    }
+
+    void LoaderConfig::publish(std::unique_ptr<LoaderConfigSnapshot> snapshot)
+    {
+        std::lock_guard lock(m_mutex);
+
+        s_current.store(snapshot.get(), std::memory_order_release);
+
+        if (m_current) {
+            m_retired.push_back(std::move(m_current));
+        }
+
+        m_current = std::move(snapshot);
+    }
+
+    bool LoaderConfig::reload()
+    {
+        ConfigFile config;
+
+        try {
+            std::ifstream file(config::SPL_LOADER_CONFIG_FILE);
+            if (!file) {
+                loader::LOG(loader::ERR) << "[SPL] Failed to open the loader config for reloading";
+                return false;
+            }
+
+            config = json::parse(file).get<ConfigFile>();
+        }
+        catch (const std::exception& e) {
+            loader::LOG(loader::ERR) << "[SPL] Failed to reload the loader config, keeping the current one: " << e.what();
+            return false;
+        }
+
+        const auto& current = snapshot();
+
+        // These were consumed during startup, changing them now would leave the loader half configured
+        if (config.LogFile != current.LogFile ||
+            config.EnablePluginLoader != current.EnablePluginLoader ||
+            config.ImGuiRenderingEnabled != current.ImGuiRenderingEnabled ||
+            config.AsyncClrBootstrap != current.AsyncClrBootstrap ||
+            config.BootTrace != current.BootTrace) {
+            loader::LOG(loader::WARN) << "[SPL] Some of the changed loader config options only take effect after a restart";
+        }
+
+        config.LogFile = current.LogFile;
+        config.EnablePluginLoader = current.EnablePluginLoader;
+        config.ImGuiRenderingEnabled = current.ImGuiRenderingEnabled;
+        config.AsyncClrBootstrap = current.AsyncClrBootstrap;
+        config.BootTrace = current.BootTrace;
+
+        publish(make_snapshot(std::move(config)));
+        loader::LOG(loader::INFO) << "[SPL] Reloaded the loader config";
+        return true;
+    }
+
+    void LoaderConfig::start_watching()
+    {
+        if (m_watcher.joinable()) {
+            return;
+        }
+
+        std::error_code ec;
+        m_last_write_time = std::filesystem::last_write_time(config::SPL_LOADER_CONFIG_FILE, ec);
+
+        m_stop_event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        m_watcher = std::jthread([this](std::stop_token stop) { watch(stop); });
+    }
+
+    void LoaderConfig::stop_watching()
+    {
+        if (m_watcher.joinable()) {
+            m_watcher.request_stop();
+            SetEvent(m_stop_event);
+            m_watcher.join();
+        }
+
+        if (m_stop_event) {
+            CloseHandle(m_stop_event);
+            m_stop_event = nullptr;
+        }
+    }
+
+    void LoaderConfig::watch(std::stop_token stop)
+    {
+        namespace fs = std::filesystem;
+
+        std::error_code ec;
+        const auto directory = fs::absolute(config::SPL_LOADER_CONFIG_FILE, ec).parent_path();
+
+        // The config lives in the game directory, so only watch the directory itself and filter by write time
+        const auto change = FindFirstChangeNotificationW(directory.c_str(), FALSE,
+            FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+        if (change == INVALID_HANDLE_VALUE) {
+            loader::LOG(loader::ERR) << "[SPL] Failed to watch the loader config (" << GetLastError() << ")";
+            return;
+        }
+
+        // Editors tend to write the file several times in a row, wait for it to settle
+        constexpr DWORD SETTLE_TIME = 250;
+
+        const HANDLE handles[] = { m_stop_event, change };
+        bool pending = false;
+
+        while (!stop.stop_requested()) {
+            const auto result = WaitForMultipleObjects(2, handles, FALSE, pending ? SETTLE_TIME : INFINITE);
+            if (result == WAIT_OBJECT_0) {
+                break;
+            }
+
+            if (result == WAIT_OBJECT_0 + 1) {
+                pending = true;
+                FindNextChangeNotification(change);
+                continue;
+            }
+
+            if (result != WAIT_TIMEOUT) {
+                break;
+            }
+
+            pending = false;
+
+            const auto write_time = fs::last_write_time(config::SPL_LOADER_CONFIG_FILE, ec);
+            if (ec || write_time == m_last_write_time) {
+                continue;
+            }
+
+            m_last_write_time = write_time;
+            reload();
+        }
+
+        FindCloseChangeNotification(change);
     }
-} // namespace preloader
\ No newline at end of file
+} // namespace preloader
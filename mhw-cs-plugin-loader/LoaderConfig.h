@@ -1,6 +1,15 @@
 #pragma once
 #include <nlohmann/json.hpp>
 
+#include <Windows.h>
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace preloader
 {
     struct ConfigFile {
@@ -13,31 +22,104 @@ namespace preloader
             bool ImGuiRenderingEnabled = true;
             bool PrimitiveRenderingEnabled = true;
             std::string MenuKey = "F9";
+            // Starts the CLR on a worker thread while the game's CRT initializes. OnPreMain then runs after the
+            // static initializers, right before WinMain, so plugins relying on the earlier timing need this off.
+            bool AsyncClrBootstrap = false;
+            bool BootTrace = false;
+            float FrameBudgetMs = 4.0f;
+            std::string FrameBudgetAction = "Log";
+            unsigned int FrameBudgetStrikes = 120;
         };
     };
     void to_json(nlohmann::json& j, const ConfigFile& c);
     void from_json(const nlohmann::json& j, ConfigFile& c);
 
+    enum class ConsoleLogLevel : unsigned char {
+        Debug,
+        Info,
+        Warning,
+        Error
+    };
+
+    // Values match SharpPluginLoader.Core.FrameBudgetAction
+    enum class FrameBudgetMode : unsigned int {
+        None,
+        Log,
+        Disable
+    };
 
+    // An immutable view of the config file. The string options that are read at runtime
+    // are parsed once when the snapshot is built, so readers never compare or copy strings.
+    struct LoaderConfigSnapshot : ConfigFile {
+        ConsoleLogLevel ParsedLogLevel = ConsoleLogLevel::Error;
+        FrameBudgetMode ParsedFrameBudgetAction = FrameBudgetMode::Log;
+    };
+
+    // The loader config is held as a snapshot behind an atomic pointer. Reading it is a single
+    // acquire load, a reload builds a new snapshot and swaps it in.
+    //
+    // Replaced snapshots are never freed. snapshot() is read from any thread (the logger, the frame
+    // budget, the render hooks) without announcing it, so there is no point at which an old snapshot
+    // is known to be unused. Reloads only happen when the file is edited by hand, so the retired
+    // snapshots stay a few hundred bytes. References returned by snapshot() stay valid until unload,
+    // but only reflect the config at the time they were read.
+    //
+    // Options that are only consulted during startup (logfile, enablePluginLoader, ImGuiRenderingEnabled,
+    // AsyncClrBootstrap, BootTrace) keep their startup values until the game is restarted.
     class LoaderConfig {
     private:
         LoaderConfig();
-        ~LoaderConfig() = default;
+        ~LoaderConfig();
 
-        ConfigFile config;
     public:
         LoaderConfig(const LoaderConfig&) = delete;
         LoaderConfig& operator = (const LoaderConfig&) = delete;
 
         static LoaderConfig& get();
 
-        inline bool get_log_file() const { return this->config.LogFile; }
-        inline bool get_log_cmd() const { return this->config.LogCmd; }
-        inline std::string get_log_level() const { return this->config.LogLevel; }
-        inline bool get_output_every_path() const { return this->config.OutputEveryPath; }
-        inline bool get_enable_plugin_loader() const { return this->config.EnablePluginLoader; }
-        inline bool get_imgui_rendering_enabled() const { return this->config.ImGuiRenderingEnabled; }
-        inline bool get_primitive_rendering_enabled() const { return this->config.PrimitiveRenderingEnabled; }
-        inline std::string get_menu_key() const { return this->config.MenuKey; }
+        static const LoaderConfigSnapshot& snapshot() {
+            const auto current = s_current.load(std::memory_order_acquire);
+            return current ? *current : *get().s_current.load(std::memory_order_acquire);
+        }
+
+        // Starts watching the config file for changes, changed files are reloaded on the watcher thread
+        void start_watching();
+        void stop_watching();
+
+        // Re-reads the config file and publishes a new snapshot. Returns false if the file could not be
+        // parsed, in which case the current snapshot stays in place.
+        bool reload();
+
+        inline bool get_log_file() const { return snapshot().LogFile; }
+        inline bool get_log_cmd() const { return snapshot().LogCmd; }
+        inline ConsoleLogLevel get_log_level() const { return snapshot().ParsedLogLevel; }
+        inline bool get_output_every_path() const { return snapshot().OutputEveryPath; }
+        inline bool get_enable_plugin_loader() const { return snapshot().EnablePluginLoader; }
+        inline bool get_imgui_rendering_enabled() const { return snapshot().ImGuiRenderingEnabled; }
+        inline bool get_primitive_rendering_enabled() const { return snapshot().PrimitiveRenderingEnabled; }
+        inline const std::string& get_menu_key() const { return snapshot().MenuKey; }
+        inline bool get_async_clr_bootstrap() const { return snapshot().AsyncClrBootstrap; }
+        inline bool get_boot_trace() const { return snapshot().BootTrace; }
+        inline float get_frame_budget_ms() const { return snapshot().FrameBudgetMs; }
+        inline FrameBudgetMode get_frame_budget_action() const { return snapshot().ParsedFrameBudgetAction; }
+        inline unsigned int get_frame_budget_strikes() const { return snapshot().FrameBudgetStrikes; }
+
+    private:
+        void publish(std::unique_ptr<LoaderConfigSnapshot> snapshot);
+        void watch(std::stop_token stop);
+
+        static std::unique_ptr<LoaderConfigSnapshot> make_snapshot(ConfigFile config);
+
+    private:
+        static inline std::atomic<const LoaderConfigSnapshot*> s_current = nullptr;
+
+        std::mutex m_mutex;
+        std::unique_ptr<const LoaderConfigSnapshot> m_current;
+        // Replaced snapshots, kept alive for readers that may still hold them
+        std::vector<std::unique_ptr<const LoaderConfigSnapshot>> m_retired;
+
+        std::jthread m_watcher;
+        HANDLE m_stop_event = nullptr;
+        std::filesystem::file_time_type m_last_write_time{};
     };
-} // namespace preloader
\ No newline at end of file
+} // namespace preloader
@@ -1,7 +1,10 @@
 #include "Log.h"
 #include "Config.h"
 #include "LoaderConfig.h"
+#include "MemoryStats.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <fstream>
 #include <nlohmann/json.hpp>
@@ -10,8 +13,11 @@ namespace debug::log::impl {
 static HANDLE s_console = nullptr;
 static std::ofstream s_file;
 
-static bool s_log_to_cmd = true;
-static loader::LogLevel s_console_log_level = loader::INFO;
+static std::atomic<u64> s_emitted = 0;
+static std::atomic<u64> s_deduplicated = 0;
+static std::atomic<u64> s_rate_limited = 0;
+static std::atomic<u64> s_summaries = 0;
+static std::atomic<u32> s_sites = 0;
 
 using OutputFunc = BOOL(WINAPI*)(HANDLE, const void*, DWORD, LPDWORD, LPVOID);
 
@@ -26,26 +32,19 @@ static loader::LogLevel to_loader_level(LogLevel level) {
     return loader::INFO;
 }
 
+static loader::LogLevel to_loader_level(preloader::ConsoleLogLevel level) {
+    switch (level) {
+    case preloader::ConsoleLogLevel::Debug: return loader::DEBUG;
+    case preloader::ConsoleLogLevel::Info: return loader::INFO;
+    case preloader::ConsoleLogLevel::Warning: return loader::WARN;
+    case preloader::ConsoleLogLevel::Error: return loader::ERR;
+    }
+
+    return loader::ERR;
+}
+
 static void log_raw(LogLevel level, const void* msg, size_t msg_length, const void* time_msg, size_t time_msg_length, OutputFunc write) {
     if (!s_console) {
-        auto& loader_config = preloader::LoaderConfig::get();
-
-        const auto log_level = loader_config.get_log_level();
-        s_log_to_cmd = loader_config.get_log_cmd();
-
-        if (log_level == "DEBUG") {
-            s_console_log_level = loader::DEBUG;
-        } else if (log_level == "INFO") {
-            s_console_log_level = loader::INFO;
-        } else if (log_level == "WARNING") {
-            s_console_log_level = loader::WARN;
-        } else if (log_level == "ERROR") {
-            s_console_log_level = loader::ERR;
-        } else {
-            loader::LOG(loader::ERR) << "[SPL] Invalid log level: " << log_level;
-            return;
-        }
-
         s_console = GetStdHandle(STD_OUTPUT_HANDLE);
         if (s_console == INVALID_HANDLE_VALUE) {
             loader::LOG(loader::ERR) << "[SPL] Failed to get console handle";
@@ -61,7 +60,9 @@ static void log_raw(LogLevel level, const void* msg, size_t msg_length, const vo
         }
     }
 
-    if (!s_log_to_cmd || to_loader_level(level) < s_console_log_level) {
+    // Read every time, the log level can change when the loader config is reloaded
+    const auto& loader_config = preloader::LoaderConfig::snapshot();
+    if (!loader_config.LogCmd || to_loader_level(level) < to_loader_level(loader_config.ParsedLogLevel)) {
         return;
     }
 
@@ -102,3 +103,101 @@ void debug::log::impl::log(LogLevel level, const std::wstring& msg) {
     const std::string time_utf8{ time.begin(), time.end() };
     impl::s_file << time_utf8 << msg_utf8 << '\n' << std::flush;
 }
+
+static i64 now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+// Expects site.Mutex to be held
+static void flush_summary(dlog::impl::RateLimitedSite& site, dlog::impl::LogLevel level, i64 now) {
+    site.LastSummary = now;
+
+    if (site.Repeated == 0 && site.Suppressed == 0) {
+        return;
+    }
+
+    dlog::impl::log(level, std::format(
+        "Previous message repeated {} times, {} more suppressed ({}:{})",
+        site.Repeated, site.Suppressed, site.File, site.Line
+    ));
+
+    site.Repeated = 0;
+    site.Suppressed = 0;
+    ++dlog::impl::s_summaries;
+}
+
+bool dlog::impl::try_acquire(RateLimitedSite& site) {
+    const auto now = now_ms();
+    std::lock_guard lock(site.Mutex);
+
+    if (site.LastRefill == 0) {
+        site.Tokens = RATE_LIMIT_BURST;
+        site.LastRefill = now;
+        site.LastSummary = now;
+        ++s_sites;
+    }
+
+    const auto elapsed = (double)(now - site.LastRefill) / 1000.0;
+    site.Tokens = std::min<double>(RATE_LIMIT_BURST, site.Tokens + elapsed * RATE_LIMIT_TOKENS_PER_SECOND);
+    site.LastRefill = now;
+
+    if (site.Tokens < 1.0) {
+        ++site.Suppressed;
+        ++s_rate_limited;
+        return false;
+    }
+
+    site.Tokens -= 1.0;
+    return true;
+}
+
+// Bytes a string has on the heap. Short strings live in the string itself and have none.
+static size_t heap_bytes(const std::string& str) {
+    static const size_t sso_capacity = std::string().capacity();
+    return str.capacity() > sso_capacity ? str.capacity() + 1 : 0;
+}
+
+void dlog::impl::log_limited(RateLimitedSite& site, LogLevel level, const std::string& msg) {
+    const auto now = now_ms();
+    std::lock_guard lock(site.Mutex);
+
+    if (msg == site.LastMessage) {
+        ++site.Repeated;
+        ++s_deduplicated;
+
+        if (now - site.LastSummary >= RATE_LIMIT_SUMMARY_INTERVAL_MS) {
+            flush_summary(site, level, now);
+        }
+
+        return;
+    }
+
+    flush_summary(site, level, now);
+
+    const auto previous_bytes = heap_bytes(site.LastMessage);
+    site.LastMessage = msg;
+
+    // Every rate limited call site keeps its last message around for deduplication
+    const auto bytes = heap_bytes(site.LastMessage);
+    if (bytes != previous_bytes) {
+        if (previous_bytes != 0) {
+            memory_stats::track_free(memory_stats::Tag::Logging, previous_bytes);
+        }
+        if (bytes != 0) {
+            memory_stats::track_alloc(memory_stats::Tag::Logging, bytes);
+        }
+    }
+
+    log(level, msg);
+    ++s_emitted;
+}
+
+void dlog::get_statistics(LogStatistics* stats) {
+    stats->Emitted = impl::s_emitted;
+    stats->Deduplicated = impl::s_deduplicated;
+    stats->RateLimited = impl::s_rate_limited;
+    stats->Summaries = impl::s_summaries;
+    stats->Sites = impl::s_sites;
+}
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "SharpPluginLoader.h"
+
 #include <loader.h>
 #include <format>
+#include <mutex>
 
 namespace debug::log {
 namespace impl {
@@ -16,8 +19,42 @@ enum LogLevel {
 void log(LogLevel level, const std::string& msg);
 void log(LogLevel level, const std::wstring& msg);
 
+// Per call site state for the rate limited log functions. One of these is created
+// as a function-local static by the DLOG_*_LIMITED macros below.
+struct RateLimitedSite {
+    const char* File;
+    int Line;
+
+    std::mutex Mutex{};
+    double Tokens = 0.0;
+    i64 LastRefill = 0;
+    i64 LastSummary = 0;
+    std::string LastMessage{};
+    u32 Repeated = 0; // Identical messages collapsed since the last emitted line
+    u32 Suppressed = 0; // Messages dropped by the token bucket since the last emitted line
+};
+
+bool try_acquire(RateLimitedSite& site);
+void log_limited(RateLimitedSite& site, LogLevel level, const std::string& msg);
+
 }
 
+// Token bucket parameters shared by all rate limited call sites.
+constexpr double RATE_LIMIT_BURST = 5.0;
+constexpr double RATE_LIMIT_TOKENS_PER_SECOND = 1.0;
+// How often a "repeated N times" summary is flushed while a message keeps repeating.
+constexpr i64 RATE_LIMIT_SUMMARY_INTERVAL_MS = 10'000;
+
+struct LogStatistics {
+    u64 Emitted;
+    u64 Deduplicated;
+    u64 RateLimited;
+    u64 Summaries;
+    u32 Sites;
+};
+
+void get_statistics(LogStatistics* stats);
+
 template<typename ...Args>
 void debug(const std::format_string<Args...>& fmt, Args... args) {
     impl::log(impl::LogLevel::Debug, std::vformat(fmt.get(), std::make_format_args(args...)));
@@ -58,6 +95,32 @@ void error(const std::wformat_string<Args...>& fmt, Args&&... args) {
     impl::log(impl::LogLevel::Error, std::vformat(fmt.get(), std::make_wformat_args(args...)));
 }
 
+// Rate limited variants. Formatting only happens when the call site's bucket has a token,
+// so a failure that repeats every frame costs a lock and a counter increment.
+template<typename ...Args>
+void warn_limited(impl::RateLimitedSite& site, const std::format_string<Args...>& fmt, Args&&... args) {
+    if (impl::try_acquire(site)) {
+        impl::log_limited(site, impl::LogLevel::Warn, std::vformat(fmt.get(), std::make_format_args(args...)));
+    }
+}
+
+template<typename ...Args>
+void error_limited(impl::RateLimitedSite& site, const std::format_string<Args...>& fmt, Args&&... args) {
+    if (impl::try_acquire(site)) {
+        impl::log_limited(site, impl::LogLevel::Error, std::vformat(fmt.get(), std::make_format_args(args...)));
+    }
+}
+
 }
 
 namespace dlog = debug::log;
+
+#define DLOG_WARN_LIMITED(...) do { \
+        static ::debug::log::impl::RateLimitedSite dlog_site_{ __FILE__, __LINE__ }; \
+        ::debug::log::warn_limited(dlog_site_, __VA_ARGS__); \
+    } while (0)
+
+#define DLOG_ERROR_LIMITED(...) do { \
+        static ::debug::log::impl::RateLimitedSite dlog_site_{ __FILE__, __LINE__ }; \
+        ::debug::log::error_limited(dlog_site_, __VA_ARGS__); \
+    } while (0)
@@ -0,0 +1,68 @@
+#include "MemoryStats.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+namespace memory_stats {
+namespace {
+
+struct TagCounters {
+    std::atomic<u64> Live;
+    std::atomic<u64> Peak;
+    std::atomic<u64> Allocations;
+    std::atomic<u64> Frees;
+    std::atomic<u64> Allocated;
+};
+
+constexpr std::array<const char*, (size_t)Tag::Count> TAG_NAMES = {
+    "Chunks",
+    "Textures",
+    "Meshes",
+    "Primitives",
+    "Logging",
+    "InternalCalls"
+};
+
+// Constant initialized, so memory can be tracked from other static initializers
+constinit std::array<TagCounters, (size_t)Tag::Count> s_counters{};
+
+}
+
+void track_alloc(Tag tag, size_t bytes) {
+    auto& counters = s_counters[(size_t)tag];
+
+    const u64 live = counters.Live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    counters.Allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.Allocated.fetch_add(bytes, std::memory_order_relaxed);
+
+    u64 peak = counters.Peak.load(std::memory_order_relaxed);
+    while (live > peak && !counters.Peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+}
+
+void track_free(Tag tag, size_t bytes) {
+    auto& counters = s_counters[(size_t)tag];
+
+    counters.Live.fetch_sub(bytes, std::memory_order_relaxed);
+    counters.Frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+u32 get_statistics(MemoryStatistics* stats, u32 capacity) {
+    const u32 count = (std::min)((u32)Tag::Count, capacity);
+
+    for (u32 i = 0; i < count; ++i) {
+        const auto& counters = s_counters[i];
+        stats[i] = {
+            .Tag = TAG_NAMES[i],
+            .LiveBytes = counters.Live.load(std::memory_order_relaxed),
+            .PeakBytes = counters.Peak.load(std::memory_order_relaxed),
+            .Allocations = counters.Allocations.load(std::memory_order_relaxed),
+            .Frees = counters.Frees.load(std::memory_order_relaxed),
+            .AllocatedBytes = counters.Allocated.load(std::memory_order_relaxed)
+        };
+    }
+
+    return count;
+}
+
+}
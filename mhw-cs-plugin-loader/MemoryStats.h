@@ -0,0 +1,106 @@
+#pragma once
+
+#include "SharpPluginLoader.h"
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Per-subsystem accounting of the memory SPL itself holds. Allocations are tagged with the
+// subsystem they belong to and counted into a set of global atomics, so accounting is cheap
+// enough to stay enabled. GPU resources are counted by their (estimated) size as well.
+namespace memory_stats {
+
+enum class Tag : u32 {
+    Chunks,        // Decompressed chunk payloads
+    Textures,      // Textures loaded through the TextureManager
+    Meshes,        // Primitive meshes and their vertex/index buffers
+    Primitives,    // Primitive instance data
+    Logging,       // Trace buffers and log messages
+    InternalCalls, // Internal call tables, native companions included
+    Count
+};
+
+// Mirrored by SharpPluginLoader.Core.MemoryStatistics
+struct MemoryStatistics {
+    const char* Tag;
+    u64 LiveBytes;
+    u64 PeakBytes;
+    u64 Allocations;    // Total number of allocations since startup
+    u64 Frees;
+    u64 AllocatedBytes; // Total number of bytes allocated since startup
+};
+
+void track_alloc(Tag tag, size_t bytes);
+void track_free(Tag tag, size_t bytes);
+
+// Fills `stats` with up to `capacity` tags. Returns the number of tags written.
+u32 get_statistics(MemoryStatistics* stats, u32 capacity);
+
+// Counts a block of memory under a tag for as long as the object lives.
+// Used for memory that is not allocated through an allocator, like GPU resources or fixed size arrays.
+class TrackedBytes {
+public:
+    TrackedBytes() = default;
+    TrackedBytes(Tag tag, size_t bytes) : m_tag(tag), m_bytes(bytes) { track_alloc(m_tag, m_bytes); }
+    ~TrackedBytes() { reset(); }
+
+    TrackedBytes(TrackedBytes&& other) noexcept
+        : m_tag(other.m_tag), m_bytes(std::exchange(other.m_bytes, 0)) {}
+
+    TrackedBytes& operator=(TrackedBytes&& other) noexcept {
+        if (this != &other) {
+            reset();
+            m_tag = other.m_tag;
+            m_bytes = std::exchange(other.m_bytes, 0);
+        }
+
+        return *this;
+    }
+
+    TrackedBytes(const TrackedBytes&) = delete;
+    TrackedBytes& operator=(const TrackedBytes&) = delete;
+
+    void reset() {
+        if (m_bytes != 0) {
+            track_free(m_tag, std::exchange(m_bytes, 0));
+        }
+    }
+
+    size_t size() const { return m_bytes; }
+
+private:
+    Tag m_tag = Tag::Count;
+    size_t m_bytes = 0;
+};
+
+// Standard allocator that counts its allocations under a tag
+template<typename T, Tag TTag>
+struct Allocator {
+    using value_type = T;
+
+    Allocator() noexcept = default;
+    template<typename U> Allocator(const Allocator<U, TTag>&) noexcept {}
+
+    template<typename U> struct rebind { using other = Allocator<U, TTag>; };
+
+    T* allocate(size_t count) {
+        const auto bytes = count * sizeof(T);
+        const auto ptr = static_cast<T*>(::operator new(bytes));
+        track_alloc(TTag, bytes);
+        return ptr;
+    }
+
+    void deallocate(T* ptr, size_t count) noexcept {
+        track_free(TTag, count * sizeof(T));
+        ::operator delete(ptr);
+    }
+
+    template<typename U> bool operator==(const Allocator<U, TTag>&) const noexcept { return true; }
+};
+
+template<typename T, Tag TTag>
+using Vector = std::vector<T, Allocator<T, TTag>>;
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "SharpPluginLoader.h"
+
+#include <cstring>
+#include <span>
+
+// Binary meshes written by cook_meshes.py. The vertex and index data are laid out exactly like the
+// GPU buffers they are uploaded to, so loading a mesh is a header check and two copies:
+//
+//   Header
+//   VertexCount positions, f32 x, y, z, w (w = 1)
+//   IndexCount u16 indices, a triangle list
+//
+// Everything is little endian.
+namespace mesh_format {
+
+constexpr u32 MAGIC = 0x4853454D; // "MESH"
+constexpr u32 VERSION = 1;
+
+struct Header {
+    u32 Magic;
+    u32 Version;
+    u32 VertexCount;
+    u32 IndexCount;
+};
+static_assert(sizeof(Header) == 16);
+
+constexpr size_t VERTEX_SIZE = sizeof(f32) * 4;
+constexpr size_t INDEX_SIZE = sizeof(u16);
+
+struct View {
+    const u8* Vertices = nullptr;
+    const u16* Indices = nullptr;
+    u32 VertexCount = 0;
+    u32 IndexCount = 0;
+};
+
+// Validates `data` and points `out` into it. Returns false if the blob is truncated or of another version.
+inline bool parse(std::span<const u8> data, View& out) {
+    Header header;
+    if (data.size() < sizeof header) {
+        return false;
+    }
+
+    std::memcpy(&header, data.data(), sizeof header);
+    if (header.Magic != MAGIC || header.Version != VERSION) {
+        return false;
+    }
+
+    const size_t vertex_bytes = header.VertexCount * VERTEX_SIZE;
+    const size_t index_bytes = header.IndexCount * INDEX_SIZE;
+    if (data.size() < sizeof header + vertex_bytes + index_bytes) {
+        return false;
+    }
+
+    out = {
+        .Vertices = data.data() + sizeof header,
+        .Indices = (const u16*)(data.data() + sizeof header + vertex_bytes),
+        .VertexCount = header.VertexCount,
+        .IndexCount = header.IndexCount
+    };
+    return true;
+}
+
+}
@@ -1,11 +1,39 @@
 #pragma once
 #include <any>
+#include <array>
 #include <memory>
+#include <type_traits>
 
 class CoreClr;
 
+// A compile-time list of module types. Used both for the framework's module registry
+// (where the index of a type is its slot) and for declaring module dependencies.
+template<class... Ts>
+struct ModuleList {
+    static constexpr size_t size = sizeof...(Ts);
+
+    template<class T>
+    static constexpr bool contains = (std::is_same_v<T, Ts> || ...);
+
+    template<class T> requires contains<T>
+    static consteval size_t index_of() {
+        constexpr std::array<bool, sizeof...(Ts)> matches = { std::is_same_v<T, Ts>... };
+        for (size_t i = 0; i < matches.size(); ++i) {
+            if (matches[i]) {
+                return i;
+            }
+        }
+
+        return size;
+    }
+};
+
 class NativeModule {
 public:
+    // Modules that must be initialized before (and shut down after) this one.
+    // Derived modules shadow this with their own list.
+    using Dependencies = ModuleList<>;
+
     virtual void initialize(CoreClr* coreclr) = 0;
     virtual void shutdown() = 0;
     virtual ~NativeModule() = default;
@@ -1,34 +1,107 @@
 #include "NativePluginFramework.h"
 
+#include "HookStats.h"
+#include "LoaderConfig.h"
 #include "Log.h"
+#include "MemoryStats.h"
 #include "ChunkModule.h"
 #include "CoreModule.h"
 #include "D3DModule.h"
 #include "GuiModule.h"
+#include "HookModule.h"
 #include "ImGuiModule.h"
+#include "PluginHostModule.h"
+#include "PluginWatcherModule.h"
+#include "PrimitiveRenderingModule.h"
+#include "SingletonModule.h"
 #include "PatternScan.h"
+#include "Trace.h"
+
+#include <format>
+#include <stdexcept>
 
 NativePluginFramework::NativePluginFramework(CoreClr* coreclr, AddressRepository* address_repository)
     : m_managed_functions(coreclr->get_managed_function_pointers()),
       m_address_repository(address_repository) {
 
     s_instance = this;
-    m_modules.push_back(std::make_shared<CoreModule>());
-    m_modules.push_back(std::make_shared<GuiModule>());
-    m_modules.push_back(std::make_shared<D3DModule>());
-    m_modules.push_back(std::make_shared<ChunkModule>());
-    m_modules.push_back(std::make_shared<ImGuiModule>());
-    m_modules.push_back(std::make_shared<PrimitiveRenderingModule>());
-
-    for (const auto& module : m_modules) {
-        module->initialize(coreclr);
+    register_module<SingletonModule>("SingletonModule");
+    register_module<CoreModule>("CoreModule");
+    register_module<HookModule>("HookModule");
+    register_module<GuiModule>("GuiModule");
+    register_module<D3DModule>("D3DModule");
+    register_module<ChunkModule>("ChunkModule");
+    register_module<ImGuiModule>("ImGuiModule");
+    register_module<PrimitiveRenderingModule>("PrimitiveRenderingModule");
+    register_module<PluginHostModule>("PluginHostModule");
+    register_module<PluginWatcherModule>("PluginWatcherModule");
+
+    resolve_initialization_order();
+
+    for (const auto slot : m_initialization_order) {
+        const auto span_name = std::format("{}::initialize", m_module_names[slot]);
+        TRACE_SCOPE(span_name);
+        m_modules[slot]->initialize(coreclr);
     }
 
     // TODO(andoryuuta): should this be a full "Module" instead?
-    coreclr->add_internal_call("GetRepositoryAddress", get_repository_address);
-    coreclr->add_internal_call("GetGameRevision", get_game_revision);
+    coreclr->add_internal_call<InternalCallId::GetRepositoryAddress>(get_repository_address);
+    coreclr->add_internal_call<InternalCallId::GetGameRevision>(get_game_revision);
+    coreclr->add_internal_call<InternalCallId::GetLogStatistics>(dlog::get_statistics);
+    coreclr->add_internal_call<InternalCallId::RecordTraceSpan>(trace::record_managed);
+    coreclr->add_internal_call<InternalCallId::GetHookStatistics>(hook_stats::get_statistics);
+    coreclr->add_internal_call<InternalCallId::ResetHookStatistics>(hook_stats::reset);
+    coreclr->add_internal_call<InternalCallId::RegisterHookCounter>(hook_stats::register_managed_counter);
+    coreclr->add_internal_call<InternalCallId::RecordHookSample>(hook_stats::record);
+    coreclr->add_internal_call<InternalCallId::UnregisterHookCounter>(hook_stats::unregister_counter);
+    coreclr->add_internal_call<InternalCallId::GetMemoryStatistics>(memory_stats::get_statistics);
     coreclr->upload_internal_calls();
     coreclr->initialize_core_assembly();
+
+    preloader::LoaderConfig::get().start_watching();
+}
+
+void NativePluginFramework::shutdown() {
+    preloader::LoaderConfig::get().stop_watching();
+
+    for (auto it = m_initialization_order.rbegin(); it != m_initialization_order.rend(); ++it) {
+        m_modules[*it]->shutdown();
+    }
+}
+
+void NativePluginFramework::resolve_initialization_order() {
+    enum class State { Unvisited, Visiting, Done };
+    std::array<State, NativeModules::size> states{};
+
+    // Depth-first topological sort, visiting slots in registry order
+    const auto visit = [&](auto& self, size_t slot) -> void {
+        if (states[slot] == State::Done) {
+            return;
+        }
+
+        if (states[slot] == State::Visiting) {
+            dlog::error("[NativePluginFramework] Circular module dependency involving {}", m_module_names[slot]);
+            throw std::runtime_error("Circular module dependency");
+        }
+
+        states[slot] = State::Visiting;
+        for (const auto dependency : m_dependencies[slot]) {
+            self(self, dependency);
+        }
+
+        states[slot] = State::Done;
+        m_initialization_order.push_back(slot);
+    };
+
+    m_initialization_order.clear();
+    for (size_t slot = 0; slot < NativeModules::size; ++slot) {
+        if (!m_modules[slot]) {
+            dlog::error("[NativePluginFramework] Module slot {} was not registered", slot);
+            throw std::runtime_error("Module not registered");
+        }
+
+        visit(visit, slot);
+    }
 }
 
 void NativePluginFramework::trigger_on_pre_main() {
@@ -4,11 +4,37 @@
 #include "NativeModule.h"
 #include "AddressRepository.h"
 
+#include <array>
 #include <vector>
 #include <concepts>
 #include <memory>
-#include <stdexcept>
 
+class CoreModule;
+class HookModule;
+class GuiModule;
+class D3DModule;
+class ChunkModule;
+class ImGuiModule;
+class PluginHostModule;
+class PluginWatcherModule;
+class PrimitiveRenderingModule;
+class SingletonModule;
+
+// Every native module has a fixed slot in the registry, given by its index in this list.
+// Initialization order is derived from each module's declared Dependencies, with this
+// order used as the tie-breaker.
+using NativeModules = ModuleList<
+    SingletonModule,
+    CoreModule,
+    HookModule,
+    GuiModule,
+    D3DModule,
+    ChunkModule,
+    ImGuiModule,
+    PrimitiveRenderingModule,
+    PluginHostModule,
+    PluginWatcherModule
+>;
 
 class NativePluginFramework {
 public:
@@ -16,19 +42,16 @@ public:
         return s_instance;
     }
 
-    template<class T> requires std::derived_from<T, NativeModule>
-    static std::shared_ptr<T> get_module() {
-        for (auto& module : get()->m_modules) {
-            if (auto instance = std::dynamic_pointer_cast<T>(module)) {
-                return instance;
-            }
-        }
-
-        throw std::runtime_error("Module not found");
+    template<class T> requires std::derived_from<T, NativeModule> && NativeModules::contains<T>
+    static T* get_module() {
+        return static_cast<T*>(s_instance->m_modules[NativeModules::index_of<T>()].get());
     }
 
     explicit NativePluginFramework(CoreClr* coreclr, AddressRepository* address_repository);
 
+    // Shuts down all modules in reverse initialization order. Called once the game's WinMain returns.
+    void shutdown();
+
     void trigger_on_pre_main();
     void trigger_on_win_main();
     void trigger_on_mh_main_ctor();
@@ -37,7 +60,27 @@ public:
     static const char* get_game_revision();
 
 private:
-    std::vector<std::shared_ptr<NativeModule>> m_modules;
+    template<class T> requires std::derived_from<T, NativeModule> && NativeModules::contains<T>
+    void register_module(const char* name) {
+        constexpr size_t slot = NativeModules::index_of<T>();
+        m_modules[slot] = std::make_unique<T>();
+        m_module_names[slot] = name;
+        m_dependencies[slot] = dependency_slots(typename T::Dependencies{});
+    }
+
+    template<class... Ts>
+    static std::vector<size_t> dependency_slots(ModuleList<Ts...>) {
+        static_assert((NativeModules::contains<Ts> && ...), "Module dependency is not a registered module");
+        return { NativeModules::index_of<Ts>()... };
+    }
+
+    void resolve_initialization_order();
+
+private:
+    std::array<std::unique_ptr<NativeModule>, NativeModules::size> m_modules;
+    std::array<std::vector<size_t>, NativeModules::size> m_dependencies;
+    std::array<const char*, NativeModules::size> m_module_names{};
+    std::vector<size_t> m_initialization_order;
     ManagedFunctionPointers m_managed_functions;
     const char* m_game_revision = nullptr;
     AddressRepository* m_address_repository = nullptr;
@@ -0,0 +1,332 @@
+#include "PluginHostModule.h"
+#include "CoreClr.h"
+#include "Config.h"
+#include "Log.h"
+#include "NativePluginFramework.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+// Same search path the managed side uses for native components
+constexpr DWORD COMPANION_LOAD_FLAGS = LOAD_LIBRARY_SEARCH_DLL_LOAD_DIR
+    | LOAD_LIBRARY_SEARCH_APPLICATION_DIR
+    | LOAD_LIBRARY_SEARCH_USER_DIRS
+    | LOAD_LIBRARY_SEARCH_SYSTEM32
+    | LOAD_LIBRARY_SEARCH_DEFAULT_DIRS;
+
+std::string to_lower(std::string str) {
+    std::ranges::transform(str, str.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+    return str;
+}
+
+bool ends_with_insensitive(const std::string& str, std::string_view suffix) {
+    return str.size() >= suffix.size() && to_lower(str.substr(str.size() - suffix.size())) == suffix;
+}
+
+// Reads the names of the DLLs a PE file imports, without loading it
+std::vector<std::string> read_imported_dlls(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<char> image{ std::istreambuf_iterator(file), std::istreambuf_iterator<char>() };
+
+    if (image.size() < sizeof(IMAGE_DOS_HEADER)) {
+        return {};
+    }
+
+    const auto dos = (const IMAGE_DOS_HEADER*)image.data();
+    if (dos->e_magic != IMAGE_DOS_SIGNATURE || dos->e_lfanew <= 0 ||
+        (size_t)dos->e_lfanew + sizeof(IMAGE_NT_HEADERS64) > image.size()) {
+        return {};
+    }
+
+    const auto nt = (const IMAGE_NT_HEADERS64*)(image.data() + dos->e_lfanew);
+    if (nt->Signature != IMAGE_NT_SIGNATURE || nt->OptionalHeader.Magic != IMAGE_NT_OPTIONAL_HDR64_MAGIC) {
+        return {};
+    }
+
+    const auto sections = IMAGE_FIRST_SECTION(nt);
+    const auto section_count = nt->FileHeader.NumberOfSections;
+    if ((const char*)(sections + section_count) > image.data() + image.size()) {
+        return {};
+    }
+
+    const auto rva_to_offset = [&](u32 rva) -> size_t {
+        for (u32 i = 0; i < section_count; ++i) {
+            const auto& section = sections[i];
+            const auto size = (std::max)(section.Misc.VirtualSize, section.SizeOfRawData);
+            if (rva >= section.VirtualAddress && rva < section.VirtualAddress + size) {
+                return rva - section.VirtualAddress + section.PointerToRawData;
+            }
+        }
+
+        return 0;
+    };
+
+    const auto& directory = nt->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IMPORT];
+    if (directory.VirtualAddress == 0) {
+        return {};
+    }
+
+    std::vector<std::string> imports;
+    for (size_t offset = rva_to_offset(directory.VirtualAddress);
+         offset != 0 && offset + sizeof(IMAGE_IMPORT_DESCRIPTOR) <= image.size();
+         offset += sizeof(IMAGE_IMPORT_DESCRIPTOR)) {
+
+        const auto descriptor = (const IMAGE_IMPORT_DESCRIPTOR*)(image.data() + offset);
+        if (descriptor->Name == 0) {
+            break;
+        }
+
+        const auto name_offset = rva_to_offset(descriptor->Name);
+        if (name_offset == 0 || name_offset >= image.size()) {
+            continue;
+        }
+
+        const auto name = image.data() + name_offset;
+        imports.emplace_back(name, strnlen(name, image.size() - name_offset));
+    }
+
+    return imports;
+}
+
+}
+
+void PluginHostModule::initialize(CoreClr* coreclr) {
+    coreclr->add_internal_call<InternalCallId::GetNativeCompanions>(get_native_companions);
+
+    m_loader = std::async(std::launch::async, [this] { load_companions(); });
+}
+
+void PluginHostModule::shutdown() {
+    if (m_loader.valid()) {
+        m_loader.wait();
+    }
+
+    // Companions that were handed to the managed side are freed by it
+    m_companions.clear();
+    m_internal_calls.clear();
+    m_entries.clear();
+}
+
+std::vector<PluginHostModule::Entry> PluginHostModule::find_companions() {
+    namespace fs = std::filesystem;
+
+    std::vector<Entry> entries;
+    std::error_code ec;
+
+    const auto options = fs::directory_options::follow_directory_symlink | fs::directory_options::skip_permission_denied;
+    for (auto it = fs::recursive_directory_iterator(config::SPL_PLUGIN_DIR, options, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        const auto& path = it->path();
+        const auto name = path.filename().string();
+
+        if (!it->is_regular_file(ec) || !ends_with_insensitive(name, ".dll") || ends_with_insensitive(name, ".native.dll")) {
+            continue;
+        }
+
+        if (path.parent_path().filename() == "Loader") {
+            continue;
+        }
+
+        // Symlinked plugins keep their companion next to the link target, same as on the managed side
+        auto companion = fs::canonical(path, ec);
+        if (ec) {
+            ec.clear();
+            continue;
+        }
+
+        companion.replace_extension(".Native.dll");
+        if (!fs::is_regular_file(companion, ec)) {
+            ec.clear();
+            continue;
+        }
+
+        const auto duplicate = std::ranges::any_of(entries, [&](const Entry& e) { return e.Path == companion; });
+        if (!duplicate) {
+            const auto utf8 = companion.u8string();
+            entries.push_back({ .Path = companion, .PathUtf8 = std::string((const char*)utf8.data(), utf8.size()) });
+        }
+    }
+
+    if (ec) {
+        dlog::error("[PluginHostModule] Failed to enumerate plugins: {}", ec.message());
+    }
+
+    return entries;
+}
+
+void PluginHostModule::resolve_dependencies(std::vector<Entry>& entries) {
+    std::unordered_multimap<std::string, size_t> by_name;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        by_name.emplace(to_lower(entries[i].Path.filename().string()), i);
+    }
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        for (const auto& import : read_imported_dlls(entries[i].Path)) {
+            const auto [begin, end] = by_name.equal_range(to_lower(import));
+            for (auto it = begin; it != end; ++it) {
+                if (it->second != i) {
+                    entries[it->second].Dependents.push_back(i);
+                    ++entries[i].PendingDependencies;
+                }
+            }
+        }
+    }
+
+    // Break cycles, the OS loader can deal with them, we just can't order them
+    std::vector<size_t> pending(entries.size());
+    std::vector<size_t> ready;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        pending[i] = entries[i].PendingDependencies;
+        if (pending[i] == 0) {
+            ready.push_back(i);
+        }
+    }
+
+    while (!ready.empty()) {
+        const auto i = ready.back();
+        ready.pop_back();
+
+        for (const auto dependent : entries[i].Dependents) {
+            if (--pending[dependent] == 0) {
+                ready.push_back(dependent);
+            }
+        }
+    }
+
+    // Whatever is left is in (or depends on) a cycle, drop the edges between those companions
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (pending[i] != 0) {
+            std::erase_if(entries[i].Dependents, [&](size_t dependent) { return pending[dependent] != 0; });
+        }
+    }
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (pending[i] != 0) {
+            dlog::warn("[PluginHostModule] {} is part of an import cycle, loading it without ordering", entries[i].PathUtf8);
+            entries[i].PendingDependencies -= pending[i];
+        }
+    }
+}
+
+void PluginHostModule::load_companion(Entry& entry) {
+    const auto span_name = std::format("Load {}", entry.Path.filename().string());
+    TRACE_SCOPE(span_name, "plugin");
+
+    const auto module = LoadLibraryExW(entry.Path.c_str(), nullptr, COMPANION_LOAD_FLAGS);
+    if (!module) {
+        dlog::error("[PluginHostModule] Failed to load {} ({})", entry.PathUtf8, GetLastError());
+        return;
+    }
+
+    const auto get_internal_call_count = (int(*)())GetProcAddress(module, "get_internal_call_count");
+    const auto collect_internal_calls = (void(*)(InternalCall*))GetProcAddress(module, "collect_internal_calls");
+
+    if (!get_internal_call_count || !collect_internal_calls) {
+        dlog::error("[PluginHostModule] {} does not export get_internal_call_count and collect_internal_calls", entry.PathUtf8);
+        FreeLibrary(module);
+        return;
+    }
+
+    entry.InternalCalls.resize((std::max)(get_internal_call_count(), 0));
+    collect_internal_calls(entry.InternalCalls.data());
+    entry.Module = module;
+}
+
+void PluginHostModule::load_companions() {
+    TRACE_SCOPE("PluginHostModule::load_companions");
+
+    m_entries = find_companions();
+    if (m_entries.empty()) {
+        return;
+    }
+
+    resolve_dependencies(m_entries);
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<size_t> ready;
+    size_t remaining = m_entries.size();
+
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        if (m_entries[i].PendingDependencies == 0) {
+            ready.push_back(i);
+        }
+    }
+
+    const auto worker_count = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, m_entries.size());
+    {
+        std::vector<std::jthread> workers;
+        for (size_t w = 0; w < worker_count; ++w) {
+            workers.emplace_back([&] {
+                std::unique_lock lock(mutex);
+
+                while (true) {
+                    cv.wait(lock, [&] { return !ready.empty() || remaining == 0; });
+                    if (ready.empty()) {
+                        return;
+                    }
+
+                    const auto i = ready.back();
+                    ready.pop_back();
+
+                    lock.unlock();
+                    load_companion(m_entries[i]);
+                    lock.lock();
+
+                    --remaining;
+                    for (const auto dependent : m_entries[i].Dependents) {
+                        if (--m_entries[dependent].PendingDependencies == 0) {
+                            ready.push_back(dependent);
+                        }
+                    }
+
+                    cv.notify_all();
+                }
+            });
+        }
+    }
+
+    // Merge everything into one table, nothing is resized after this so the pointers stay valid
+    size_t total = 0;
+    for (const auto& entry : m_entries) {
+        total += entry.InternalCalls.size();
+    }
+
+    m_internal_calls.reserve(total);
+    m_companions.reserve(m_entries.size());
+
+    for (const auto& entry : m_entries) {
+        const auto first = m_internal_calls.data() + m_internal_calls.size();
+        m_internal_calls.insert(m_internal_calls.end(), entry.InternalCalls.begin(), entry.InternalCalls.end());
+
+        m_companions.push_back({
+            .Path = entry.PathUtf8.c_str(),
+            .Module = entry.Module,
+            .InternalCalls = first,
+            .InternalCallCount = (u32)entry.InternalCalls.size()
+        });
+    }
+
+    dlog::debug("[PluginHostModule] Loaded {} native companions with {} internal calls on {} threads",
+        m_companions.size(), m_internal_calls.size(), worker_count);
+}
+
+const PluginHostModule::NativeCompanion* PluginHostModule::get_native_companions(u32* count) {
+    const auto self = NativePluginFramework::get_module<PluginHostModule>();
+    if (self->m_loader.valid()) {
+        self->m_loader.wait();
+    }
+
+    *count = (u32)self->m_companions.size();
+    return self->m_companions.data();
+}
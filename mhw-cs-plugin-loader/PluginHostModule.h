@@ -0,0 +1,67 @@
+#pragma once
+#include "MemoryStats.h"
+#include "NativeModule.h"
+#include "SharpPluginLoader.h"
+
+#include <Windows.h>
+
+#include <filesystem>
+#include <future>
+#include <string>
+#include <vector>
+
+class D3DModule;
+
+// Loads the native companions of plugins (Plugin.Native.dll next to Plugin.dll) before the
+// managed side gets to them. Companions are loaded on a pool of worker threads, a companion
+// that imports another companion is only loaded once the imported one is done. Their internal
+// calls are collected on the same workers and merged into a single table for the managed side.
+//
+// Loading starts in the background during framework initialization and runs concurrently
+// with the rest of the startup, the managed side waits for it when it loads the first plugin.
+class PluginHostModule final : public NativeModule {
+public:
+    // Loaded after D3DModule has added the loader directory to the DLL search path
+    using Dependencies = ModuleList<D3DModule>;
+
+    // Mirrored by SharpPluginLoader.Core.InternalCall
+    struct InternalCall {
+        const char* Name;
+        void* Function;
+    };
+
+    // Mirrored by SharpPluginLoader.Core.NativeCompanion
+    struct NativeCompanion {
+        const char* Path; // Absolute path, UTF-8
+        HMODULE Module; // Null if the companion failed to load
+        const InternalCall* InternalCalls;
+        u32 InternalCallCount;
+    };
+
+    void initialize(CoreClr* coreclr) override;
+    void shutdown() override;
+
+private:
+    struct Entry {
+        std::filesystem::path Path;
+        std::string PathUtf8;
+        HMODULE Module = nullptr;
+        std::vector<InternalCall> InternalCalls;
+        // Indices of the companions that import this one
+        std::vector<size_t> Dependents;
+        size_t PendingDependencies = 0;
+    };
+
+    static std::vector<Entry> find_companions();
+    static void resolve_dependencies(std::vector<Entry>& entries);
+    static void load_companion(Entry& entry);
+    void load_companions();
+
+    static const NativeCompanion* get_native_companions(u32* count);
+
+private:
+    std::future<void> m_loader;
+    std::vector<Entry> m_entries;
+    memory_stats::Vector<InternalCall, memory_stats::Tag::InternalCalls> m_internal_calls;
+    memory_stats::Vector<NativeCompanion, memory_stats::Tag::InternalCalls> m_companions;
+};
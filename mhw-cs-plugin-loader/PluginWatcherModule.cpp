@@ -0,0 +1,313 @@
+#include "PluginWatcherModule.h"
+#include "CoreClr.h"
+#include "Config.h"
+#include "Log.h"
+#include "NativePluginFramework.h"
+
+#include <algorithm>
+#include <cwctype>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool is_plugin_file(const fs::path& path) {
+    auto extension = path.extension().wstring();
+    std::ranges::transform(extension, extension.begin(), [](wchar_t c) { return (wchar_t)std::towlower(c); });
+
+    return extension == L".dll" && path.parent_path().filename() != L"Loader";
+}
+
+// Compares whole path components, so "plugins2" is not inside "plugins"
+bool is_in_directory(const fs::path& path, const fs::path& directory) {
+    const auto relative = path.lexically_relative(directory);
+    return !relative.empty() && *relative.begin() != L"..";
+}
+
+}
+
+void PluginWatcherModule::initialize(CoreClr* coreclr) {
+    m_reload_plugin = coreclr->get_managed_function_pointers().ReloadPlugin;
+
+    std::error_code ec;
+    const auto root = fs::absolute(config::SPL_PLUGIN_DIR, ec);
+    if (ec || !fs::is_directory(root, ec)) {
+        dlog::warn("[PluginWatcherModule] Plugin directory does not exist, hot-reload is disabled");
+        return;
+    }
+
+    std::vector<fs::path> roots = { root };
+
+    // ReadDirectoryChangesW does not follow symlinks, so symlinked plugin directories are watched separately
+    for (auto it = fs::recursive_directory_iterator(root, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (it->is_symlink(ec) && fs::is_directory(it->path(), ec)) {
+            const auto target = fs::canonical(it->path(), ec);
+            if (!ec) {
+                roots.push_back(target);
+            }
+        }
+    }
+
+    for (const auto& path : roots) {
+        auto directory = std::make_unique<WatchedDirectory>();
+        directory->Path = path;
+        directory->Handle = CreateFileW(
+            path.c_str(),
+            FILE_LIST_DIRECTORY,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+            nullptr
+        );
+
+        if (directory->Handle == INVALID_HANDLE_VALUE) {
+            dlog::error("[PluginWatcherModule] Failed to open {} ({})", path.string(), GetLastError());
+            continue;
+        }
+
+        directory->Overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        m_directories.push_back(std::move(directory));
+    }
+
+    m_stop_event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    m_thread = std::jthread([this](std::stop_token stop) { run(stop); });
+}
+
+void PluginWatcherModule::shutdown() {
+    if (m_thread.joinable()) {
+        m_thread.request_stop();
+        SetEvent(m_stop_event);
+        m_thread.join();
+    }
+
+    for (const auto& directory : m_directories) {
+        CancelIoEx(directory->Handle, &directory->Overlapped);
+        CloseHandle(directory->Handle);
+        CloseHandle(directory->Overlapped.hEvent);
+    }
+
+    if (m_stop_event) {
+        CloseHandle(m_stop_event);
+        m_stop_event = nullptr;
+    }
+
+    m_directories.clear();
+    m_reload_plugin = nullptr;
+}
+
+void PluginWatcherModule::on_frame_boundary() {
+    const auto self = NativePluginFramework::get_module<PluginWatcherModule>();
+
+    std::vector<std::string> reloads;
+    {
+        std::lock_guard lock(self->m_reload_mutex);
+        if (self->m_reload_queue.empty() || !self->m_reload_plugin) {
+            return;
+        }
+
+        reloads.swap(self->m_reload_queue);
+    }
+
+    for (const auto& path : reloads) {
+        dlog::info("[PluginWatcherModule] Reloading {}", path);
+        self->m_reload_plugin(path.c_str());
+    }
+}
+
+void PluginWatcherModule::run(std::stop_token stop) {
+    // Hash everything up front, so the first change to a file can already be compared
+    for (const auto& directory : m_directories) {
+        std::error_code ec;
+        for (auto it = fs::recursive_directory_iterator(directory->Path, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            if (!it->is_regular_file(ec) || !is_plugin_file(it->path())) {
+                continue;
+            }
+
+            bool success;
+            const auto hash = hash_file(it->path(), success);
+            if (success) {
+                m_hashes[it->path().wstring()] = hash;
+            }
+        }
+    }
+
+    std::vector<HANDLE> handles = { m_stop_event };
+    for (const auto& directory : m_directories) {
+        if (begin_read(*directory)) {
+            handles.push_back(directory->Overlapped.hEvent);
+        }
+    }
+
+    dlog::debug("[PluginWatcherModule] Watching {} directories, {} plugin files", handles.size() - 1, m_hashes.size());
+
+    // Wake up regularly to process changes that have settled
+    constexpr DWORD POLL_INTERVAL = 100;
+
+    while (!stop.stop_requested()) {
+        const auto result = WaitForMultipleObjects((DWORD)handles.size(), handles.data(), FALSE, POLL_INTERVAL);
+        if (result == WAIT_OBJECT_0) {
+            break;
+        }
+
+        if (result > WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + handles.size()) {
+            const auto event = handles[result - WAIT_OBJECT_0];
+            const auto it = std::ranges::find_if(m_directories, [event](const auto& d) { return d->Overlapped.hEvent == event; });
+            auto& directory = **it;
+
+            DWORD bytes = 0;
+            if (GetOverlappedResult(directory.Handle, &directory.Overlapped, &bytes, FALSE)) {
+                if (bytes == 0) {
+                    rescan(directory);
+                } else {
+                    handle_notifications(directory);
+                }
+            }
+
+            begin_read(directory);
+        }
+
+        process_settled_changes();
+    }
+}
+
+bool PluginWatcherModule::begin_read(WatchedDirectory& directory) {
+    const auto success = ReadDirectoryChangesW(
+        directory.Handle,
+        directory.Buffer.data(),
+        (DWORD)directory.Buffer.size(),
+        TRUE,
+        FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE,
+        nullptr,
+        &directory.Overlapped,
+        nullptr
+    );
+
+    if (!success) {
+        dlog::error("[PluginWatcherModule] Failed to watch {} ({})", directory.Path.string(), GetLastError());
+    }
+
+    return success;
+}
+
+void PluginWatcherModule::handle_notifications(const WatchedDirectory& directory) {
+    const auto now = Clock::now();
+    auto offset = 0u;
+
+    while (true) {
+        const auto info = (const FILE_NOTIFY_INFORMATION*)(directory.Buffer.data() + offset);
+        const auto path = directory.Path / std::wstring_view(info->FileName, info->FileNameLength / sizeof(wchar_t));
+
+        if (is_plugin_file(path)) {
+            // Every event restarts the debounce timer, builds usually write a file several times
+            m_pending_changes[path.wstring()] = now;
+        }
+
+        if (info->NextEntryOffset == 0) {
+            break;
+        }
+
+        offset += info->NextEntryOffset;
+    }
+}
+
+void PluginWatcherModule::rescan(const WatchedDirectory& directory) {
+    const auto now = Clock::now();
+
+    // Known files may have been deleted
+    for (const auto& [path, _] : m_hashes) {
+        if (is_in_directory(path, directory.Path)) {
+            m_pending_changes[path] = now;
+        }
+    }
+
+    // And new ones added, copying in a batch of plugins is what overflows the buffer in the first place
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(directory.Path, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (it->is_regular_file(ec) && is_plugin_file(it->path())) {
+            m_pending_changes[it->path().wstring()] = now;
+        }
+    }
+}
+
+void PluginWatcherModule::process_settled_changes() {
+    const auto now = Clock::now();
+
+    for (auto it = m_pending_changes.begin(); it != m_pending_changes.end();) {
+        if (now - it->second < DEBOUNCE_TIME) {
+            ++it;
+            continue;
+        }
+
+        const fs::path path = it->first;
+        std::string reload;
+
+        std::error_code ec;
+        if (!fs::exists(path, ec)) {
+            // Deleted, reloading a plugin that no longer exists unloads it
+            if (m_hashes.erase(it->first)) {
+                reload = get_plugin_path(path).string();
+            }
+        } else {
+            bool success;
+            const auto hash = hash_file(path, success);
+            if (!success) {
+                // Most likely still being written to, try again later
+                it->second = now;
+                ++it;
+                continue;
+            }
+
+            const auto known = m_hashes.find(it->first);
+            if (known == m_hashes.end() || known->second != hash) {
+                m_hashes[it->first] = hash;
+                reload = get_plugin_path(path).string();
+            } else {
+                dlog::debug("[PluginWatcherModule] {} was touched but did not change", path.string());
+            }
+        }
+
+        if (!reload.empty()) {
+            std::lock_guard lock(m_reload_mutex);
+            if (std::ranges::find(m_reload_queue, reload) == m_reload_queue.end()) {
+                m_reload_queue.push_back(std::move(reload));
+            }
+        }
+
+        it = m_pending_changes.erase(it);
+    }
+}
+
+u64 PluginWatcherModule::hash_file(const fs::path& path, bool& success) {
+    success = false;
+
+    // No write sharing, so this fails while the file is still being written
+    const auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+
+    // FNV-1a, this only needs to tell apart versions of the same file
+    u64 hash = 0xCBF29CE484222325ull;
+    std::array<u8, 64 * 1024> buffer;
+    DWORD read = 0;
+
+    while ((success = ReadFile(file, buffer.data(), (DWORD)buffer.size(), &read, nullptr)) && read != 0) {
+        for (DWORD i = 0; i < read; ++i) {
+            hash = (hash ^ buffer[i]) * 0x100000001B3ull;
+        }
+    }
+
+    CloseHandle(file);
+    return hash;
+}
+
+fs::path PluginWatcherModule::get_plugin_path(const fs::path& path) {
+    // A changed native companion reloads the plugin it belongs to
+    const auto stem = path.stem();
+    if (stem.extension() == L".Native") {
+        return path.parent_path() / stem.stem().concat(L".dll");
+    }
+
+    return path;
+}
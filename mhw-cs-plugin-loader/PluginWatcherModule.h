@@ -0,0 +1,68 @@
+#pragma once
+#include "NativeModule.h"
+#include "SharpPluginLoader.h"
+
+#include <Windows.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Watches the plugin directory (and the targets of symlinked plugin directories) for changed
+// plugin assemblies. Changes are debounced and then compared by content hash, so only plugins
+// whose bytes actually changed are reloaded, one at a time.
+//
+// Reloads are not performed on the watcher thread. They are queued and run by on_frame_boundary,
+// which the present hook calls before any render callbacks (or the main update if rendering is disabled).
+class PluginWatcherModule final : public NativeModule {
+public:
+    // How long a file must stay untouched before it is considered for a reload
+    static constexpr auto DEBOUNCE_TIME = std::chrono::milliseconds(500);
+
+    void initialize(CoreClr* coreclr) override;
+    void shutdown() override;
+
+    // Runs the reloads that were queued since the last frame
+    static void on_frame_boundary();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct WatchedDirectory {
+        std::filesystem::path Path;
+        HANDLE Handle = INVALID_HANDLE_VALUE;
+        OVERLAPPED Overlapped{};
+        alignas(DWORD) std::array<std::byte, 16 * 1024> Buffer{};
+    };
+
+    void run(std::stop_token stop);
+    bool begin_read(WatchedDirectory& directory);
+    void handle_notifications(const WatchedDirectory& directory);
+    // Queues every plugin file in the directory for a recheck, for when change notifications were lost
+    void rescan(const WatchedDirectory& directory);
+    void process_settled_changes();
+
+    static u64 hash_file(const std::filesystem::path& path, bool& success);
+    static std::filesystem::path get_plugin_path(const std::filesystem::path& path);
+
+private:
+    void(*m_reload_plugin)(const char*) = nullptr;
+
+    std::jthread m_thread;
+    HANDLE m_stop_event = nullptr;
+    std::vector<std::unique_ptr<WatchedDirectory>> m_directories;
+
+    // Only accessed by the watcher thread
+    std::unordered_map<std::wstring, Clock::time_point> m_pending_changes;
+    std::unordered_map<std::wstring, u64> m_hashes;
+
+    std::mutex m_reload_mutex;
+    std::vector<std::string> m_reload_queue;
+};
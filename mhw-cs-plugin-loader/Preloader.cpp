@@ -1,4 +1,6 @@
+#include <chrono>
 #include <cstdint>
+#include <future>
 #include <string>
 #include <thread>
 
@@ -12,10 +14,13 @@
 #include "AddressRepository.h"
 #include "NativePluginFramework.h"
 #include "CoreClr.h"
+#include "Config.h"
+#include "HookTransaction.h"
 #include "Log.h"
 #include "Preloader.h"
 #include "PatternScan.h"
 #include "LoaderConfig.h"
+#include "Trace.h"
 
 #pragma intrinsic(_ReturnAddress)
 
@@ -28,6 +33,10 @@ CoreClr* s_coreclr = nullptr;
 NativePluginFramework* s_framework = nullptr;
 AddressRepository* s_address_repository = nullptr;
 
+// Only valid when the CLR is bootstrapped asynchronously (SPL.AsyncClrBootstrap)
+std::future<CoreClr*> s_coreclr_future{};
+std::chrono::steady_clock::duration s_coreclr_bootstrap_time{};
+
 // The default value that MSVC uses for the IMAGE_LOAD_CONFIG_DIRECTORY64.SecurityCookie.
 const uint64_t MSVC_DEFAULT_SECURITY_COOKIE_VALUE = 0x2B992DDFA232L;
 
@@ -61,27 +70,103 @@ uint64_t* get_security_cookie_pointer() {
     return nullptr;
 }
 
-// This hooks the __scrt_common_main_seh MSVC function.
-// This runs before all of the CRT initalization, static initalizers, and WinMain.
-__declspec(noinline) int64_t hooked_scrt_common_main() {
+// Starts constructing the CLR on a worker thread, so that hostfxr initialization and
+// the bootstrapper/core assembly loads overlap with the game's CRT initialization.
+void start_async_clr_bootstrap() {
+    dlog::info("[Preloader] Bootstrapping CLR on a worker thread");
+    s_coreclr_future = std::async(std::launch::async, [] {
+        TRACE_SCOPE("CoreClr (async)");
+        const auto start = std::chrono::steady_clock::now();
+        const auto coreclr = new CoreClr();
+        s_coreclr_bootstrap_time = std::chrono::steady_clock::now() - start;
+        return coreclr;
+    });
+}
+
+// Creates the NativePluginFramework. If the CLR is being bootstrapped asynchronously,
+// this is the point where the main thread waits for it.
+void initialize_framework() {
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+
+    TRACE_SCOPE("initialize_framework");
     dlog::info("[Preloader] Initializing CLR / NativePluginFramework");
-    s_coreclr = new CoreClr();
+    if (s_coreclr_future.valid()) {
+        TRACE_SCOPE("Wait for CoreClr");
+        const auto wait_start = std::chrono::steady_clock::now();
+        s_coreclr = s_coreclr_future.get();
+        const auto wait_time = std::chrono::steady_clock::now() - wait_start;
+
+        dlog::info(
+            "[Preloader] CLR bootstrap took {}ms, main thread waited {}ms ({}ms overlapped with game startup)",
+            duration_cast<milliseconds>(s_coreclr_bootstrap_time).count(),
+            duration_cast<milliseconds>(wait_time).count(),
+            duration_cast<milliseconds>(s_coreclr_bootstrap_time - (std::min)(wait_time, s_coreclr_bootstrap_time)).count()
+        );
+    } else {
+        TRACE_SCOPE("CoreClr");
+        const auto start = std::chrono::steady_clock::now();
+        s_coreclr = new CoreClr();
+        s_coreclr_bootstrap_time = std::chrono::steady_clock::now() - start;
+
+        dlog::info(
+            "[Preloader] CLR bootstrap took {}ms",
+            duration_cast<milliseconds>(s_coreclr_bootstrap_time).count()
+        );
+    }
+
     s_framework = new NativePluginFramework(s_coreclr, s_address_repository);
     dlog::info("[Preloader] Initialized");
+}
 
-    s_framework->trigger_on_pre_main();
+// This hooks the __scrt_common_main_seh MSVC function.
+// This runs before all of the CRT initalization, static initalizers, and WinMain.
+__declspec(noinline) int64_t hooked_scrt_common_main() {
+    // With an asynchronous bootstrap the CRT initialization runs in parallel with the CLR
+    // startup, and the framework is created (and OnPreMain triggered) right before WinMain.
+    if (!s_coreclr_future.valid()) {
+        initialize_framework();
+
+        TRACE_SCOPE("trigger_on_pre_main");
+        s_framework->trigger_on_pre_main();
+    }
 
     return g_scrt_common_main_hook.call<int64_t>();
 }
 
 __declspec(noinline) int __stdcall hooked_win_main(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nShowCmd) {
-    s_framework->trigger_on_win_main();
-    return g_win_main_hook.call<int>(hInstance, hPrevInstance, lpCmdLine, nShowCmd);
+    if (!s_framework) {
+        initialize_framework();
+
+        TRACE_SCOPE("trigger_on_pre_main");
+        s_framework->trigger_on_pre_main();
+    }
+
+    {
+        TRACE_SCOPE("trigger_on_win_main");
+        s_framework->trigger_on_win_main();
+    }
+
+    const auto result = g_win_main_hook.call<int>(hInstance, hPrevInstance, lpCmdLine, nShowCmd);
+
+    // The game is exiting. This is the last point on the main thread outside of the loader lock,
+    // DllMain can't join the module threads or wait on the GPU.
+    dlog::info("[Preloader] WinMain returned, shutting down");
+    s_framework->shutdown();
+
+    return result;
 }
 
 __declspec(noinline) void* hooked_mh_main_ctor(void* this_ptr) {
     auto result = g_mh_main_ctor_hook.call<void*>(this_ptr);
-    s_framework->trigger_on_mh_main_ctor();
+
+    {
+        TRACE_SCOPE("trigger_on_mh_main_ctor");
+        s_framework->trigger_on_mh_main_ctor();
+    }
+
+    // sMhMain is constructed, boot is complete.
+    trace::finish(config::SPL_BOOT_TRACE_PATH);
     return result;
 }
 
@@ -127,6 +212,46 @@ uintptr_t resolve_x86_relative_call(uintptr_t call_address) {
     return (call_address + 5) + *(int32_t*)(call_address + 1);
 }
 
+// Resolves the core/main functions and hooks them. Returns false if any of them could not be
+// found or hooked, in which case none of them are hooked.
+bool install_startup_hooks() {
+    // The game has been unpacked in memory (for steam DRM or possibly Enigma in the future),
+    // start scanning for the core/main functions we want to hook.
+    s_address_repository = new AddressRepository();
+    s_address_repository->initialize();
+
+    const auto scrt_common_main_address = s_address_repository->get("Core::ScrtCommonMain");
+    if (scrt_common_main_address == 0) {
+        dlog::error("[Preloader] Failed to find __scrt_common_main_seh address");
+        return false;
+    }
+    dlog::debug("[Preloader] Resolved address for __scrt_common_main_seh: 0x{:X}", scrt_common_main_address);
+
+    // We parse this one from the call to WinMain rather than searching for the WinMain code itself,
+    // since that has changed drastically in previous patches (e.g. when they removed anti-debug stuff).
+    const auto winmain_call_address = s_address_repository->get("Core::WinMainCall");
+    if (winmain_call_address == 0) {
+        dlog::error("[Preloader] Failed to find WinMain call address");
+        return false;
+    }
+    uintptr_t winmain_address = resolve_x86_relative_call(winmain_call_address);
+    dlog::debug("[Preloader] Resolved address for WinMain: 0x{:X}", winmain_address);
+
+    const auto mhmain_ctor_address = s_address_repository->get("Core::MhMainCtor");
+    if (mhmain_ctor_address == 0) {
+        dlog::error("[Preloader] Failed to find sMhMain::ctor address");
+        return false;
+    }
+    dlog::debug("[Preloader] Resolved address for sMhMain::ctor: 0x{:X}", mhmain_ctor_address);
+
+    // Hook the functions. These are installed together, either all of them or none.
+    HookTransaction transaction;
+    transaction.add(g_scrt_common_main_hook, scrt_common_main_address, hooked_scrt_common_main, "__scrt_common_main_seh");
+    transaction.add(g_win_main_hook, winmain_address, hooked_win_main, "WinMain");
+    transaction.add(g_mh_main_ctor_hook, mhmain_ctor_address, hooked_mh_main_ctor, "sMhMain::ctor");
+    return transaction.commit();
+}
+
 // The hooked GetSystemTimeAsFileTime function.
 // This function is called in many places, one of them being the
 // `__security_init_cookie` function that is used to setup the security token(s)
@@ -134,52 +259,18 @@ uintptr_t resolve_x86_relative_call(uintptr_t call_address) {
 void hooked_get_system_time_as_file_time(LPFILETIME lpSystemTimeAsFileTime) {
     uint64_t ret_address = (uint64_t)_ReturnAddress();
     if (is_main_game_security_init_cookie_call(ret_address)) {
-        // The game has been unpacked in memory (for steam DRM or possibly Enigma in the future),
-        // start scanning for the core/main functions we want to hook.
-        s_address_repository = new AddressRepository();
-        s_address_repository->initialize();
-
-        const auto scrt_common_main_address = s_address_repository->get("Core::ScrtCommonMain");
-        if (scrt_common_main_address == 0) {
-            dlog::error("[Preloader] Failed to find __scrt_common_main_seh address");
-            return;
-        }
-        dlog::debug("[Preloader] Resolved address for __scrt_common_main_seh: 0x{:X}", scrt_common_main_address);
-
-        // We parse this one from the call to WinMain rather than searching for the WinMain code itself,
-        // since that has changed drastically in previous patches (e.g. when they removed anti-debug stuff).
-        const auto winmain_call_address = s_address_repository->get("Core::WinMainCall");
-        if (winmain_call_address == 0) {
-            dlog::error("[Preloader] Failed to find WinMain call address");
-            return;
-        }
-        uintptr_t winmain_address = resolve_x86_relative_call(winmain_call_address);
-        dlog::debug("[Preloader] Resolved address for WinMain: 0x{:X}", winmain_address);
+        TRACE_SCOPE("hooked_get_system_time_as_file_time");
 
-        const auto mhmain_ctor_address = s_address_repository->get("Core::MhMainCtor");
-        if (mhmain_ctor_address == 0) {
-            dlog::error("[Preloader] Failed to find sMhMain::ctor address");
-            return;
+        if (install_startup_hooks()) {
+            if (preloader::LoaderConfig::get().get_async_clr_bootstrap()) {
+                start_async_clr_bootstrap();
+            }
+        } else {
+            dlog::error("[Preloader] Failed to install startup hooks, plugins will not be loaded");
         }
-        dlog::debug("[Preloader] Resolved address for sMhMain::ctor: 0x{:X}", mhmain_ctor_address);
-
-        // Hook the functions.
-        g_scrt_common_main_hook = safetyhook::create_inline(
-            reinterpret_cast<void*>(scrt_common_main_address),
-            reinterpret_cast<void*>(hooked_scrt_common_main)
-        );
 
-        g_win_main_hook = safetyhook::create_inline(
-            reinterpret_cast<void*>(winmain_address),
-            reinterpret_cast<void*>(hooked_win_main)
-        );
-
-        g_mh_main_ctor_hook = safetyhook::create_inline(
-            reinterpret_cast<void*>(mhmain_ctor_address),
-            reinterpret_cast<void*>(hooked_mh_main_ctor)
-        );
-
-        // Unhook this function and call the original
+        // Unhook this function and call the original. This has to happen even if the startup hooks failed,
+        // the caller is seeding the security cookie with the time and the game has to keep running.
         g_get_system_time_as_file_time_hook = {};
         GetSystemTimeAsFileTime(lpSystemTimeAsFileTime);
         return;
@@ -198,7 +289,11 @@ void hooked_get_system_time_as_file_time(LPFILETIME lpSystemTimeAsFileTime) {
 // binaries by detecting the first call to the hooked function _after_
 // the executable is unpacked in memory.
 void initialize_preloader() {
+    TRACE_SCOPE("initialize_preloader");
+
     auto& loader_config = preloader::LoaderConfig::get();
+    trace::set_enabled(loader_config.get_boot_trace());
+
     if (loader_config.get_log_cmd()) {
         open_console();
     }
@@ -0,0 +1,105 @@
+#include "PrimitiveBatcher.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+
+namespace primitive_batcher {
+
+namespace {
+
+// Stable LSD radix sort by MeshSlot, one byte per pass. A pass is skipped when all runs share that byte,
+// which with the current slot count makes it a single counting sort.
+template<typename T>
+void radix_sort(T& runs, T& scratch) {
+    scratch.resize(runs.size());
+
+    for (u32 shift = 0; shift < sizeof(u16) * 8; shift += 8) {
+        std::array<size_t, 256> counts{};
+        for (const auto& run : runs) {
+            ++counts[(run.MeshSlot >> shift) & 0xFF];
+        }
+
+        if (std::ranges::find(counts, runs.size()) != counts.end()) {
+            continue;
+        }
+
+        std::array<size_t, 256> next{};
+        for (size_t digit = 1; digit < next.size(); ++digit) {
+            next[digit] = next[digit - 1] + counts[digit - 1];
+        }
+
+        for (const auto& run : runs) {
+            scratch[next[(run.MeshSlot >> shift) & 0xFF]++] = run;
+        }
+
+        std::swap(runs, scratch);
+    }
+}
+
+}
+
+void Batcher::clear() {
+    m_runs.clear();
+    m_copies.clear();
+    m_draws.clear();
+    m_passes.clear();
+}
+
+void Batcher::add(MeshId mesh, size_t lod, std::span<const InstanceData> instances) {
+    if (instances.empty()) {
+        return;
+    }
+
+    m_runs.push_back({ get_mesh_slot(mesh, lod), instances.data(), instances.size() });
+}
+
+void Batcher::build(size_t max_pass_instances) {
+    m_copies.clear();
+    m_draws.clear();
+    m_passes.clear();
+
+    radix_sort(m_runs, m_scratch);
+
+    for (const auto& run : m_runs) {
+        for (size_t done = 0; done < run.Count;) {
+            if (m_passes.empty() || m_passes.back().InstanceCount == max_pass_instances) {
+                m_passes.push_back({
+                    .InstanceCount = 0,
+                    .FirstDraw = m_draws.size(),
+                    .DrawCount = 0,
+                    .FirstCopy = m_copies.size(),
+                    .CopyCount = 0
+                });
+            }
+
+            auto& pass = m_passes.back();
+            const size_t count = (std::min)(run.Count - done, max_pass_instances - pass.InstanceCount);
+
+            // Runs of the same slot are adjacent after sorting, they extend the draw of the previous one
+            if (pass.DrawCount != 0 && m_draws.back().MeshSlot == run.MeshSlot) {
+                m_draws.back().InstanceCount += (u32)count;
+            } else {
+                m_draws.push_back({ run.MeshSlot, (u32)pass.InstanceCount, (u32)count });
+                ++pass.DrawCount;
+            }
+
+            m_copies.push_back({ run.MeshSlot, run.Instances + done, count });
+            ++pass.CopyCount;
+
+            pass.InstanceCount += count;
+            done += count;
+        }
+    }
+}
+
+void Batcher::write_instances(const Pass& pass, InstanceData* out) const {
+    for (size_t i = pass.FirstCopy; i < pass.FirstCopy + pass.CopyCount; ++i) {
+        const auto& copy = m_copies[i];
+        std::memcpy(out, copy.Instances, copy.Count * sizeof(InstanceData));
+        out += copy.Count;
+    }
+}
+
+}
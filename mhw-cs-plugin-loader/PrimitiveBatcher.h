@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Culling.h"
+#include "InstanceBuilder.h"
+#include "MemoryStats.h"
+#include "SharpPluginLoader.h"
+
+#include <span>
+
+// Lays the built instances of every mesh primitive out as one instance stream and plans the draws
+// for it. All meshes share one vertex and index buffer (see MeshRange), so the renderer uploads the
+// stream once, binds its buffers once and then only issues draws: one per mesh and LOD that has
+// instances, or a single indirect call executing all of them.
+//
+// Like the instance builder this has no dependency on Windows or D3D.
+namespace primitive_batcher {
+
+enum class MeshId : u8 {
+    Sphere,
+    Cube,
+    HemisphereTop,
+    HemisphereBottom,
+    Cylinder,
+    Count
+};
+
+// Every mesh gets LOD_COUNT slots, whether it has that many levels or not.
+// Slots are ordered by mesh, then by LOD, which is the order the stream is sorted in.
+constexpr size_t MESH_SLOT_COUNT = (size_t)MeshId::Count * culling::LOD_COUNT;
+
+constexpr u16 get_mesh_slot(MeshId mesh, size_t lod) {
+    return (u16)((size_t)mesh * culling::LOD_COUNT + lod);
+}
+
+// Where the mesh of a slot is in the shared vertex and index buffers
+struct MeshRange {
+    u32 IndexCount = 0;
+    u32 StartIndex = 0;
+    i32 BaseVertex = 0;
+};
+
+struct Draw {
+    u16 MeshSlot;
+    u32 StartInstance; // Relative to the start of the pass
+    u32 InstanceCount;
+};
+
+// A part of the stream small enough for one upload
+struct Pass {
+    size_t InstanceCount;
+    size_t FirstDraw;
+    size_t DrawCount;
+    size_t FirstCopy; // The pieces of runs write_instances copies
+    size_t CopyCount;
+};
+
+class Batcher {
+public:
+    using InstanceData = instance_builder::InstanceData;
+
+    // Forgets the runs and the plan, keeping the capacity
+    void clear();
+
+    // Adds a run of instances drawn with `mesh` at `lod`, empty runs are ignored.
+    // Runs can be added in any order, runs of the same slot end up in the same draw.
+    // The instances are not copied, they must stay alive until the stream is written.
+    void add(MeshId mesh, size_t lod, std::span<const InstanceData> instances);
+
+    // Sorts the runs by mesh slot and splits the stream into passes of at most `max_pass_instances`
+    void build(size_t max_pass_instances);
+
+    std::span<const Pass> passes() const { return { m_passes.data(), m_passes.size() }; }
+    std::span<const Draw> draws(const Pass& pass) const { return { m_draws.data() + pass.FirstDraw, pass.DrawCount }; }
+    size_t draw_count() const { return m_draws.size(); }
+
+    // Writes the pass.InstanceCount instances of `pass` to `out`, in the order its draws expect
+    void write_instances(const Pass& pass, InstanceData* out) const;
+
+private:
+    struct Run {
+        u16 MeshSlot;
+        const InstanceData* Instances;
+        size_t Count;
+    };
+
+    memory_stats::Vector<Run, memory_stats::Tag::Primitives> m_runs;
+    memory_stats::Vector<Run, memory_stats::Tag::Primitives> m_scratch;
+    memory_stats::Vector<Run, memory_stats::Tag::Primitives> m_copies;
+    memory_stats::Vector<Draw, memory_stats::Tag::Primitives> m_draws;
+    memory_stats::Vector<Pass, memory_stats::Tag::Primitives> m_passes;
+};
+
+}
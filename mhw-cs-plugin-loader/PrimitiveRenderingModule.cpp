@@ -1,20 +1,23 @@
 #include "PrimitiveRenderingModule.h"
 
 #include <d3dcompiler.h>
-#include <strstream>
+#include <filesystem>
+#include <format>
+#include <unordered_map>
 
 #include "HResultHandler.h"
 #include "D3DModule.h"
 
 #include <d3dx12.h>
 #include <dxgi1_4.h>
-#include <tiny_obj_loader.h>
 #include <dti/sMhCamera.h>
 
 #include "Config.h"
 #include "ChunkModule.h"
+#include "HookStats.h"
 #include "LoaderConfig.h"
 #include "NativePluginFramework.h"
+#include "SingletonModule.h"
 
 PrimitiveRenderingModule::PrimitiveRenderingModule() = default;
 
@@ -22,31 +25,28 @@ void PrimitiveRenderingModule::initialize(CoreClr* coreclr) {
     struct RenderingOptionPointers {
         float* LineThickness;
         bool* DrawPrimitivesAsLines;
+        bool* LineVertexPulling;
+        bool* CullingEnabled;
+        float* MaxDrawDistance;
+        float* MinScreenSize;
+        const CullingStats* Stats;
     } rendering_option_pointers = {
         &m_line_thickness,
-        &m_draw_primitives_as_lines
+        &m_draw_primitives_as_lines,
+        &m_line_vertex_pulling,
+        &m_culling_enabled,
+        &m_max_draw_distance,
+        &m_min_screen_size,
+        &m_culling_stats
     };
 
-    m_retrieve_primitives = coreclr->get_method<std::remove_pointer_t<decltype(m_retrieve_primitives)>>(
-        config::SPL_CORE_ASSEMBLY_NAME,
-        L"SharpPluginLoader.Core.Rendering.Primitives",
-        L"RetrievePrimitives"
-    );
-    m_release_primitives = coreclr->get_method<std::remove_pointer_t<decltype(m_release_primitives)>>(
-        config::SPL_CORE_ASSEMBLY_NAME,
-        L"SharpPluginLoader.Core.Rendering.Primitives",
-        L"ReleasePrimitives"
-    );
-    m_get_singleton = coreclr->get_method<void* (const char*)>(
-        config::SPL_CORE_ASSEMBLY_NAME,
-        L"SharpPluginLoader.Core.SingletonManager",
-        L"GetSingletonNative"
-    );
-    const auto set_rendering_options = coreclr->get_method<void(RenderingOptionPointers*)>(
-        config::SPL_CORE_ASSEMBLY_NAME,
-        L"SharpPluginLoader.Core.Rendering.Renderer",
-        L"SetRenderingOptions"
-    );
+    void(*set_rendering_options)(RenderingOptionPointers*) = nullptr;
+
+    coreclr->get_methods(config::SPL_CORE_ASSEMBLY_NAME, {
+        { L"SharpPluginLoader.Core.Rendering.Primitives", L"RetrievePrimitives", &m_retrieve_primitives },
+        { L"SharpPluginLoader.Core.Rendering.Primitives", L"ReleasePrimitives", &m_release_primitives },
+        { L"SharpPluginLoader.Core.Rendering.Renderer", L"SetRenderingOptions", &set_rendering_options }
+    });
 
     set_rendering_options(&rendering_option_pointers);
 }
@@ -54,8 +54,13 @@ void PrimitiveRenderingModule::initialize(CoreClr* coreclr) {
 void PrimitiveRenderingModule::shutdown() {
     dlog::debug("[PrimitiveRenderingModule] Shutting down");
     if (m_d3d12_frame_contexts) {
+        // The render targets and upload rings may still be in use by the GPU
+        wait_for_d3d12_fence(m_d3d12_fence_value);
         m_d3d12_frame_contexts.reset();
     }
+
+    m_job_pool.reset();
+    m_is_ready = false;
 }
 
 void PrimitiveRenderingModule::late_init(D3DModule* d3dmodule, IDXGISwapChain* swap_chain) {
@@ -66,7 +71,12 @@ void PrimitiveRenderingModule::late_init(D3DModule* d3dmodule, IDXGISwapChain* s
         late_init_d3d11(d3dmodule);
     }
 
-    m_camera = (sMhCamera*)m_get_singleton("sMhCamera");
+    m_camera = SingletonModule::get<sMhCamera>(Singleton::MhCamera);
+    m_job_pool.emplace();
+    m_is_ready = true;
+
+    dlog::debug("[PrimitiveRenderingModule] Using {} instance builder on {} threads",
+        instance_builder::get_isa_name(m_instance_builder.isa()), m_job_pool->thread_count());
 }
 
 void PrimitiveRenderingModule::render_sphere(const MtSphere& sphere, MtVector4 color) {
@@ -85,39 +95,214 @@ void PrimitiveRenderingModule::render_line(const MtLineSegment& line, MtVector4
     throw std::runtime_error("Not implemented");
 }
 
-void PrimitiveRenderingModule::render_primitives_for_d3d11(ID3D11DeviceContext* context) {
-    using namespace DirectX;
-
-    primitives::Sphere* spheres = nullptr;
-    primitives::OBB* cubes = nullptr;
-    primitives::Capsule* capsules = nullptr;
-    primitives::Line* lines = nullptr;
+bool PrimitiveRenderingModule::retrieve_primitives() {
+    primitives::Sphere** spheres = nullptr;
+    primitives::OBB** cubes = nullptr;
+    primitives::Capsule** capsules = nullptr;
+    primitives::Line** lines = nullptr;
+    size_t sphere_count = 0, cube_count = 0, capsule_count = 0, line_count = 0;
 
     m_retrieve_primitives(
-        &spheres, &m_sphere_count,
-        &cubes, &m_cube_count,
-        &capsules, &m_capsule_count,
-        &lines, &m_line_count
+        &spheres, &sphere_count,
+        &cubes, &cube_count,
+        &capsules, &capsule_count,
+        &lines, &line_count
     );
 
-    m_spheres = std::span(spheres, m_sphere_count);
-    m_cubes = std::span(cubes, m_cube_count);
-    m_capsules = std::span(capsules, m_capsule_count);
-    m_lines = std::span(lines, m_line_count);
-
-    //if (m_spheres.empty() && 
-    //    m_cubes.empty() && 
-    //    m_capsules.empty() &&
-    //    m_lines.empty()) {
-    //    return;
-    //}
-    if (m_sphere_count == 0 &&
-        m_cube_count == 0 &&
-        m_capsule_count == 0 &&
-        m_line_count == 0) {
+    m_spheres = { spheres, sphere_count };
+    m_cubes = { cubes, cube_count };
+    m_capsules = { capsules, capsule_count };
+    m_lines = { lines, line_count };
+
+    return !m_spheres.empty() || !m_cubes.empty() || !m_capsules.empty() || !m_lines.empty();
+}
+
+void PrimitiveRenderingModule::build_instances() {
+    using namespace instance_builder;
+
+    // Below this many primitives a job is not worth waking the workers for
+    constexpr size_t GRAIN = 256;
+
+    const size_t sphere_count = m_spheres.size();
+    const size_t obb_count = m_cubes.size();
+    const size_t capsule_count = m_capsules.size();
+    const size_t line_count = m_lines.size();
+
+    m_instance_builder.resize(sphere_count, obb_count, capsule_count);
+    m_line_columns.resize(line_count);
+
+    // Every job gathers its own range, so the output is the same regardless of how the work was split
+    m_job_pool->parallel_for(sphere_count, GRAIN, [this](size_t begin, size_t end) {
+        auto& spheres = m_instance_builder.spheres();
+        for (size_t i = begin; i < end; ++i) {
+            const auto& sphere = m_spheres[i];
+            spheres[sphere::X][i] = sphere.sphere.pos.x;
+            spheres[sphere::Y][i] = sphere.sphere.pos.y;
+            spheres[sphere::Z][i] = sphere.sphere.pos.z;
+            spheres[sphere::Radius][i] = sphere.sphere.r;
+            spheres.Colors[i] = { sphere.color.r, sphere.color.g, sphere.color.b, sphere.color.a };
+        }
+    });
+
+    m_job_pool->parallel_for(obb_count, GRAIN, [this](size_t begin, size_t end) {
+        auto& obbs = m_instance_builder.obbs();
+        for (size_t i = begin; i < end; ++i) {
+            const auto& cube = m_cubes[i];
+            obbs[obb::ExtentX][i] = cube.obb.extent.x;
+            obbs[obb::ExtentY][i] = cube.obb.extent.y;
+            obbs[obb::ExtentZ][i] = cube.obb.extent.z;
+
+            const float* coord = cube.obb.coord.ptr();
+            for (size_t j = 0; j < 16; ++j) {
+                obbs[obb::Coord + j][i] = coord[j];
+            }
+
+            obbs.Colors[i] = { cube.color.r, cube.color.g, cube.color.b, cube.color.a };
+        }
+    });
+
+    m_job_pool->parallel_for(capsule_count, GRAIN, [this](size_t begin, size_t end) {
+        auto& capsules = m_instance_builder.capsules();
+        for (size_t i = begin; i < end; ++i) {
+            const auto& capsule = m_capsules[i];
+            capsules[capsule::P0X][i] = capsule.capsule.p0.x;
+            capsules[capsule::P0Y][i] = capsule.capsule.p0.y;
+            capsules[capsule::P0Z][i] = capsule.capsule.p0.z;
+            capsules[capsule::P1X][i] = capsule.capsule.p1.x;
+            capsules[capsule::P1Y][i] = capsule.capsule.p1.y;
+            capsules[capsule::P1Z][i] = capsule.capsule.p1.z;
+            capsules[capsule::Radius][i] = capsule.capsule.r;
+            capsules.Colors[i] = { capsule.color.r, capsule.color.g, capsule.color.b, capsule.color.a };
+        }
+    });
+
+    m_job_pool->parallel_for(line_count, GRAIN, [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const auto& line = m_lines[i];
+            m_line_columns[culling::line::P0X][i] = line.line.p0.x;
+            m_line_columns[culling::line::P0Y][i] = line.line.p0.y;
+            m_line_columns[culling::line::P0Z][i] = line.line.p0.z;
+            m_line_columns[culling::line::P1X][i] = line.line.p1.x;
+            m_line_columns[culling::line::P1Y][i] = line.line.p1.y;
+            m_line_columns[culling::line::P1Z][i] = line.line.p1.z;
+            m_line_columns.Colors[i] = { line.color.r, line.color.g, line.color.b, line.color.a };
+        }
+    });
+
+    const auto& viewport = m_camera->mViewports[0];
+    const auto frustum = culling::extract_frustum(viewport.mViewMat.ptr(), viewport.mProjMat.ptr(), {
+        .MaxDistance = m_max_draw_distance,
+        .MinScreenSize = m_min_screen_size
+    });
+
+    const size_t total = sphere_count + obb_count + capsule_count + line_count;
+    if (m_culling_enabled) {
+        cull_primitives(frustum);
+    }
+
+    sort_by_lod(frustum);
+
+    auto& spheres = m_instance_builder.spheres();
+    auto& obbs = m_instance_builder.obbs();
+    auto& capsules = m_instance_builder.capsules();
+
+    const size_t drawn = spheres.Count + obbs.Count + capsules.Count + m_line_columns.Count;
+    m_culling_stats = { .Drawn = (u32)drawn, .Culled = (u32)(total - drawn) };
+
+    m_job_pool->parallel_for(spheres.Count, GRAIN, [this](size_t begin, size_t end) {
+        m_instance_builder.build_spheres(begin, end);
+    });
+
+    m_job_pool->parallel_for(obbs.Count, GRAIN, [this](size_t begin, size_t end) {
+        m_instance_builder.build_obbs(begin, end);
+    });
+
+    m_job_pool->parallel_for(capsules.Count, GRAIN, [this](size_t begin, size_t end) {
+        m_instance_builder.build_capsules(begin, end);
+    });
+
+    using primitive_batcher::MeshId;
+    m_batcher.clear();
+    for (size_t lod = 0; lod < culling::LOD_COUNT; ++lod) {
+        m_batcher.add(MeshId::Sphere, lod, lod_range(m_instance_builder.sphere_instances(), m_sphere_lods, lod));
+        m_batcher.add(MeshId::HemisphereTop, lod, lod_range(m_instance_builder.top_instances(), m_capsule_lods, lod));
+        m_batcher.add(MeshId::HemisphereBottom, lod, lod_range(m_instance_builder.bottom_instances(), m_capsule_lods, lod));
+    }
+    m_batcher.add(MeshId::Cube, 0, m_instance_builder.obb_instances());
+    m_batcher.add(MeshId::Cylinder, 0, m_instance_builder.cylinder_instances());
+
+    // A pass has to fit in the upload ring
+    m_batcher.build(UPLOAD_RING_SIZE / sizeof(Instance));
+
+    // Only the selected line path's data is built, the other array is left empty
+    if (m_line_vertex_pulling) {
+        m_line_vertices.clear();
+        m_line_segments.resize(m_line_columns.Count);
+        m_job_pool->parallel_for(m_line_columns.Count, GRAIN, [this](size_t begin, size_t end) {
+            line_builder::build_segments(m_line_columns, begin, end, m_line_segments.data());
+        });
+    } else {
+        m_line_segments.clear();
+        m_line_vertices.resize(m_line_columns.Count * 2);
+        m_job_pool->parallel_for(m_line_columns.Count, GRAIN, [this](size_t begin, size_t end) {
+            line_builder::build_vertices(m_line_columns, begin, end, m_line_vertices.data());
+        });
+    }
+}
+
+void PrimitiveRenderingModule::cull_primitives(const culling::Frustum& frustum) {
+    HOOK_STATS_SCOPE("PrimitiveRenderingModule::cull_primitives");
+
+    // Culling is cheaper per primitive than building, so it gets larger chunks
+    constexpr size_t GRAIN = 1024;
+
+    const auto isa = m_instance_builder.isa();
+
+    // Tests every primitive of `columns` into m_primitive_keys and removes the ones that are not visible
+    const auto cull = [&](auto& columns, auto&& kernel) {
+        m_primitive_keys.resize(columns.Count);
+        m_job_pool->parallel_for(columns.Count, GRAIN, [&](size_t begin, size_t end) {
+            kernel(frustum, columns, begin, end, m_primitive_keys.data(), isa);
+        });
+
+        columns.compact(m_primitive_keys.data());
+    };
+
+    cull(m_instance_builder.spheres(), culling::cull_spheres);
+    cull(m_instance_builder.obbs(), culling::cull_obbs);
+    cull(m_instance_builder.capsules(), culling::cull_capsules);
+    cull(m_line_columns, culling::cull_lines);
+}
+
+void PrimitiveRenderingModule::sort_by_lod(const culling::Frustum& frustum) {
+    constexpr size_t GRAIN = 1024;
+
+    auto& spheres = m_instance_builder.spheres();
+    m_primitive_keys.resize(spheres.Count);
+    m_job_pool->parallel_for(spheres.Count, GRAIN, [&](size_t begin, size_t end) {
+        culling::select_sphere_lods(frustum, spheres, begin, end, LOD_THRESHOLDS, m_primitive_keys.data());
+    });
+
+    spheres.sort_by_key<culling::LOD_COUNT>(m_primitive_keys.data(), m_sort_scratch.Spheres, m_sphere_lods);
+
+    auto& capsules = m_instance_builder.capsules();
+    m_primitive_keys.resize(capsules.Count);
+    m_job_pool->parallel_for(capsules.Count, GRAIN, [&](size_t begin, size_t end) {
+        culling::select_capsule_lods(frustum, capsules, begin, end, LOD_THRESHOLDS, m_primitive_keys.data());
+    });
+
+    capsules.sort_by_key<culling::LOD_COUNT>(m_primitive_keys.data(), m_sort_scratch.Capsules, m_capsule_lods);
+}
+
+void PrimitiveRenderingModule::render_primitives_for_d3d11(ID3D11DeviceContext* context) {
+    using namespace DirectX;
+
+    if (!retrieve_primitives()) {
         return;
     }
 
+    build_instances();
+
     // Set up common pipeline state
     ComPtr<ID3D11RenderTargetView> rtv;
     context->OMGetRenderTargets(1, rtv.GetAddressOf(), nullptr);
@@ -149,204 +334,42 @@ void PrimitiveRenderingModule::render_primitives_for_d3d11(ID3D11DeviceContext*
     context->VSSetConstantBuffers(0, 1, m_d3d11_viewproj_buffer.GetAddressOf());
 
     // Common variables
-    int i = 0;
     constexpr std::array<u32, 2> strides = {
         sizeof(Vertex),
         sizeof(Instance)
     };
-    constexpr std::array<u32, 2> offsets = { 0, 0 };
-    std::array<ID3D11Buffer*, 2> buffers{
-        nullptr,
-        m_d3d11_transform_buffer.Get()
-    };
-
-    // Spheres ------------------------------
-    if (m_sphere_count != 0) {
-        // Build Instance Data
-        HandleResult(context->Map(m_d3d11_transform_buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &msr));
-        auto data = (Instance*)msr.pData;
-
-        for (const auto& sphere : m_spheres) {
-            const XMMATRIX scale = XMMatrixScaling(sphere.sphere.r, sphere.sphere.r, sphere.sphere.r);
-            const XMMATRIX translation = XMMatrixTranslation(sphere.sphere.pos.x, sphere.sphere.pos.y, sphere.sphere.pos.z);
-
-            data[i++] = {
-                .Transform = XMMatrixTranspose(scale * translation),
-                .Color = { sphere.color.r, sphere.color.g, sphere.color.b, sphere.color.a }
-            };
-
-            if (i >= MAX_INSTANCES) {
-                break;
-            }
-        }
-
-        context->Unmap(m_d3d11_transform_buffer.Get(), 0);
-
-        // Set up pipeline
-        context->IASetIndexBuffer(m_d3d11_sphere.IndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-
-        buffers[0] = m_d3d11_sphere.VertexBuffer.Get();
-
-        context->IASetVertexBuffers(0, buffers.size(), buffers.data(), strides.data(), offsets.data());
-        context->DrawIndexedInstanced(
-            m_d3d11_sphere.IndexCount,
-            i, 0, 0, 0
-        );
-    }
-
-    // OBBs ---------------------------------
-    if (m_cube_count != 0) {
-        // Build Instance Data
-        i = 0;
-        HandleResult(context->Map(m_d3d11_transform_buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &msr));
-        auto data = (Instance*)msr.pData;
-
-        for (const auto& cube : m_cubes) {
-            const XMMATRIX scale = XMMatrixScaling(cube.obb.extent.x, cube.obb.extent.y, cube.obb.extent.z);
-            const XMMATRIX translation_rotation{ cube.obb.coord.ptr() };
-
-            data[i++] = {
-                .Transform = XMMatrixTranspose(scale * translation_rotation),
-                .Color = { cube.color.r, cube.color.g, cube.color.b, cube.color.a }
-            };
-
-            if (i >= MAX_INSTANCES) {
-                break;
-            }
-        }
 
-        context->Unmap(m_d3d11_transform_buffer.Get(), 0);
+    // Spheres, OBBs and Capsules ---------
+    // One upload per pass of the instance stream, then one draw per mesh and LOD without any state changes
+    context->IASetIndexBuffer(m_d3d11_meshes.IndexBuffer.Get(), INDEX_FORMAT, 0);
 
-        // Set up pipeline
-        context->IASetIndexBuffer(m_d3d11_cube.IndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+    for (const auto& pass : m_batcher.passes()) {
+        std::array<u32, 2> offsets = { 0, 0 };
+        const auto instances = m_d3d11_upload_ring.map(context, (u32)(pass.InstanceCount * sizeof(Instance)), offsets[1]);
+        m_batcher.write_instances(pass, (instance_builder::InstanceData*)instances);
+        m_d3d11_upload_ring.unmap(context);
 
-        buffers[0] = m_d3d11_cube.VertexBuffer.Get();
-
-        context->IASetVertexBuffers(0, buffers.size(), buffers.data(), strides.data(), offsets.data());
-        context->DrawIndexedInstanced(
-            m_d3d11_cube.IndexCount,
-            i, 0, 0, 0
-        );
-    }
-
-    // Capsules -----------------------------
-    if (m_capsule_count != 0) {
-        // Build Instance Data
-        i = 0;
-        HandleResult(context->Map(m_d3d11_transform_buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &msr));
-        HandleResult(context->Map(m_d3d11_htop_transform_buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &msr));
-        HandleResult(context->Map(m_d3d11_hbottom_transform_buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &msr));
-
-        auto data = (Instance*)msr.pData;
-        auto data_htop = (Instance*)msr.pData;
-        auto data_hbottom = (Instance*)msr.pData;
-
-        for (const auto& capsule : m_capsules) {
-            // Translation
-            XMVECTOR p0{ capsule.capsule.p0.x, capsule.capsule.p0.y, capsule.capsule.p0.z, 1.0f };
-            XMVECTOR p1{ capsule.capsule.p1.x, capsule.capsule.p1.y, capsule.capsule.p1.z, 1.0f };
-            if (XMVectorGetY(p0) > XMVectorGetY(p1)) {
-                std::swap(p0, p1);
-            }
+        const std::array<ID3D11Buffer*, 2> buffers = {
+            m_d3d11_meshes.VertexBuffer.Get(),
+            m_d3d11_upload_ring.buffer()
+        };
 
-            const XMMATRIX translation_htop = XMMatrixTranslationFromVector(p1);
-            const XMMATRIX translation_hbottom = XMMatrixTranslationFromVector(p0);
-            const XMMATRIX translation_cylinder = XMMatrixTranslationFromVector((p0 + p1) * 0.5f);
-
-            // Rotation
-            // if (ez := {0,1,0}) == (ev := P2-P1/norm(P2-P1)) -> R = Id
-            // if (ez := {0,1,0}) == (ev := P1-P2/norm(P2-P1)) -> R = Id (but swap which cap you use for each end)
-            // else
-            // v = ez x ev
-            // s = norm(ev)
-            // c = ez . ev
-            // R = Id + [v]x + [v]^2x 1/(1+c)
-            XMMATRIX rotation = XMMatrixIdentity();
-            XMVECTOR ez = XMVectorSet(0, 1, 0, 0); // Y-up coordinate system
-            XMVECTOR ev = XMVector3Normalize(XMVectorSubtract(p1, p0));
-
-            // Check if ev is parallel or anti-parallel to ez
-            if (XMVector3Equal(ev, ez) || XMVector3Equal(ev, XMVectorNegate(ez))) {
-                // No rotation needed
-                rotation = XMMatrixIdentity();
-            }
-            else {
-                // Compute the rotation matrix
-                const XMVECTOR v = XMVector3Cross(ez, ev);
-                const float c = XMVectorGetX(XMVector3Dot(ez, ev));
-
-                const XMMATRIX vx = { 0, XMVectorGetZ(v), XMVectorGetY(v), 0,
-                                -XMVectorGetZ(v), 0, XMVectorGetX(v), 0,
-                                -XMVectorGetY(v), -XMVectorGetX(v), 0, 0,
-                                0, 0, 0, 0 };
-                const XMMATRIX vx2 = XMMatrixMultiply(vx, vx);
-                
-                rotation = XMMatrixAdd(XMMatrixAdd(XMMatrixIdentity(), vx), vx2 * (1.0f / (1.0f + c)));
-            }
+        context->IASetVertexBuffers(0, (u32)buffers.size(), buffers.data(), strides.data(), offsets.data());
 
-            // Scale
-            const XMMATRIX scale_hemisphere = XMMatrixScaling(capsule.capsule.r, capsule.capsule.r, capsule.capsule.r);
-            const XMMATRIX scale_cylinder = XMMatrixScaling(
-                capsule.capsule.r, 
-                XMVectorGetX(XMVector3Length(p1 - p0)) * 0.5f, 
-                capsule.capsule.r
+        for (const auto& draw : m_batcher.draws(pass)) {
+            const auto& mesh = m_mesh_ranges[draw.MeshSlot];
+            context->DrawIndexedInstanced(
+                mesh.IndexCount,
+                draw.InstanceCount,
+                mesh.StartIndex,
+                mesh.BaseVertex,
+                draw.StartInstance
             );
-
-            data[i] = {
-                .Transform = XMMatrixTranspose(scale_cylinder * rotation * translation_cylinder),
-                .Color = { capsule.color.r, capsule.color.g, capsule.color.b, capsule.color.a }
-            };
-            data_htop[i] = {
-                .Transform = XMMatrixTranspose(scale_hemisphere * rotation * translation_htop),
-                .Color = { capsule.color.r, capsule.color.g, capsule.color.b, capsule.color.a }
-            };
-            data_hbottom[i] = {
-                .Transform = XMMatrixTranspose(scale_hemisphere * rotation * translation_hbottom),
-                .Color = { capsule.color.r, capsule.color.g, capsule.color.b, capsule.color.a }
-            };
-
-            i += 1;
-            if (i >= MAX_INSTANCES) {
-                break;
-            }
         }
-
-        // Top Hemisphere
-        context->IASetIndexBuffer(m_d3d11_hemisphere_top.IndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-
-        buffers[0] = m_d3d11_hemisphere_top.VertexBuffer.Get();
-        buffers[1] = m_d3d11_htop_transform_buffer.Get();
-        context->IASetVertexBuffers(0, buffers.size(), buffers.data(), strides.data(), offsets.data());
-        context->DrawIndexedInstanced(
-            m_d3d11_hemisphere_top.IndexCount,
-            i, 0, 0, 0
-        );
-
-        // Bottom Hemisphere
-        context->IASetIndexBuffer(m_d3d11_hemisphere_bottom.IndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-
-        buffers[0] = m_d3d11_hemisphere_bottom.VertexBuffer.Get();
-        buffers[1] = m_d3d11_hbottom_transform_buffer.Get();
-        context->IASetVertexBuffers(0, buffers.size(), buffers.data(), strides.data(), offsets.data());
-        context->DrawIndexedInstanced(
-            m_d3d11_hemisphere_bottom.IndexCount,
-            i, 0, 0, 0
-        );
-
-        // Cylinder
-        context->IASetIndexBuffer(m_d3d11_cylinder.IndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-
-        buffers[0] = m_d3d11_cylinder.VertexBuffer.Get();
-        buffers[1] = m_d3d11_transform_buffer.Get();
-        context->IASetVertexBuffers(0, buffers.size(), buffers.data(), strides.data(), offsets.data());
-        context->DrawIndexedInstanced(
-            m_d3d11_cylinder.IndexCount,
-            i, 0, 0, 0
-        );
     }
 
     // Lines --------------------------------
-    if (m_line_count != 0) {
+    if (!m_line_vertices.empty()) {
         context->IASetInputLayout(m_d3d11_line_input_layout.Get());
         context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
 
@@ -366,31 +389,53 @@ void PrimitiveRenderingModule::render_primitives_for_d3d11(ID3D11DeviceContext*
 
         context->GSSetConstantBuffers(0, (u32)constant_buffers.size(), constant_buffers.data());
 
-        HandleResult(context->Map(m_d3d11_line_vertex_buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &msr));
-        auto data = (LineVertex*)msr.pData;
+        // Whole lines only, each batch is a separate draw
+        constexpr u32 stride = sizeof(line_builder::Vertex);
+        constexpr size_t max_batch = UPLOAD_RING_SIZE / (sizeof(line_builder::Vertex) * 2) * 2;
 
-        i = 0;
-        for (const auto& line : m_lines) {
-            data[i++] = {
-                .Position = { line.line.p0.x, line.line.p0.y, line.line.p0.z, 1.0f },
-                .Color = { line.color.r, line.color.g, line.color.b, line.color.a }
-            };
-            data[i++] = {
-                .Position = { line.line.p1.x, line.line.p1.y, line.line.p1.z, 1.0f },
-                .Color = { line.color.r, line.color.g, line.color.b, line.color.a }
-            };
+        for (size_t first = 0; first < m_line_vertices.size(); first += max_batch) {
+            const u32 count = (u32)(std::min)(m_line_vertices.size() - first, max_batch);
+            const u32 offset = m_d3d11_upload_ring.upload(context, m_line_vertices.data() + first, count * stride);
+            ID3D11Buffer* buffer = m_d3d11_upload_ring.buffer();
+
+            context->IASetVertexBuffers(0, 1, &buffer, &stride, &offset);
+            context->Draw(count, 0);
         }
+    }
 
-        context->Unmap(m_d3d11_line_vertex_buffer.Get(), 0);
+    if (!m_line_segments.empty()) {
+        context->IASetInputLayout(nullptr);
+        context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
 
-        constexpr u32 stride = sizeof(LineVertex);
-        constexpr u32 offset = 0;
-        context->IASetVertexBuffers(0, 1, m_d3d11_line_vertex_buffer.GetAddressOf(), &stride, &offset);
+        context->VSSetShader(m_d3d11_line_pull_vertex_shader.Get(), nullptr, 0);
+        context->GSSetShader(nullptr, nullptr, 0);
+        context->PSSetShader(m_d3d11_line_pixel_shader.Get(), nullptr, 0);
 
-        context->DrawInstanced(
-            2,
-            (u32)m_line_count, 0, 0
-        );
+        HandleResult(context->Map(m_d3d11_line_params_buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &msr));
+        ((LineParams*)msr.pData)->Thickness = m_line_thickness;
+        context->Unmap(m_d3d11_line_params_buffer.Get(), 0);
+
+        const std::array constant_buffers = {
+            m_d3d11_viewproj_buffer.Get(),
+            m_d3d11_line_params_buffer.Get()
+        };
+
+        context->VSSetConstantBuffers(0, (u32)constant_buffers.size(), constant_buffers.data());
+        context->VSSetShaderResources(0, 1, m_d3d11_line_segment_srv.GetAddressOf());
+
+        // SV_InstanceID starts at 0 in every draw, so each batch is written to the start of the buffer
+        for (size_t first = 0; first < m_line_segments.size(); first += LINE_SEGMENT_BATCH) {
+            const u32 count = (u32)(std::min)(m_line_segments.size() - first, (size_t)LINE_SEGMENT_BATCH);
+
+            HandleResult(context->Map(m_d3d11_line_segment_buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &msr));
+            std::memcpy(msr.pData, m_line_segments.data() + first, count * sizeof(line_builder::Segment));
+            context->Unmap(m_d3d11_line_segment_buffer.Get(), 0);
+
+            context->DrawInstanced(line_builder::SEGMENT_VERTEX_COUNT, count, 0, 0);
+        }
+
+        ID3D11ShaderResourceView* null_srv = nullptr;
+        context->VSSetShaderResources(0, 1, &null_srv);
     }
 
     m_release_primitives();
@@ -404,41 +449,24 @@ void PrimitiveRenderingModule::render_primitives_for_d3d11(ID3D11DeviceContext*
 void PrimitiveRenderingModule::render_primitives_for_d3d12(IDXGISwapChain3* swap_chain, ID3D12CommandQueue* command_queue) {
     using namespace DirectX;
 
-    primitives::Sphere* spheres = nullptr;
-    primitives::OBB* cubes = nullptr;
-    primitives::Capsule* capsules = nullptr;
-    primitives::Line* lines = nullptr;
-
-    m_retrieve_primitives(
-        &spheres, &m_sphere_count,
-        &cubes, &m_cube_count,
-        &capsules, &m_capsule_count,
-        &lines, &m_line_count
-    );
-
-    m_spheres = std::span(spheres, m_sphere_count);
-    m_cubes = std::span(cubes, m_cube_count);
-    m_capsules = std::span(capsules, m_capsule_count);
-    m_lines = std::span(lines, m_line_count);
-
-    //if (m_spheres.empty() && 
-    //    m_cubes.empty() &&
-    //    m_capsules.empty() &&
-    //    m_lines.empty()) {
-    //    return;
-    //}
-    if (m_sphere_count == 0 &&
-        m_cube_count == 0 &&
-        m_capsule_count == 0 &&
-        m_line_count == 0) {
+    if (!retrieve_primitives()) {
         return;
     }
 
+    build_instances();
+
     // Set up common pipeline state
     
-    const FrameContext& frame_context = m_d3d12_frame_contexts[swap_chain->GetCurrentBackBufferIndex()];
+    FrameContext& frame_context = m_d3d12_frame_contexts[swap_chain->GetCurrentBackBufferIndex()];
+
+    // Only waits if the GPU is still executing the last frame that used this context
+    {
+        HOOK_STATS_SCOPE("PrimitiveRenderingModule::d3d12_fence_wait");
+        wait_for_d3d12_fence(frame_context.FenceValue);
+    }
 
-    HandleResult(m_d3d12_command_allocator->Reset());
+    HandleResult(frame_context.CommandAllocator->Reset());
+    frame_context.UploadRing.reset();
 
     D3D12_RESOURCE_BARRIER barrier{};
     barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
@@ -448,7 +476,7 @@ void PrimitiveRenderingModule::render_primitives_for_d3d12(IDXGISwapChain3* swap
     barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
     barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
-    HandleResult(m_d3d12_command_list->Reset(m_d3d12_command_allocator.Get(), m_d3d12_pipeline_state.Get()));
+    HandleResult(m_d3d12_command_list->Reset(frame_context.CommandAllocator.Get(), m_d3d12_pipeline_state.Get()));
     m_d3d12_command_list->ResourceBarrier(1, &barrier);
 
     m_d3d12_command_list->SetGraphicsRootSignature(m_d3d12_root_signature.Get());
@@ -477,269 +505,115 @@ void PrimitiveRenderingModule::render_primitives_for_d3d12(IDXGISwapChain3* swap
     );
 
     // Store VP data
-    ViewProj12* vp = nullptr;
-    HandleResult(m_d3d12_viewproj_buffer->Map(0, nullptr, (void**)&vp));
-    vp->View = XMMatrixTranspose(XMMATRIX(m_camera->mViewports[0].mViewMat.ptr()));
-    vp->Proj = XMMatrixTranspose(XMMATRIX(m_camera->mViewports[0].mProjMat.ptr()));
-
-    m_d3d12_viewproj_buffer->Unmap(0, nullptr);
+    const auto vp = frame_context.UploadRing.allocate(sizeof(ViewProj12), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+    *(ViewProj12*)vp.Data = {
+        .View = XMMatrixTranspose(XMMATRIX(m_camera->mViewports[0].mViewMat.ptr())),
+        .Proj = XMMatrixTranspose(XMMATRIX(m_camera->mViewports[0].mProjMat.ptr()))
+    };
 
     // Set up VP constant buffer
-    m_d3d12_command_list->SetGraphicsRootConstantBufferView(0, m_d3d12_viewproj_buffer->GetGPUVirtualAddress());
-
-    // Common variables
-    int i = 0;
-    std::array<D3D12_VERTEX_BUFFER_VIEW, 2> views{};
-
-    // Spheres ------------------------------
-    if (m_sphere_count != 0) {
-        // Build Instance Data
-        const D3D12_RANGE range{ 
-            0, 
-            sizeof(Instance) * std::min<u32>((u32)m_sphere_count, MAX_INSTANCES)
-        };
-        Instance* data = nullptr;
-        HandleResult(m_d3d12_transform_buffer->Map(0, &range, (void**)&data));
-
-        for (const auto& sphere : m_spheres) {
-            const XMMATRIX scale = XMMatrixScaling(sphere.sphere.r, sphere.sphere.r, sphere.sphere.r);
-            const XMMATRIX translation = XMMatrixTranslation(sphere.sphere.pos.x, sphere.sphere.pos.y, sphere.sphere.pos.z);
-
-            data[i++] = {
-                .Transform = XMMatrixTranspose(scale * translation),
-                .Color = { sphere.color.r, sphere.color.g, sphere.color.b, sphere.color.a }
-            };
+    m_d3d12_command_list->SetGraphicsRootConstantBufferView(0, vp.Address);
 
-            if (i >= MAX_INSTANCES) {
-                break;
-            }
-        }
-
-        m_d3d12_transform_buffer->Unmap(0, nullptr);
-
-        // Set up pipeline
-        views[0] = m_d3d12_sphere.VertexBufferView;
-        views[1] = m_d3d12_transform_buffer_view;
+    // Spheres, OBBs and Capsules ---------
+    // One upload per pass of the instance stream, its draws are executed with a single ExecuteIndirect
+    m_d3d12_command_list->IASetIndexBuffer(&m_d3d12_meshes.IndexBufferView);
 
-        m_d3d12_command_list->IASetIndexBuffer(&m_d3d12_sphere.IndexBufferView);
-        m_d3d12_command_list->IASetVertexBuffers(0, (u32)views.size(), views.data());
-        m_d3d12_command_list->DrawIndexedInstanced(
-            m_d3d12_sphere.IndexCount,
-            i, 0, 0, 0
-        );
-    }
+    for (const auto& pass : m_batcher.passes()) {
+        const u32 instance_bytes = (u32)(pass.InstanceCount * sizeof(Instance));
+        const auto instances = frame_context.UploadRing.allocate(instance_bytes);
+        m_batcher.write_instances(pass, (instance_builder::InstanceData*)instances.Data);
 
-    // OBBs ---------------------------------
-    if (m_cube_count != 0) {
-        // Build Instance Data
-        i = 0;
-        const D3D12_RANGE range{
-            0,
-            sizeof(Instance) * std::min<u32>((u32)m_cube_count, MAX_INSTANCES)
+        const std::array<D3D12_VERTEX_BUFFER_VIEW, 2> views = {
+            m_d3d12_meshes.VertexBufferView,
+            D3D12_VERTEX_BUFFER_VIEW{ instances.Address, instance_bytes, sizeof(Instance) }
         };
-        Instance* data = nullptr;
-        HandleResult(m_d3d12_transform_buffer->Map(0, &range, (void**)&data));
-
-        for (const auto& cube : m_cubes) {
-            const XMMATRIX scale = XMMatrixScaling(cube.obb.extent.x, cube.obb.extent.y, cube.obb.extent.z);
-            const XMMATRIX translation_rotation{ cube.obb.coord.ptr() };
-
-            data[i++] = {
-                .Transform = XMMatrixTranspose(scale * translation_rotation),
-                .Color = { cube.color.r, cube.color.g, cube.color.b, cube.color.a }
-            };
-
-            if (i >= MAX_INSTANCES) {
-                break;
-            }
-        }
-
-        m_d3d12_transform_buffer->Unmap(0, nullptr);
 
-        // Set up pipeline
-        views[0] = m_d3d12_cube.VertexBufferView;
-        views[1] = m_d3d12_transform_buffer_view;
-
-        m_d3d12_command_list->IASetIndexBuffer(&m_d3d12_cube.IndexBufferView);
         m_d3d12_command_list->IASetVertexBuffers(0, (u32)views.size(), views.data());
-        m_d3d12_command_list->DrawIndexedInstanced(
-            m_d3d12_cube.IndexCount,
-            i, 0, 0, 0
-        );
-    }
-
-    // Capsules -----------------------------
-    if (m_capsule_count != 0) {
-        // Build Instance Data
-        i = 0;
-        const D3D12_RANGE range{
-            0,
-            sizeof(Instance) * std::min<u32>((u32)m_capsule_count, MAX_INSTANCES)
-        };
-        Instance* data = nullptr;
-        Instance* data_htop = nullptr;
-        Instance* data_hbottom = nullptr;
-        HandleResult(m_d3d12_transform_buffer->Map(0, &range, (void**)&data));
-        HandleResult(m_d3d12_htop_transform_buffer->Map(0, &range, (void**)&data_htop));
-        HandleResult(m_d3d12_hbottom_transform_buffer->Map(0, &range, (void**)&data_hbottom));
-
-        for (const auto& capsule : m_capsules) {
-            // Translation
-            XMVECTOR p0{ capsule.capsule.p0.x, capsule.capsule.p0.y, capsule.capsule.p0.z, 1.0f };
-            XMVECTOR p1{ capsule.capsule.p1.x, capsule.capsule.p1.y, capsule.capsule.p1.z, 1.0f };
-            if (XMVectorGetY(p0) > XMVectorGetY(p1)) {
-                std::swap(p0, p1);
-            }
 
-            const XMMATRIX translation_htop = XMMatrixTranslationFromVector(p1);
-            const XMMATRIX translation_hbottom = XMMatrixTranslationFromVector(p0);
-            const XMMATRIX translation_cylinder = XMMatrixTranslationFromVector((p0 + p1) * 0.5f);
-
-            // Rotation
-            // if (ez := {0,1,0}) == (ev := P2-P1/norm(P2-P1)) -> R = Id
-            // if (ez := {0,1,0}) == (ev := P1-P2/norm(P2-P1)) -> R = Id (but swap which cap you use for each end)
-            // else
-            // v = ez x ev
-            // s = norm(ev)
-            // c = ez . ev
-            // R = Id + [v]x + [v]^2x 1/(1+c)
-            XMMATRIX rotation = XMMatrixIdentity();
-            XMVECTOR ez = XMVectorSet(0, 1, 0, 0); // Y-up coordinate system
-            XMVECTOR ev = XMVector3Normalize(XMVectorSubtract(p1, p0));
-
-            // Check if ev is parallel or anti-parallel to ez
-            if (XMVector3Equal(ev, ez) || XMVector3Equal(ev, XMVectorNegate(ez))) {
-                // No rotation needed
-                rotation = XMMatrixIdentity();
-            }
-            else {
-                // Compute the rotation matrix
-                const XMVECTOR v = XMVector3Cross(ez, ev);
-                const float c = XMVectorGetX(XMVector3Dot(ez, ev));
-
-                const XMMATRIX vx = { 0, XMVectorGetZ(v), XMVectorGetY(v), 0,
-                                      -XMVectorGetZ(v), 0, XMVectorGetX(v), 0,
-                                      -XMVectorGetY(v), -XMVectorGetX(v), 0, 0,
-                                      0, 0, 0, 0 };
-
-                const XMMATRIX vx2 = XMMatrixMultiply(vx, vx);
-
-                rotation = XMMatrixAdd(XMMatrixAdd(XMMatrixIdentity(), vx), vx2 * (1.0f / (1.0f + c)));
-            }
-
-            // Scale
-            const XMMATRIX scale_hemisphere = XMMatrixScaling(capsule.capsule.r, capsule.capsule.r, capsule.capsule.r);
-            const XMMATRIX scale_cylinder = XMMatrixScaling(
-                capsule.capsule.r,
-                XMVectorGetX(XMVector3Length(p1 - p0)) * 0.5f,
-                capsule.capsule.r
-            );
+        const auto draws = m_batcher.draws(pass);
+        const auto arguments = frame_context.UploadRing.allocate(
+            (u32)(draws.size() * sizeof(D3D12_DRAW_INDEXED_ARGUMENTS)), sizeof(u32)
+        );
 
-            data[i] = {
-                .Transform = XMMatrixTranspose(scale_cylinder * rotation * translation_cylinder),
-                .Color = { capsule.color.r, capsule.color.g, capsule.color.b, capsule.color.a }
+        const auto draw_arguments = (D3D12_DRAW_INDEXED_ARGUMENTS*)arguments.Data;
+        for (size_t i = 0; i < draws.size(); ++i) {
+            const auto& mesh = m_mesh_ranges[draws[i].MeshSlot];
+            draw_arguments[i] = {
+                .IndexCountPerInstance = mesh.IndexCount,
+                .InstanceCount = draws[i].InstanceCount,
+                .StartIndexLocation = mesh.StartIndex,
+                .BaseVertexLocation = mesh.BaseVertex,
+                .StartInstanceLocation = draws[i].StartInstance
             };
-            data_htop[i] = {
-                .Transform = XMMatrixTranspose(scale_hemisphere * rotation * translation_htop),
-                .Color = { capsule.color.r, capsule.color.g, capsule.color.b, capsule.color.a }
-            };
-            data_hbottom[i] = {
-                .Transform = XMMatrixTranspose(scale_hemisphere * rotation * translation_hbottom),
-                .Color = { capsule.color.r, capsule.color.g, capsule.color.b, capsule.color.a }
-            };
-
-            i += 1;
-            if (i >= MAX_INSTANCES) {
-                break;
-            }
         }
 
-        m_d3d12_transform_buffer->Unmap(0, nullptr);
-        m_d3d12_htop_transform_buffer->Unmap(0, nullptr);
-        m_d3d12_hbottom_transform_buffer->Unmap(0, nullptr);
-
-        // Top Hemisphere
-        views[0] = m_d3d12_hemisphere_top.VertexBufferView;
-        views[1] = m_d3d12_htop_transform_buffer_view;
-
-        m_d3d12_command_list->IASetIndexBuffer(&m_d3d12_hemisphere_top.IndexBufferView);
-        m_d3d12_command_list->IASetVertexBuffers(0, (u32)views.size(), views.data());
-        m_d3d12_command_list->DrawIndexedInstanced(
-            m_d3d12_hemisphere_top.IndexCount,
-            i, 0, 0, 0
-        );
-
-        // Bottom Hemisphere
-        views[0] = m_d3d12_hemisphere_bottom.VertexBufferView;
-        views[1] = m_d3d12_hbottom_transform_buffer_view;
-
-        m_d3d12_command_list->IASetIndexBuffer(&m_d3d12_hemisphere_bottom.IndexBufferView);
-        m_d3d12_command_list->IASetVertexBuffers(0, (u32)views.size(), views.data());
-        m_d3d12_command_list->DrawIndexedInstanced(
-            m_d3d12_hemisphere_bottom.IndexCount,
-            i, 0, 0, 0
-        );
-
-        // Cylinder
-        views[0] = m_d3d12_cylinder.VertexBufferView;
-        views[1] = m_d3d12_transform_buffer_view;
-
-        m_d3d12_command_list->IASetIndexBuffer(&m_d3d12_cylinder.IndexBufferView);
-        m_d3d12_command_list->IASetVertexBuffers(0, (u32)views.size(), views.data());
-        m_d3d12_command_list->DrawIndexedInstanced(
-            m_d3d12_cylinder.IndexCount,
-            i, 0, 0, 0
+        m_d3d12_command_list->ExecuteIndirect(
+            m_d3d12_draw_signature.Get(),
+            (u32)draws.size(),
+            arguments.Resource,
+            arguments.Offset,
+            nullptr,
+            0
         );
     }
 
     // Lines --------------------------------
-    if (m_line_count != 0) {
+    if (!m_line_vertices.empty()) {
         // Set up line pipeline state
         m_d3d12_command_list->SetPipelineState(m_d3d12_line_pipeline_state.Get());
         m_d3d12_command_list->SetGraphicsRootSignature(m_d3d12_line_root_signature.Get());
 
         // Bind ViewProj buffer
-        m_d3d12_command_list->SetGraphicsRootConstantBufferView(0, m_d3d12_viewproj_buffer->GetGPUVirtualAddress());
+        m_d3d12_command_list->SetGraphicsRootConstantBufferView(0, vp.Address);
 
         // Set up line params buffer
-        LineParams* line_params = nullptr;
-        HandleResult(m_d3d12_line_params_buffer->Map(0, nullptr, (void**)&line_params));
-        line_params->Thickness = m_line_thickness;
-        m_d3d12_line_params_buffer->Unmap(0, nullptr);
+        const auto line_params = frame_context.UploadRing.allocate(sizeof(LineParams), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+        ((LineParams*)line_params.Data)->Thickness = m_line_thickness;
 
-        m_d3d12_command_list->SetGraphicsRootConstantBufferView(1, m_d3d12_line_params_buffer->GetGPUVirtualAddress());
+        m_d3d12_command_list->SetGraphicsRootConstantBufferView(1, line_params.Address);
 
-        // Set up line vertex buffer
-        const D3D12_RANGE range{
-            0,
-            sizeof(LineVertex) * m_line_count * 2
-        };
+        m_d3d12_command_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_LINELIST);
 
-        LineVertex* data = nullptr;
-        HandleResult(m_d3d12_line_vertex_buffer->Map(0, &range, (void**)&data));
+        // Whole lines only, each batch is a separate draw
+        constexpr u32 stride = sizeof(line_builder::Vertex);
+        constexpr size_t max_batch = UPLOAD_RING_SIZE / (stride * 2) * 2;
 
-        i = 0;
-        for (const auto& line : m_lines) {
-            data[i++] = LineVertex{
-                .Position = { line.line.p0.x, line.line.p0.y, line.line.p0.z, 1.0f },
-                .Color = { line.color.r, line.color.g, line.color.b, line.color.a }
-            };
-            data[i++] = LineVertex{
-                .Position = { line.line.p1.x, line.line.p1.y, line.line.p1.z, 1.0f },
-                .Color = { line.color.r, line.color.g, line.color.b, line.color.a }
-            };
+        for (size_t first = 0; first < m_line_vertices.size(); first += max_batch) {
+            const u32 count = (u32)(std::min)(m_line_vertices.size() - first, max_batch);
+            const auto allocation = frame_context.UploadRing.allocate(count * stride);
+            std::memcpy(allocation.Data, m_line_vertices.data() + first, count * stride);
+
+            const D3D12_VERTEX_BUFFER_VIEW view{ allocation.Address, count * stride, stride };
+
+            m_d3d12_command_list->IASetVertexBuffers(0, 1, &view);
+            m_d3d12_command_list->DrawInstanced(count, 1, 0, 0);
         }
+    }
 
-        m_d3d12_line_vertex_buffer->Unmap(0, nullptr);
+    if (!m_line_segments.empty()) {
+        m_d3d12_command_list->SetPipelineState(m_d3d12_line_pull_pipeline_state.Get());
+        m_d3d12_command_list->SetGraphicsRootSignature(m_d3d12_line_pull_root_signature.Get());
 
-        views[0] = m_d3d12_line_vertex_buffer_view;
+        m_d3d12_command_list->SetGraphicsRootConstantBufferView(0, vp.Address);
 
-        m_d3d12_command_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_LINELIST);
-        m_d3d12_command_list->IASetVertexBuffers(0, 1, views.data());
-        m_d3d12_command_list->DrawInstanced(
-            2,
-            (u32)m_line_count, 0, 0
-        );
+        const auto line_params = frame_context.UploadRing.allocate(sizeof(LineParams), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+        ((LineParams*)line_params.Data)->Thickness = m_line_thickness;
+
+        m_d3d12_command_list->SetGraphicsRootConstantBufferView(1, line_params.Address);
+
+        m_d3d12_command_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+
+        // SV_InstanceID starts at 0 in every draw, so each batch gets its own root SRV
+        constexpr u32 stride = sizeof(line_builder::Segment);
+
+        for (size_t first = 0; first < m_line_segments.size(); first += LINE_SEGMENT_BATCH) {
+            const u32 count = (u32)(std::min)(m_line_segments.size() - first, (size_t)LINE_SEGMENT_BATCH);
+            const auto allocation = frame_context.UploadRing.allocate(count * stride, stride);
+            std::memcpy(allocation.Data, m_line_segments.data() + first, count * stride);
+
+            m_d3d12_command_list->SetGraphicsRootShaderResourceView(2, allocation.Address);
+            m_d3d12_command_list->DrawInstanced(line_builder::SEGMENT_VERTEX_COUNT, count, 0, 0);
+        }
     }
 
     // Close command list
@@ -751,6 +625,10 @@ void PrimitiveRenderingModule::render_primitives_for_d3d12(IDXGISwapChain3* swap
 
     command_queue->ExecuteCommandLists(1, CommandListCast(m_d3d12_command_list.GetAddressOf()));
 
+    // Queued behind the commands above, so the context can be reused once the fence reaches this value
+    HandleResult(command_queue->Signal(m_d3d12_fence.Get(), ++m_d3d12_fence_value));
+    frame_context.FenceValue = m_d3d12_fence_value;
+
     m_release_primitives();
 
     //m_spheres.clear();
@@ -764,11 +642,7 @@ void PrimitiveRenderingModule::late_init_d3d11(D3DModule* d3dmodule) {
         return;
     }
 
-    load_mesh_d3d11(d3dmodule->m_d3d11_device, "/Resources/Sphere.obj", m_d3d11_sphere);
-    load_mesh_d3d11(d3dmodule->m_d3d11_device, "/Resources/Cube.obj", m_d3d11_cube);
-    load_mesh_d3d11(d3dmodule->m_d3d11_device, "/Resources/Hemisphere.obj", m_d3d11_hemisphere_top);
-    load_mesh_d3d11(d3dmodule->m_d3d11_device, "/Resources/BottomHemisphere.obj", m_d3d11_hemisphere_bottom);
-    load_mesh_d3d11(d3dmodule->m_d3d11_device, "/Resources/Cylinder.obj", m_d3d11_cylinder);
+    load_mesh_d3d11(d3dmodule->m_d3d11_device, load_meshes(m_mesh_ranges), m_d3d11_meshes);
 
     // Create ViewProj Constant Buffer
     D3D11_BUFFER_DESC bd{};
@@ -784,50 +658,30 @@ void PrimitiveRenderingModule::late_init_d3d11(D3DModule* d3dmodule) {
     bd.ByteWidth = sizeof LineParams;
     HandleResult(d3dmodule->m_d3d11_device->CreateBuffer(&bd, nullptr, m_d3d11_line_params_buffer.GetAddressOf()));
 
-    bd.ByteWidth = sizeof Instance * MAX_INSTANCES;
-    bd.Usage = D3D11_USAGE_DYNAMIC;
-    bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-    bd.StructureByteStride = sizeof Instance;
-
-    HandleResult(d3dmodule->m_d3d11_device->CreateBuffer(&bd, nullptr, m_d3d11_transform_buffer.GetAddressOf()));
-    HandleResult(d3dmodule->m_d3d11_device->CreateBuffer(&bd, nullptr, m_d3d11_htop_transform_buffer.GetAddressOf()));
-    HandleResult(d3dmodule->m_d3d11_device->CreateBuffer(&bd, nullptr, m_d3d11_hbottom_transform_buffer.GetAddressOf()));
-    
-    // Create Line Vertex Buffer
-    bd.ByteWidth = sizeof LineVertex * MAX_LINES * 2;
-    bd.Usage = D3D11_USAGE_DYNAMIC;
-    bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-    bd.StructureByteStride = sizeof LineVertex;
-
-    HandleResult(d3dmodule->m_d3d11_device->CreateBuffer(&bd, nullptr, m_d3d11_line_vertex_buffer.GetAddressOf()));
-
-    ComPtr<ID3DBlob> vs_blob;
-    ComPtr<ID3DBlob> ps_blob;
-
-    const auto& chunk = NativePluginFramework::get_module<ChunkModule>()->request_chunk("Default");
-    const auto& vs = chunk->get_file("/Resources/PrimitiveRenderingVS.hlsl");
-    const auto& ps = chunk->get_file("/Resources/PrimitiveRenderingPS.hlsl");
-
-    const auto load = [&](const Ref<FileSystemFile>& file, const char* target, ComPtr<ID3DBlob>& blob) {
-        HandleResult(D3DCompile(
-            file->Contents.data(),
-            file->size(),
-            nullptr,
-            nullptr,
-            nullptr,
-            "main",
-            target,
-            D3DCOMPILE_DEBUG,
-            0,
-            blob.GetAddressOf(),
-            nullptr
-        ));
-    };
+    // Instance and Line Vertex Upload Ring
+    m_d3d11_upload_ring.create(d3dmodule->m_d3d11_device, UPLOAD_RING_SIZE, D3D11_BIND_VERTEX_BUFFER);
+
+    // Line Segment Structured Buffer, rewritten with WRITE_DISCARD for every batch
+    bd.ByteWidth = LINE_SEGMENT_BATCH * sizeof(line_builder::Segment);
+    bd.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    bd.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+    bd.StructureByteStride = sizeof(line_builder::Segment);
+    HandleResult(d3dmodule->m_d3d11_device->CreateBuffer(&bd, nullptr, m_d3d11_line_segment_buffer.GetAddressOf()));
+    m_d3d11_line_segment_memory = { memory_stats::Tag::Primitives, bd.ByteWidth };
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc{};
+    srv_desc.Format = DXGI_FORMAT_UNKNOWN;
+    srv_desc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+    srv_desc.Buffer.FirstElement = 0;
+    srv_desc.Buffer.NumElements = LINE_SEGMENT_BATCH;
+    HandleResult(d3dmodule->m_d3d11_device->CreateShaderResourceView(
+        m_d3d11_line_segment_buffer.Get(),
+        &srv_desc,
+        m_d3d11_line_segment_srv.GetAddressOf()
+    ));
 
-    load(vs, "vs_5_0", vs_blob);
-    load(ps, "ps_5_0", ps_blob);
+    ComPtr<ID3DBlob> vs_blob = load_shader("PrimitiveRenderingVS", "vs_5_0");
+    ComPtr<ID3DBlob> ps_blob = load_shader("PrimitiveRenderingPS", "ps_5_0");
 
     HandleResult(d3dmodule->m_d3d11_device->CreateVertexShader(
         vs_blob->GetBufferPointer(),
@@ -862,17 +716,9 @@ void PrimitiveRenderingModule::late_init_d3d11(D3DModule* d3dmodule) {
         m_d3d11_input_layout.GetAddressOf()
     ));
 
-    vs_blob.Reset();
-    ps_blob.Reset();
-    ComPtr<ID3DBlob> gs_blob;
-
-    const auto& line_vs = chunk->get_file("/Resources/LineRenderingVS.hlsl");
-    const auto& line_gs = chunk->get_file("/Resources/LineRenderingGS.hlsl");
-    const auto& line_ps = chunk->get_file("/Resources/LineRenderingPS.hlsl");
-
-    load(line_vs, "vs_5_0", vs_blob);
-    load(line_gs, "gs_5_0", gs_blob);
-    load(line_ps, "ps_5_0", ps_blob);
+    vs_blob = load_shader("LineRenderingVS", "vs_5_0");
+    ps_blob = load_shader("LineRenderingPS", "ps_5_0");
+    const ComPtr<ID3DBlob> gs_blob = load_shader("LineRenderingGS", "gs_5_0");
 
     HandleResult(d3dmodule->m_d3d11_device->CreateVertexShader(
         vs_blob->GetBufferPointer(),
@@ -908,6 +754,16 @@ void PrimitiveRenderingModule::late_init_d3d11(D3DModule* d3dmodule) {
         m_d3d11_line_input_layout.GetAddressOf()
     ));
 
+    // Vertex pulling lines read their segments from a structured buffer, no input layout
+    vs_blob = load_shader("LineRenderingPullVS", "vs_5_0");
+
+    HandleResult(d3dmodule->m_d3d11_device->CreateVertexShader(
+        vs_blob->GetBufferPointer(),
+        vs_blob->GetBufferSize(),
+        nullptr,
+        m_d3d11_line_pull_vertex_shader.GetAddressOf()
+    ));
+
     D3D11_RASTERIZER_DESC rasterizer_desc{};
     rasterizer_desc.FillMode = D3D11_FILL_SOLID;
     rasterizer_desc.CullMode = D3D11_CULL_NONE;
@@ -984,15 +840,11 @@ void PrimitiveRenderingModule::late_init_d3d11(D3DModule* d3dmodule) {
 
 void PrimitiveRenderingModule::late_init_d3d12(D3DModule* d3dmodule, IDXGISwapChain* swap_chain) {
     if (m_is_initialized) {
-        create_frame_contexts(d3dmodule, (IDXGISwapChain3*)swap_chain);
+        create_swap_chain_resources(d3dmodule, (IDXGISwapChain3*)swap_chain);
         return;
     }
 
-    load_mesh_d3d12(d3dmodule->m_d3d12_device, "/Resources/Sphere.obj", m_d3d12_sphere);
-    load_mesh_d3d12(d3dmodule->m_d3d12_device, "/Resources/Cube.obj", m_d3d12_cube);
-    load_mesh_d3d12(d3dmodule->m_d3d12_device, "/Resources/Hemisphere.obj", m_d3d12_hemisphere_top);
-    load_mesh_d3d12(d3dmodule->m_d3d12_device, "/Resources/BottomHemisphere.obj", m_d3d12_hemisphere_bottom);
-    load_mesh_d3d12(d3dmodule->m_d3d12_device, "/Resources/Cylinder.obj", m_d3d12_cylinder);
+    load_mesh_d3d12(d3dmodule->m_d3d12_device, load_meshes(m_mesh_ranges), m_d3d12_meshes);
 
     // Mesh Root Signature ----------------------------------------------
     CD3DX12_ROOT_PARAMETER root_parameters[3]{};
@@ -1073,38 +925,46 @@ void PrimitiveRenderingModule::late_init_d3d12(D3DModule* d3dmodule, IDXGISwapCh
         IID_PPV_ARGS(m_d3d12_line_root_signature.GetAddressOf())
     ));
 
-    // Mesh Pipeline State ----------------------------------------------
-    ComPtr<ID3DBlob> vs_blob;
-    ComPtr<ID3DBlob> ps_blob;
+    // Line Pull Root Signature -----------------------------------------
+    memset(root_parameters, 0, sizeof root_parameters);
 
-    const auto& chunk = NativePluginFramework::get_module<ChunkModule>()->request_chunk("Default");
-    const auto& vs = chunk->get_file("/Resources/PrimitiveRenderingVS.hlsl");
-    const auto& ps = chunk->get_file("/Resources/PrimitiveRenderingPS.hlsl");
+    // ViewProj Constant Buffer
+    root_parameters[0].InitAsConstantBufferView(0, 0, D3D12_SHADER_VISIBILITY_VERTEX);
 
-    const auto load = [&](const Ref<FileSystemFile>& file, const char* target, ComPtr<ID3DBlob>& blob) {
-#ifdef _DEBUG
-        constexpr UINT compile_flags = D3DCOMPILE_DEBUG;
-#else
-        constexpr UINT compile_flags = 0;
-#endif
+    // Line Params Constant Buffer
+    root_parameters[1].InitAsConstantBufferView(1, 0, D3D12_SHADER_VISIBILITY_VERTEX);
 
-        HandleResult(D3DCompile(
-            file->Contents.data(),
-            file->size(),
-            nullptr,
-            nullptr,
-            nullptr,
-            "main",
-            target,
-            compile_flags,
-            0,
-            blob.GetAddressOf(),
-            nullptr
-        ));
-    };
+    // Segment Buffer
+    root_parameters[2].InitAsShaderResourceView(0, 0, D3D12_SHADER_VISIBILITY_VERTEX);
+
+    root_signature_desc.Init(
+        3,
+        root_parameters,
+        0,
+        nullptr,
+        D3D12_ROOT_SIGNATURE_FLAG_NONE
+    );
 
-    load(vs, "vs_5_0", vs_blob);
-    load(ps, "ps_5_0", ps_blob);
+    signature_blob.Reset();
+    error_blob.Reset();
+
+    HandleResult(serialize_root_signature(
+        &root_signature_desc,
+        D3D_ROOT_SIGNATURE_VERSION_1,
+        signature_blob.GetAddressOf(),
+        error_blob.GetAddressOf()
+    ));
+
+    HandleResult(d3dmodule->m_d3d12_device->CreateRootSignature(
+        0,
+        signature_blob->GetBufferPointer(),
+        signature_blob->GetBufferSize(),
+        IID_PPV_ARGS(m_d3d12_line_pull_root_signature.GetAddressOf())
+    ));
+
+    // Mesh Pipeline State ----------------------------------------------
+    ComPtr<ID3DBlob> vs_blob = load_shader("PrimitiveRenderingVS", "vs_5_0");
+    ComPtr<ID3DBlob> ps_blob = load_shader("PrimitiveRenderingPS", "ps_5_0");
 
     D3D12_INPUT_ELEMENT_DESC input_element_desc[] = {
         // Per Vertex (Buffer 1)
@@ -1172,18 +1032,26 @@ void PrimitiveRenderingModule::late_init_d3d12(D3DModule* d3dmodule, IDXGISwapCh
         IID_PPV_ARGS(m_d3d12_pipeline_state.GetAddressOf())
     ));
 
-    // Line Pipeline State ----------------------------------------------
-    vs_blob.Reset();
-    ps_blob.Reset();
-    ComPtr<ID3DBlob> gs_blob;
+    // Draw Command Signature -------------------------------------------
+    // Only draw arguments, so no root signature is needed
+    D3D12_INDIRECT_ARGUMENT_DESC argument_desc{};
+    argument_desc.Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
 
-    const auto& line_vs = chunk->get_file("/Resources/LineRenderingVS.hlsl");
-    const auto& line_gs = chunk->get_file("/Resources/LineRenderingGS.hlsl");
-    const auto& line_ps = chunk->get_file("/Resources/LineRenderingPS.hlsl");
+    D3D12_COMMAND_SIGNATURE_DESC command_signature_desc{};
+    command_signature_desc.ByteStride = sizeof(D3D12_DRAW_INDEXED_ARGUMENTS);
+    command_signature_desc.NumArgumentDescs = 1;
+    command_signature_desc.pArgumentDescs = &argument_desc;
 
-    load(line_vs, "vs_5_0", vs_blob);
-    load(line_gs, "gs_5_0", gs_blob);
-    load(line_ps, "ps_5_0", ps_blob);
+    HandleResult(d3dmodule->m_d3d12_device->CreateCommandSignature(
+        &command_signature_desc,
+        nullptr,
+        IID_PPV_ARGS(m_d3d12_draw_signature.GetAddressOf())
+    ));
+
+    // Line Pipeline State ----------------------------------------------
+    vs_blob = load_shader("LineRenderingVS", "vs_5_0");
+    ps_blob = load_shader("LineRenderingPS", "ps_5_0");
+    const ComPtr<ID3DBlob> gs_blob = load_shader("LineRenderingGS", "gs_5_0");
 
     D3D12_INPUT_ELEMENT_DESC line_input_element_desc[] = {
         {"POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
@@ -1213,98 +1081,21 @@ void PrimitiveRenderingModule::late_init_d3d12(D3DModule* d3dmodule, IDXGISwapCh
         IID_PPV_ARGS(m_d3d12_line_pipeline_state.GetAddressOf())
     ));
 
-    // ViewProj Constant Buffer
-    D3D12_HEAP_PROPERTIES heap_properties{};
-    heap_properties.Type = D3D12_HEAP_TYPE_UPLOAD;
-
-    D3D12_RESOURCE_DESC resource_desc{};
-    resource_desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-    resource_desc.Width = sizeof ViewProj12;
-    resource_desc.Height = 1;
-    resource_desc.DepthOrArraySize = 1;
-    resource_desc.MipLevels = 1;
-    resource_desc.Format = DXGI_FORMAT_UNKNOWN;
-    resource_desc.SampleDesc.Count = 1;
-    resource_desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-
-    HandleResult(d3dmodule->m_d3d12_device->CreateCommittedResource(
-        &heap_properties,
-        D3D12_HEAP_FLAG_NONE,
-        &resource_desc,
-        D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(m_d3d12_viewproj_buffer.GetAddressOf())
-    ));
-
-    // Instance Buffer
-    resource_desc.Width = sizeof Instance * MAX_INSTANCES;
-
-    HandleResult(d3dmodule->m_d3d12_device->CreateCommittedResource(
-        &heap_properties,
-        D3D12_HEAP_FLAG_NONE,
-        &resource_desc,
-        D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(m_d3d12_transform_buffer.GetAddressOf())
-    ));
-    HandleResult(d3dmodule->m_d3d12_device->CreateCommittedResource(
-        &heap_properties,
-        D3D12_HEAP_FLAG_NONE,
-        &resource_desc,
-        D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(m_d3d12_htop_transform_buffer.GetAddressOf())
-    ));
-    HandleResult(d3dmodule->m_d3d12_device->CreateCommittedResource(
-        &heap_properties,
-        D3D12_HEAP_FLAG_NONE,
-        &resource_desc,
-        D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(m_d3d12_hbottom_transform_buffer.GetAddressOf())
-    ));
+    // Line Pull Pipeline State -----------------------------------------
+    vs_blob = load_shader("LineRenderingPullVS", "vs_5_0");
 
-    // Line Params Constant Buffer
-    resource_desc.Width = sizeof LineParams;
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC line_pull_pso_desc = line_pso_desc;
+    line_pull_pso_desc.pRootSignature = m_d3d12_line_pull_root_signature.Get();
+    line_pull_pso_desc.VS = CD3DX12_SHADER_BYTECODE(vs_blob.Get());
+    line_pull_pso_desc.GS = {};
+    line_pull_pso_desc.InputLayout = {};
+    line_pull_pso_desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
 
-    HandleResult(d3dmodule->m_d3d12_device->CreateCommittedResource(
-        &heap_properties,
-        D3D12_HEAP_FLAG_NONE,
-        &resource_desc,
-        D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(m_d3d12_line_params_buffer.GetAddressOf())
-    ));
-
-    // Line Vertex Buffer
-    resource_desc.Width = sizeof LineVertex * MAX_LINES * 2; // 2 vertices per line
-
-    HandleResult(d3dmodule->m_d3d12_device->CreateCommittedResource(
-        &heap_properties,
-        D3D12_HEAP_FLAG_NONE,
-        &resource_desc,
-        D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(m_d3d12_line_vertex_buffer.GetAddressOf())
+    HandleResult(d3dmodule->m_d3d12_device->CreateGraphicsPipelineState(
+        &line_pull_pso_desc,
+        IID_PPV_ARGS(m_d3d12_line_pull_pipeline_state.GetAddressOf())
     ));
 
-    // Create Views
-    m_d3d12_transform_buffer_view.BufferLocation = m_d3d12_transform_buffer->GetGPUVirtualAddress();
-    m_d3d12_transform_buffer_view.SizeInBytes = sizeof Instance * MAX_INSTANCES;
-    m_d3d12_transform_buffer_view.StrideInBytes = sizeof Instance;
-
-    m_d3d12_htop_transform_buffer_view.BufferLocation = m_d3d12_htop_transform_buffer->GetGPUVirtualAddress();
-    m_d3d12_htop_transform_buffer_view.SizeInBytes = sizeof Instance * MAX_INSTANCES;
-    m_d3d12_htop_transform_buffer_view.StrideInBytes = sizeof Instance;
-
-    m_d3d12_hbottom_transform_buffer_view.BufferLocation = m_d3d12_hbottom_transform_buffer->GetGPUVirtualAddress();
-    m_d3d12_hbottom_transform_buffer_view.SizeInBytes = sizeof Instance * MAX_INSTANCES;
-    m_d3d12_hbottom_transform_buffer_view.StrideInBytes = sizeof Instance;
-
-    m_d3d12_line_vertex_buffer_view.BufferLocation = m_d3d12_line_vertex_buffer->GetGPUVirtualAddress();
-    m_d3d12_line_vertex_buffer_view.SizeInBytes = sizeof LineVertex * MAX_LINES * 2;
-    m_d3d12_line_vertex_buffer_view.StrideInBytes = sizeof LineVertex;
-
     // Depth Stencil
     // Depth Stencil Descriptor Heap
     D3D12_DESCRIPTOR_HEAP_DESC descriptor_heap_desc{};
@@ -1320,15 +1111,44 @@ void PrimitiveRenderingModule::late_init_d3d12(D3DModule* d3dmodule, IDXGISwapCh
 
     m_d3d12_depth_stencil_view = m_d3d12_dsv_heap->GetCPUDescriptorHandleForHeapStart();
 
-    RECT rect{};
-    if (!GetClientRect(d3dmodule->m_game_window, &rect)) {
-        dlog::error("Failed to get client rect");
+    // Frame Fence
+    HandleResult(d3dmodule->m_d3d12_device->CreateFence(
+        0,
+        D3D12_FENCE_FLAG_NONE,
+        IID_PPV_ARGS(m_d3d12_fence.GetAddressOf())
+    ));
+
+    m_d3d12_fence_event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (!m_d3d12_fence_event) {
+        dlog::error("[PrimitiveRenderingModule] Failed to create fence event");
     }
 
+    create_swap_chain_resources(d3dmodule, sc3);
+
+    // Command List, recorded with the allocator of whichever frame context is current
+    HandleResult(d3dmodule->m_d3d12_device->CreateCommandList(
+        0,
+        D3D12_COMMAND_LIST_TYPE_DIRECT,
+        m_d3d12_frame_contexts[0].CommandAllocator.Get(),
+        m_d3d12_pipeline_state.Get(),
+        IID_PPV_ARGS(m_d3d12_command_list.GetAddressOf())
+    ));
+
+    HandleResult(m_d3d12_command_list->Close());
+
+    m_is_initialized = true;
+}
+
+void PrimitiveRenderingModule::create_swap_chain_resources(D3DModule* d3dmodule, IDXGISwapChain3* sc3) {
+    // The buffer count and size can change with every ResizeBuffers
+    DXGI_SWAP_CHAIN_DESC swap_chain_desc{};
+    HandleResult(sc3->GetDesc(&swap_chain_desc));
+
+    // Depth Stencil
     D3D12_RESOURCE_DESC texture_desc = CD3DX12_RESOURCE_DESC::Tex2D(
         DXGI_FORMAT_D24_UNORM_S8_UINT,
-        rect.right - rect.left,
-        rect.bottom - rect.top,
+        swap_chain_desc.BufferDesc.Width,
+        swap_chain_desc.BufferDesc.Height,
         1, 1, 1, 0,
         D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL
     );
@@ -1350,7 +1170,8 @@ void PrimitiveRenderingModule::late_init_d3d12(D3DModule* d3dmodule, IDXGISwapCh
     depth_clear_value.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
     depth_clear_value.DepthStencil.Depth = 1.0f;
     depth_clear_value.DepthStencil.Stencil = 0;
-    
+
+    m_d3d12_depth_stencil_texture.Reset();
     const auto default_heap_properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
     HandleResult(d3dmodule->m_d3d12_device->CreateCommittedResource(
         &default_heap_properties,
@@ -1367,39 +1188,22 @@ void PrimitiveRenderingModule::late_init_d3d12(D3DModule* d3dmodule, IDXGISwapCh
         m_d3d12_depth_stencil_view
     );
 
-    // Command Allocator
-    HandleResult(d3dmodule->m_d3d12_device->CreateCommandAllocator(
-        D3D12_COMMAND_LIST_TYPE_DIRECT,
-        IID_PPV_ARGS(m_d3d12_command_allocator.GetAddressOf())
-    ));
-
-    // Command List
-    HandleResult(d3dmodule->m_d3d12_device->CreateCommandList(
-        0,
-        D3D12_COMMAND_LIST_TYPE_DIRECT,
-        m_d3d12_command_allocator.Get(),
-        m_d3d12_pipeline_state.Get(),
-        IID_PPV_ARGS(m_d3d12_command_list.GetAddressOf())
-    ));
-
-    HandleResult(m_d3d12_command_list->Close());
-
     // Backbuffers
-    const u32 buffer_count = m_d3d12_back_buffer_count = swap_chain_desc.BufferCount;
+    m_d3d12_back_buffer_count = swap_chain_desc.BufferCount;
 
-    descriptor_heap_desc.NumDescriptors = buffer_count;
+    D3D12_DESCRIPTOR_HEAP_DESC descriptor_heap_desc{};
+    descriptor_heap_desc.NumDescriptors = m_d3d12_back_buffer_count;
     descriptor_heap_desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
     descriptor_heap_desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
     descriptor_heap_desc.NodeMask = 0;
 
+    m_d3d12_rtv_heap.Reset();
     HandleResult(d3dmodule->m_d3d12_device->CreateDescriptorHeap(
         &descriptor_heap_desc,
         IID_PPV_ARGS(m_d3d12_rtv_heap.GetAddressOf())
     ));
 
     create_frame_contexts(d3dmodule, sc3);
-
-    m_is_initialized = true;
 }
 
 void PrimitiveRenderingModule::create_frame_contexts(D3DModule* d3dmodule, IDXGISwapChain3* sc3) {
@@ -1422,43 +1226,267 @@ void PrimitiveRenderingModule::create_frame_contexts(D3DModule* d3dmodule, IDXGI
 
         m_d3d12_frame_contexts[i].RenderTargetDescriptor = rtv_handle;
         rtv_handle.ptr += rtv_descriptor_size;
+
+        HandleResult(d3dmodule->m_d3d12_device->CreateCommandAllocator(
+            D3D12_COMMAND_LIST_TYPE_DIRECT,
+            IID_PPV_ARGS(m_d3d12_frame_contexts[i].CommandAllocator.GetAddressOf())
+        ));
+
+        m_d3d12_frame_contexts[i].UploadRing.create(d3dmodule->m_d3d12_device, UPLOAD_RING_SIZE);
     }
 }
 
+void PrimitiveRenderingModule::wait_for_d3d12_fence(u64 value) {
+    if (!m_d3d12_fence || m_d3d12_fence->GetCompletedValue() >= value) {
+        return;
+    }
+
+    HandleResult(m_d3d12_fence->SetEventOnCompletion(value, m_d3d12_fence_event));
+    WaitForSingleObject(m_d3d12_fence_event, INFINITE);
+}
+
+Microsoft::WRL::ComPtr<ID3DBlob> PrimitiveRenderingModule::load_shader(const char* name, const char* target) {
+    ComPtr<ID3DBlob> blob;
+
+    const auto override_path = std::filesystem::path(config::SPL_SHADER_OVERRIDE_DIR) / std::format("{}.hlsl", name);
+    if (std::filesystem::exists(override_path)) {
+#ifdef _DEBUG
+        constexpr UINT compile_flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+        constexpr UINT compile_flags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+
+        ComPtr<ID3DBlob> errors;
+        const HRESULT result = D3DCompileFromFile(
+            override_path.c_str(),
+            nullptr,
+            D3D_COMPILE_STANDARD_FILE_INCLUDE,
+            "main",
+            target,
+            compile_flags,
+            0,
+            blob.GetAddressOf(),
+            errors.GetAddressOf()
+        );
+
+        if (SUCCEEDED(result)) {
+            dlog::debug("[PrimitiveRenderingModule] Compiled shader override {}", override_path.string());
+            return blob;
+        }
+
+        dlog::error("[PrimitiveRenderingModule] Failed to compile shader override {}, using the precompiled shader: {}",
+            override_path.string(), errors ? (const char*)errors->GetBufferPointer() : "unknown error");
+        blob.Reset();
+    }
+
+    const auto path = std::format("/Resources/{}.{}.cso", name, target);
+    const auto& chunk = NativePluginFramework::get_module<ChunkModule>()->request_chunk("Default");
+    const auto& file = chunk->get_file(path);
+    if (!file) {
+        throw std::runtime_error(std::format("Precompiled shader {} is missing from the chunk", path));
+    }
+
+    HandleResult(D3DCreateBlob(file->size(), blob.GetAddressOf()));
+    std::memcpy(blob->GetBufferPointer(), file->Contents.data(), file->size());
+
+    return blob;
+}
+
+PrimitiveRenderingModule::CpuMesh PrimitiveRenderingModule::load_meshes(MeshRanges& ranges) {
+    using primitive_batcher::MeshId;
+
+    CpuMesh meshes;
+    ranges = {};
+
+    // Indices stay relative to their own mesh, the draws offset them with BaseVertex
+    const auto append = [&](MeshId id, size_t lod, const CpuMesh& mesh) {
+        ranges[primitive_batcher::get_mesh_slot(id, lod)] = {
+            .IndexCount = (u32)mesh.Indices.size(),
+            .StartIndex = (u32)meshes.Indices.size(),
+            .BaseVertex = (i32)meshes.Vertices.size()
+        };
+
+        meshes.Vertices.insert(meshes.Vertices.end(), mesh.Vertices.begin(), mesh.Vertices.end());
+        meshes.Indices.insert(meshes.Indices.end(), mesh.Indices.begin(), mesh.Indices.end());
+    };
+
+    const auto sphere_lods = load_sphere_lods();
+    const auto top_lods = load_hemisphere_lods(true);
+    const auto bottom_lods = load_hemisphere_lods(false);
+    for (size_t lod = 0; lod < culling::LOD_COUNT; ++lod) {
+        append(MeshId::Sphere, lod, sphere_lods[lod]);
+        append(MeshId::HemisphereTop, lod, top_lods[lod]);
+        append(MeshId::HemisphereBottom, lod, bottom_lods[lod]);
+    }
+
+    // Cubes and cylinders are always drawn at LOD 0
+    append(MeshId::Cube, 0, load_mesh("/Resources/Cube.mesh"));
+    append(MeshId::Cylinder, 0, load_mesh("/Resources/Cylinder.mesh"));
+
+    return meshes;
+}
+
 PrimitiveRenderingModule::CpuMesh PrimitiveRenderingModule::load_mesh(const std::string& path) {
     CpuMesh mesh;
     const auto& chunk_module = NativePluginFramework::get_module<ChunkModule>();
     const auto& chunk = chunk_module->request_chunk("Default");
-    const auto& sphere = chunk->get_file(path);
+    const auto& file = chunk->get_file(path);
+    if (!file) {
+        throw std::runtime_error(std::format("Mesh {} is missing from the chunk", path));
+    }
+
+    mesh_format::View view;
+    if (!mesh_format::parse({ file->Contents.data(), file->size() }, view)) {
+        dlog::error("[PrimitiveRenderingModule] {} is not a valid mesh, rerun cook_meshes.py", path);
+        return mesh;
+    }
+
+    mesh.Vertices.resize(view.VertexCount);
+    mesh.Indices.resize(view.IndexCount);
+    std::memcpy(mesh.Vertices.data(), view.Vertices, view.VertexCount * sizeof(Vertex));
+    std::memcpy(mesh.Indices.data(), view.Indices, view.IndexCount * sizeof(Index));
+
+    return mesh;
+}
+
+std::array<PrimitiveRenderingModule::CpuMesh, culling::LOD_COUNT> PrimitiveRenderingModule::load_sphere_lods() {
+    // The authored icosphere has 3 subdivisions (1280 triangles), the lower levels have 320 and 80
+    return { load_mesh("/Resources/Sphere.mesh"), generate_icosphere(2), generate_icosphere(1) };
+}
+
+std::array<PrimitiveRenderingModule::CpuMesh, culling::LOD_COUNT> PrimitiveRenderingModule::load_hemisphere_lods(bool top) {
+    // The authored hemispheres have 32 segments and 8 rings (256 faces), the lower levels have 64 and 16 faces
+    return {
+        load_mesh(top ? "/Resources/Hemisphere.mesh" : "/Resources/BottomHemisphere.mesh"),
+        generate_hemisphere(16, 4, top),
+        generate_hemisphere(8, 2, top)
+    };
+}
+
+PrimitiveRenderingModule::CpuMesh PrimitiveRenderingModule::generate_icosphere(u32 subdivisions) {
+    using namespace DirectX;
+
+    std::vector<XMFLOAT3> positions;
+    std::vector<std::array<u32, 3>> triangles;
+
+    const auto add_vertex = [&](float x, float y, float z) {
+        XMStoreFloat3(&positions.emplace_back(), XMVector3Normalize(XMVectorSet(x, y, z, 0.0f)));
+        return (u32)positions.size() - 1;
+    };
+
+    // Icosahedron
+    const float t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+    for (const float a : { -1.0f, 1.0f }) {
+        for (const float b : { -t, t }) {
+            add_vertex(a, b, 0.0f);
+            add_vertex(0.0f, a, b);
+            add_vertex(b, 0.0f, a);
+        }
+    }
+
+    // The faces are the triples of vertices that are all an edge apart, edges have a length of 2 before normalizing
+    const float edge_length_squared = 4.0f;
+    for (u32 i = 0; i < positions.size(); ++i) {
+        for (u32 j = i + 1; j < positions.size(); ++j) {
+            for (u32 k = j + 1; k < positions.size(); ++k) {
+                const auto is_edge = [&](u32 a, u32 b) {
+                    const XMVECTOR d = XMVectorSubtract(XMLoadFloat3(&positions[a]), XMLoadFloat3(&positions[b]));
+                    return XMVectorGetX(XMVector3LengthSq(d)) * (1.0f + t * t) < edge_length_squared + 0.01f;
+                };
+
+                if (is_edge(i, j) && is_edge(j, k) && is_edge(i, k)) {
+                    triangles.push_back({ i, j, k });
+                }
+            }
+        }
+    }
+
+    for (u32 level = 0; level < subdivisions; ++level) {
+        std::unordered_map<u64, u32> midpoints;
+        const auto midpoint = [&](u32 a, u32 b) {
+            const u64 key = ((u64)(std::min)(a, b) << 32) | (std::max)(a, b);
+            if (const auto it = midpoints.find(key); it != midpoints.end()) {
+                return it->second;
+            }
 
-    std::istringstream obj_stream{ std::string{(const char*)sphere->Contents.data(), sphere->size()} };
+            const XMFLOAT3 pa = positions[a];
+            const XMFLOAT3 pb = positions[b];
+            const u32 index = add_vertex(pa.x + pb.x, pa.y + pb.y, pa.z + pb.z);
+            midpoints.emplace(key, index);
+            return index;
+        };
 
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::string warn, err;
+        std::vector<std::array<u32, 3>> subdivided;
+        subdivided.reserve(triangles.size() * 4);
+        for (const auto& [a, b, c] : triangles) {
+            const u32 ab = midpoint(a, b);
+            const u32 bc = midpoint(b, c);
+            const u32 ca = midpoint(c, a);
+            subdivided.push_back({ a, ab, ca });
+            subdivided.push_back({ b, bc, ab });
+            subdivided.push_back({ c, ca, bc });
+            subdivided.push_back({ ab, bc, ca });
+        }
 
-    if (!tinyobj::LoadObj(&attrib, &shapes, nullptr, &warn, &err, &obj_stream)) {
-        dlog::error("Failed to load obj file: {}", err);
+        triangles = std::move(subdivided);
     }
 
-    for (const auto& shape : shapes) {
-        for (const auto& index : shape.mesh.indices) {
+    CpuMesh mesh;
+    for (const auto& p : positions) {
+        mesh.Vertices.emplace_back(p.x, p.y, p.z, 1.0f);
+    }
+
+    for (const auto& triangle : triangles) {
+        for (const u32 index : triangle) {
+            mesh.Indices.push_back((Index)index);
+        }
+    }
+
+    return mesh;
+}
+
+PrimitiveRenderingModule::CpuMesh PrimitiveRenderingModule::generate_hemisphere(u32 segments, u32 rings, bool top) {
+    // Unit hemisphere around the Y axis without a cap, like the authored ones: a pole and `rings` rings
+    // down to the equator, the bottom hemisphere is the mirror image
+    constexpr float HALF_PI = DirectX::XM_PIDIV2;
+    const float sign = top ? 1.0f : -1.0f;
+
+    CpuMesh mesh;
+    mesh.Vertices.emplace_back(0.0f, sign, 0.0f, 1.0f);
+
+    for (u32 ring = 1; ring <= rings; ++ring) {
+        const float polar = HALF_PI * (float)ring / (float)rings;
+        for (u32 segment = 0; segment < segments; ++segment) {
+            const float azimuth = DirectX::XM_2PI * (float)segment / (float)segments;
             mesh.Vertices.emplace_back(
-                attrib.vertices[3 * index.vertex_index + 0],
-                attrib.vertices[3 * index.vertex_index + 1],
-                attrib.vertices[3 * index.vertex_index + 2],
+                std::sin(polar) * std::cos(azimuth),
+                std::cos(polar) * sign,
+                std::sin(polar) * std::sin(azimuth),
                 1.0f
             );
-            mesh.Indices.push_back((u32)mesh.Indices.size());
+        }
+    }
+
+    const auto ring_vertex = [&](u32 ring, u32 segment) { return (Index)(1 + (ring - 1) * segments + segment % segments); };
+
+    for (u32 segment = 0; segment < segments; ++segment) {
+        mesh.Indices.insert(mesh.Indices.end(), { (Index)0, ring_vertex(1, segment), ring_vertex(1, segment + 1) });
+    }
+
+    for (u32 ring = 1; ring < rings; ++ring) {
+        for (u32 segment = 0; segment < segments; ++segment) {
+            const Index a = ring_vertex(ring, segment);
+            const Index b = ring_vertex(ring, segment + 1);
+            const Index c = ring_vertex(ring + 1, segment);
+            const Index d = ring_vertex(ring + 1, segment + 1);
+            mesh.Indices.insert(mesh.Indices.end(), { a, c, b, b, c, d });
         }
     }
 
     return mesh;
 }
 
-void PrimitiveRenderingModule::load_mesh_d3d11(ID3D11Device* device, const std::string& path, Mesh11& out) {
-    const CpuMesh mesh = load_mesh(path);
-
+void PrimitiveRenderingModule::load_mesh_d3d11(ID3D11Device* device, const CpuMesh& mesh, Mesh11& out) {
     out.IndexCount = (u32)mesh.Indices.size();
 
     D3D11_BUFFER_DESC bd{};
@@ -1474,20 +1502,21 @@ void PrimitiveRenderingModule::load_mesh_d3d11(ID3D11Device* device, const std::
 
     HandleResult(device->CreateBuffer(&bd, &sd, out.VertexBuffer.GetAddressOf()));
 
-    bd.ByteWidth = sizeof(u32) * (u32)mesh.Indices.size();
+    bd.ByteWidth = sizeof(Index) * (u32)mesh.Indices.size();
     bd.Usage = D3D11_USAGE_DEFAULT;
     bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
     bd.CPUAccessFlags = 0;
-    bd.StructureByteStride = sizeof(u32);
+    bd.StructureByteStride = sizeof(Index);
 
     sd.pSysMem = mesh.Indices.data();
 
     HandleResult(device->CreateBuffer(&bd, &sd, out.IndexBuffer.GetAddressOf()));
-}
 
-void PrimitiveRenderingModule::load_mesh_d3d12(ID3D12Device* device, const std::string& path, Mesh12& out) {
-    const CpuMesh mesh = load_mesh(path);
+    out.Memory = memory_stats::TrackedBytes(memory_stats::Tag::Meshes,
+        sizeof(Vertex) * mesh.Vertices.size() + sizeof(Index) * mesh.Indices.size());
+}
 
+void PrimitiveRenderingModule::load_mesh_d3d12(ID3D12Device* device, const CpuMesh& mesh, Mesh12& out) {
     out.IndexCount = (u32)mesh.Indices.size();
 
     D3D12_HEAP_PROPERTIES heap_properties{};
@@ -1516,7 +1545,7 @@ void PrimitiveRenderingModule::load_mesh_d3d12(ID3D12Device* device, const std::
     std::memcpy(vertex_data, mesh.Vertices.data(), sizeof(Vertex) * mesh.Vertices.size());
     out.VertexBuffer->Unmap(0, nullptr);
 
-    resource_desc.Width = sizeof(u32) * mesh.Indices.size();
+    resource_desc.Width = sizeof(Index) * mesh.Indices.size();
 
     HandleResult(device->CreateCommittedResource(
         &heap_properties,
@@ -1527,9 +1556,9 @@ void PrimitiveRenderingModule::load_mesh_d3d12(ID3D12Device* device, const std::
         IID_PPV_ARGS(out.IndexBuffer.GetAddressOf())
     ));
 
-    u32* index_data = nullptr;
+    Index* index_data = nullptr;
     HandleResult(out.IndexBuffer->Map(0, nullptr, (void**)&index_data));
-    std::memcpy(index_data, mesh.Indices.data(), sizeof(u32) * mesh.Indices.size());
+    std::memcpy(index_data, mesh.Indices.data(), sizeof(Index) * mesh.Indices.size());
     out.IndexBuffer->Unmap(0, nullptr);
 
     out.VertexBufferView.BufferLocation = out.VertexBuffer->GetGPUVirtualAddress();
@@ -1537,6 +1566,9 @@ void PrimitiveRenderingModule::load_mesh_d3d12(ID3D12Device* device, const std::
     out.VertexBufferView.StrideInBytes = sizeof(Vertex);
 
     out.IndexBufferView.BufferLocation = out.IndexBuffer->GetGPUVirtualAddress();
-    out.IndexBufferView.SizeInBytes = sizeof(u32) * (u32)mesh.Indices.size();
-    out.IndexBufferView.Format = DXGI_FORMAT_R32_UINT;
+    out.IndexBufferView.SizeInBytes = sizeof(Index) * (u32)mesh.Indices.size();
+    out.IndexBufferView.Format = INDEX_FORMAT;
+
+    out.Memory = memory_stats::TrackedBytes(memory_stats::Tag::Meshes,
+        out.VertexBuffer->GetDesc().Width + out.IndexBuffer->GetDesc().Width);
 }
@@ -1,6 +1,14 @@
 #pragma once
 #include "NativeModule.h"
+#include "Culling.h"
+#include "InstanceBuilder.h"
+#include "JobPool.h"
+#include "LineBuilder.h"
+#include "MemoryStats.h"
+#include "MeshFormat.h"
+#include "PrimitiveBatcher.h"
 #include "Primitives.h"
+#include "UploadRing.h"
 
 #include <directxmath/DirectXMath.h>
 #include <d3d11.h>
@@ -9,19 +17,29 @@
 
 #include <array>
 #include <dxgi1_4.h>
+#include <optional>
 #include <span>
 #include <vector>
 
 struct sMhCamera;
 class D3DModule;
+class ChunkModule;
+class SingletonModule;
 
 class PrimitiveRenderingModule final : public NativeModule {
 public:
+    using Dependencies = ModuleList<D3DModule, ChunkModule, SingletonModule>;
+
     PrimitiveRenderingModule();
     void initialize(CoreClr* coreclr) override;
     void shutdown() override;
 
     void late_init(D3DModule* d3dmodule, IDXGISwapChain* swap_chain);
+    // False again after shutdown (e.g. when the swap chain is resized), late_init then recreates what was released
+    bool is_initialized() const { return m_is_initialized && m_is_ready; }
+
+    // The fence signaled after each frame of primitives, so D3DModule can tell it apart from the game's fences
+    ID3D12Fence* get_d3d12_fence() const { return m_d3d12_fence.Get(); }
 
     void render_sphere(const MtSphere& sphere, MtVector4 color);
     void render_obb(const MtOBB& obb, MtVector4 color);
@@ -34,10 +52,14 @@ public:
 private:
     template<typename T> using ComPtr = Microsoft::WRL::ComPtr<T>;
     using Vertex = MtVector4;
+    using Index = u16;
+    static constexpr DXGI_FORMAT INDEX_FORMAT = DXGI_FORMAT_R16_UINT;
+    static_assert(sizeof(Vertex) == mesh_format::VERTEX_SIZE && sizeof(Index) == mesh_format::INDEX_SIZE);
     struct Mesh11 {
         ComPtr<ID3D11Buffer> VertexBuffer = nullptr;
         ComPtr<ID3D11Buffer> IndexBuffer = nullptr;
         u32 IndexCount = 0;
+        memory_stats::TrackedBytes Memory;
     };
     struct Mesh12 {
         ComPtr<ID3D12Resource> VertexBuffer = nullptr;
@@ -45,34 +67,54 @@ private:
         u32 IndexCount = 0;
         D3D12_VERTEX_BUFFER_VIEW VertexBufferView{};
         D3D12_INDEX_BUFFER_VIEW IndexBufferView{};
+        memory_stats::TrackedBytes Memory;
     };
     struct CpuMesh {
-        std::vector<Vertex> Vertices;
-        std::vector<u32> Indices;
+        memory_stats::Vector<Vertex, memory_stats::Tag::Meshes> Vertices;
+        memory_stats::Vector<Index, memory_stats::Tag::Meshes> Indices;
     };
+    using MeshRanges = std::array<primitive_batcher::MeshRange, primitive_batcher::MESH_SLOT_COUNT>;
 
     void late_init_d3d11(D3DModule* d3dmodule);
     void late_init_d3d12(D3DModule* d3dmodule, IDXGISwapChain* swap_chain);
+    // (Re)creates everything that depends on the swap chain's buffers: the depth buffer, viewport, RTV heap and frame contexts
+    void create_swap_chain_resources(D3DModule* d3dmodule, IDXGISwapChain3* sc3);
     void create_frame_contexts(D3DModule* d3dmodule, IDXGISwapChain3* sc3);
-
+    void wait_for_d3d12_fence(u64 value);
+
+    // Fetches this frame's primitives from the managed side, returns false if there is nothing to draw
+    bool retrieve_primitives();
+    // Gathers the retrieved primitives into the instance builder, builds their instance data,
+    // batches it into one instance stream and packs the lines for the selected line path.
+    // The work is split across the job pool.
+    void build_instances();
+    // Removes the primitives outside the camera's frustum, farther than the max draw distance
+    // or smaller on screen than the min screen size from the gathered columns
+    void cull_primitives(const culling::Frustum& frustum);
+    // Selects the sphere and capsule LODs and groups the columns by them, so every LOD is one contiguous range
+    void sort_by_lod(const culling::Frustum& frustum);
+
+    // Loads the bytecode of a shader precompiled for `target` from the chunk. If <SPL_SHADER_OVERRIDE_DIR>/<name>.hlsl
+    // exists it is compiled at runtime instead, so shaders can be iterated on without rebuilding the chunk.
+    static ComPtr<ID3DBlob> load_shader(const char* name, const char* target);
+    // Loads every mesh and LOD into one mesh, `ranges` receives where each of them is in it
+    static CpuMesh load_meshes(MeshRanges& ranges);
+    // Loads a mesh cooked by cook_meshes.py from the chunk
     static CpuMesh load_mesh(const std::string& path);
-    static void load_mesh_d3d11(ID3D11Device* device, const std::string& path, Mesh11& out);
-    static void load_mesh_d3d12(ID3D12Device* device, const std::string& path, Mesh12& out);
-
-    static DirectX::XMMATRIX XMMatrixAdd(DirectX::FXMMATRIX M1, DirectX::CXMMATRIX M2) {
-        DirectX::XMMATRIX m;
-        m.r[0] = DirectX::XMVectorAdd(M1.r[0], M2.r[0]);
-        m.r[1] = DirectX::XMVectorAdd(M1.r[1], M2.r[1]);
-        m.r[2] = DirectX::XMVectorAdd(M1.r[2], M2.r[2]);
-        m.r[3] = DirectX::XMVectorAdd(M1.r[3], M2.r[3]);
-        return m;
-    }
+    // Level 0 is the authored mesh, the others are generated with less tessellation
+    static std::array<CpuMesh, culling::LOD_COUNT> load_sphere_lods();
+    static std::array<CpuMesh, culling::LOD_COUNT> load_hemisphere_lods(bool top);
+    static CpuMesh generate_icosphere(u32 subdivisions);
+    static CpuMesh generate_hemisphere(u32 segments, u32 rings, bool top);
+    static void load_mesh_d3d11(ID3D11Device* device, const CpuMesh& mesh, Mesh11& out);
+    static void load_mesh_d3d12(ID3D12Device* device, const CpuMesh& mesh, Mesh12& out);
 
 private:
     struct Instance {
         DirectX::XMMATRIX Transform;
         DirectX::XMFLOAT4 Color;
     };
+    static_assert(sizeof(Instance) == sizeof(instance_builder::InstanceData));
     struct ViewProj {
         DirectX::XMMATRIX View;
         DirectX::XMMATRIX Proj;
@@ -81,58 +123,82 @@ private:
         DirectX::XMMATRIX View;
         DirectX::XMMATRIX Proj;
     };
+    // Everything a frame writes to, one per back buffer so recording a frame never waits on the previous one
     struct FrameContext {
         ComPtr<ID3D12Resource> RenderTarget = nullptr;
         D3D12_CPU_DESCRIPTOR_HANDLE RenderTargetDescriptor = { 0 };
+        ComPtr<ID3D12CommandAllocator> CommandAllocator = nullptr;
+        UploadRing12 UploadRing; // Instances, line vertices and constant buffers
+        u64 FenceValue = 0;      // Reached once the GPU is done with the last frame recorded with this context
     };
     struct alignas(256) LineParams {
         float Thickness;
     };
-    struct LineVertex {
-        DirectX::XMFLOAT4 Position;
-        DirectX::XMFLOAT4 Color;
+    // Primitives drawn and culled in the last frame, shown in the options menu
+    struct CullingStats {
+        u32 Drawn;
+        u32 Culled;
     };
 
-    static constexpr u32 MAX_INSTANCES = 2048;
-    static constexpr u32 MAX_LINES = 2048;
+    // Where each LOD's instances start, the last entry is the instance count
+    using LodOffsets = std::array<size_t, culling::LOD_COUNT + 1>;
+
+    static std::span<const instance_builder::InstanceData> lod_range(
+        std::span<const instance_builder::InstanceData> instances, const LodOffsets& offsets, size_t lod) {
+        return instances.subspan(offsets[lod], offsets[lod + 1] - offsets[lod]);
+    }
+
+    // Projected size (fraction of the viewport height) a sphere or capsule needs to use LOD 0 and LOD 1
+    static constexpr culling::LodThresholds LOD_THRESHOLDS = { 0.1f, 0.025f };
+
+    // Size of the instance and line vertex upload rings, larger frames are drawn in several batches
+    static constexpr u32 UPLOAD_RING_SIZE = 4 * 1024 * 1024;
+    // Segments per draw of the vertex pulling line path, the size of its D3D11 segment buffer
+    static constexpr u32 LINE_SEGMENT_BATCH = 64 * 1024;
+    static_assert(LINE_SEGMENT_BATCH * sizeof(line_builder::Segment) <= UPLOAD_RING_SIZE);
 
     void(*m_retrieve_primitives)(
-        primitives::Sphere** spheres, size_t* sphere_count,
-        primitives::OBB** cubes, size_t* cube_count,
-        primitives::Capsule** capsules, size_t* capsule_count,
-        primitives::Line** lines, size_t* line_count) = nullptr;
+        primitives::Sphere*** spheres, size_t* sphere_count,
+        primitives::OBB*** cubes, size_t* cube_count,
+        primitives::Capsule*** capsules, size_t* capsule_count,
+        primitives::Line*** lines, size_t* line_count) = nullptr;
     void(*m_release_primitives)() = nullptr;
-    void*(*m_get_singleton)(const char* name) = nullptr;
     sMhCamera* m_camera = nullptr;
 
-    std::span<primitives::Sphere> m_spheres;
-    std::span<primitives::OBB> m_cubes;
-    std::span<primitives::Capsule> m_capsules;
-    std::span<primitives::Line> m_lines;
-
-    size_t m_sphere_count = 0;
-    size_t m_cube_count = 0;
-    size_t m_capsule_count = 0;
-    size_t m_line_count = 0;
-
-    std::array<Instance, MAX_INSTANCES> m_instances{};
-    std::array<Instance, MAX_INSTANCES> m_instances_hemisphere_top{};
-    std::array<Instance, MAX_INSTANCES> m_instances_hemisphere_bottom{};
+    primitives::ChunkedSpan<primitives::Sphere> m_spheres;
+    primitives::ChunkedSpan<primitives::OBB> m_cubes;
+    primitives::ChunkedSpan<primitives::Capsule> m_capsules;
+    primitives::ChunkedSpan<primitives::Line> m_lines;
+
+    instance_builder::InstanceBuilder m_instance_builder;
+    culling::LineColumns m_line_columns;
+    memory_stats::Vector<u8, memory_stats::Tag::Primitives> m_primitive_keys; // Visibility or LOD per primitive
+    struct {
+        instance_builder::SphereColumns Spheres;
+        instance_builder::CapsuleColumns Capsules;
+    } m_sort_scratch;
+    LodOffsets m_sphere_lods{};
+    LodOffsets m_capsule_lods{};
+    primitive_batcher::Batcher m_batcher;
+    MeshRanges m_mesh_ranges{}; // Where each mesh is in the shared mesh buffers
+    memory_stats::Vector<line_builder::Vertex, memory_stats::Tag::Primitives> m_line_vertices;
+    memory_stats::Vector<line_builder::Segment, memory_stats::Tag::Primitives> m_line_segments;
+    std::optional<JobPool> m_job_pool; // Started in late_init
 
     bool m_is_initialized = false;
+    bool m_is_ready = false;
     float m_line_thickness = 3.0f;
     bool m_draw_primitives_as_lines = true;
+    bool m_line_vertex_pulling = true; // Expand lines in the vertex shader instead of the geometry shader
+    bool m_culling_enabled = true;
+    float m_max_draw_distance = 0.0f; // 0 draws everything in the frustum
+    float m_min_screen_size = 0.0f;   // Fraction of the viewport height
+    CullingStats m_culling_stats{};
 
     #pragma region D3D11
 
-    Mesh11 m_d3d11_cylinder{};
-    Mesh11 m_d3d11_hemisphere_top{};
-    Mesh11 m_d3d11_hemisphere_bottom{};
-    Mesh11 m_d3d11_sphere{};
-    Mesh11 m_d3d11_cube{};
-    ComPtr<ID3D11Buffer> m_d3d11_htop_transform_buffer = nullptr;
-    ComPtr<ID3D11Buffer> m_d3d11_hbottom_transform_buffer = nullptr;
-    ComPtr<ID3D11Buffer> m_d3d11_transform_buffer = nullptr;
+    Mesh11 m_d3d11_meshes{};
+    UploadRing11 m_d3d11_upload_ring;
     ComPtr<ID3D11Buffer> m_d3d11_viewproj_buffer = nullptr;
     ComPtr<ID3D11VertexShader> m_d3d11_vertex_shader = nullptr;
     ComPtr<ID3D11PixelShader> m_d3d11_pixel_shader = nullptr;
@@ -143,48 +209,44 @@ private:
     ComPtr<ID3D11DepthStencilView> m_d3d11_depth_stencil_view = nullptr;
     ComPtr<ID3D11BlendState> m_d3d11_blend_state = nullptr;
 
-    ComPtr<ID3D11Buffer> m_d3d11_line_vertex_buffer = nullptr;
     ComPtr<ID3D11Buffer> m_d3d11_line_params_buffer = nullptr;
     ComPtr<ID3D11VertexShader> m_d3d11_line_vertex_shader = nullptr;
     ComPtr<ID3D11GeometryShader> m_d3d11_line_geometry_shader = nullptr;
     ComPtr<ID3D11PixelShader> m_d3d11_line_pixel_shader = nullptr;
     ComPtr<ID3D11InputLayout> m_d3d11_line_input_layout = nullptr;
 
+    ComPtr<ID3D11VertexShader> m_d3d11_line_pull_vertex_shader = nullptr;
+    ComPtr<ID3D11Buffer> m_d3d11_line_segment_buffer = nullptr;
+    ComPtr<ID3D11ShaderResourceView> m_d3d11_line_segment_srv = nullptr;
+    memory_stats::TrackedBytes m_d3d11_line_segment_memory;
+
     #pragma endregion
     #pragma region D3D12
 
-    Mesh12 m_d3d12_cylinder{};
-    Mesh12 m_d3d12_hemisphere_top{};
-    Mesh12 m_d3d12_hemisphere_bottom{};
-    Mesh12 m_d3d12_sphere{};
-    Mesh12 m_d3d12_cube{};
-    ComPtr<ID3D12Resource> m_d3d12_htop_transform_buffer = nullptr;
-    ComPtr<ID3D12Resource> m_d3d12_hbottom_transform_buffer = nullptr;
-    ComPtr<ID3D12Resource> m_d3d12_transform_buffer = nullptr;
-    ComPtr<ID3D12Resource> m_d3d12_viewproj_buffer = nullptr;
+    Mesh12 m_d3d12_meshes{};
     ComPtr<ID3D12Resource> m_d3d12_depth_stencil_texture = nullptr;
     ComPtr<ID3D12RootSignature> m_d3d12_root_signature = nullptr;
     ComPtr<ID3D12PipelineState> m_d3d12_pipeline_state = nullptr;
+    ComPtr<ID3D12CommandSignature> m_d3d12_draw_signature = nullptr; // Executes a pass's draws in one call
 
     ComPtr<ID3D12RootSignature> m_d3d12_line_root_signature = nullptr;
     ComPtr<ID3D12PipelineState> m_d3d12_line_pipeline_state = nullptr;
-    ComPtr<ID3D12Resource> m_d3d12_line_vertex_buffer = nullptr;
-    ComPtr<ID3D12Resource> m_d3d12_line_params_buffer = nullptr;
 
-    ComPtr<ID3D12CommandAllocator> m_d3d12_command_allocator = nullptr;
+    ComPtr<ID3D12RootSignature> m_d3d12_line_pull_root_signature = nullptr;
+    ComPtr<ID3D12PipelineState> m_d3d12_line_pull_pipeline_state = nullptr;
+
     ComPtr<ID3D12GraphicsCommandList> m_d3d12_command_list = nullptr;
     std::unique_ptr<FrameContext[]> m_d3d12_frame_contexts;
     u32 m_d3d12_back_buffer_count = 0;
+    ComPtr<ID3D12Fence> m_d3d12_fence = nullptr;
+    u64 m_d3d12_fence_value = 0;
+    HANDLE m_d3d12_fence_event = nullptr;
     ComPtr<ID3D12DescriptorHeap> m_d3d12_rtv_heap = nullptr;
     ComPtr<ID3D12DescriptorHeap> m_d3d12_dsv_heap = nullptr;
 
     D3D12_VIEWPORT m_d3d12_viewport{};
     D3D12_RECT m_d3d12_scissor_rect{};
     D3D12_CPU_DESCRIPTOR_HANDLE m_d3d12_depth_stencil_view = { 0 };
-    D3D12_VERTEX_BUFFER_VIEW m_d3d12_htop_transform_buffer_view{};
-    D3D12_VERTEX_BUFFER_VIEW m_d3d12_hbottom_transform_buffer_view{};
-    D3D12_VERTEX_BUFFER_VIEW m_d3d12_transform_buffer_view{};
-    D3D12_VERTEX_BUFFER_VIEW m_d3d12_line_vertex_buffer_view{};
 
     #pragma endregion
 };
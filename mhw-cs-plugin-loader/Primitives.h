@@ -2,8 +2,31 @@
 
 #include <dti/dti_types.h>
 
+#include <cstddef>
+
 namespace primitives {
 
+// View over the primitives of one type submitted by the managed side.
+// Mirrors SharpPluginLoader.Core.Rendering.PrimitiveBuffer, which stores them in fixed size chunks.
+template<typename T>
+class ChunkedSpan {
+public:
+    static constexpr size_t CHUNK_SHIFT = 12;
+    static constexpr size_t CHUNK_MASK = (1ull << CHUNK_SHIFT) - 1;
+
+    ChunkedSpan() = default;
+    ChunkedSpan(T** chunks, size_t count) : m_chunks(chunks), m_count(count) {}
+
+    const T& operator[](size_t index) const { return m_chunks[index >> CHUNK_SHIFT][index & CHUNK_MASK]; }
+
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+
+private:
+    T** m_chunks = nullptr;
+    size_t m_count = 0;
+};
+
 dti_size_assert(MtSphere, 0x10);
 struct Sphere {
     MtSphere sphere;
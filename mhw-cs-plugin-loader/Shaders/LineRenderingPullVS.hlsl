@@ -0,0 +1,52 @@
+
+struct Segment
+{
+	float3 P0;
+	uint Color;
+	float3 P1;
+	uint Padding;
+};
+
+struct VS_OUTPUT
+{
+	float4 Position : SV_POSITION;
+	float4 Color : COLOR;
+};
+
+cbuffer ViewProj : register(b0)
+{
+	matrix View;
+	matrix Proj;
+};
+
+cbuffer LineParams : register(b1)
+{
+	float LineWidth;
+};
+
+StructuredBuffer<Segment> Segments : register(t0);
+
+float4 unpack_color(uint color)
+{
+	return float4(color & 0xFF, (color >> 8) & 0xFF, (color >> 16) & 0xFF, color >> 24) / 255.0;
+}
+
+// Replaces LineRenderingVS + LineRenderingGS: every instance is one segment, drawn as a
+// 4 vertex triangle strip with the same vertices the geometry shader would emit
+VS_OUTPUT main(uint vertex_id : SV_VertexID, uint instance_id : SV_InstanceID)
+{
+	const Segment segment = Segments[instance_id];
+
+	const float4 p0 = mul(mul(float4(segment.P0, 1.0), View), Proj);
+	const float4 p1 = mul(mul(float4(segment.P1, 1.0), View), Proj);
+
+	const float2 dir = normalize(p1.xy - p0.xy);
+	const float2 normal = float2(-dir.y, dir.x);
+	const float4 offset = float4(normal * LineWidth, 0, 0);
+
+	// 0: p0 + offset, 1: p0 - offset, 2: p1 + offset, 3: p1 - offset
+	VS_OUTPUT output;
+	output.Position = ((vertex_id & 2) ? p1 : p0) + ((vertex_id & 1) ? -offset : offset);
+	output.Color = unpack_color(segment.Color);
+	return output;
+}
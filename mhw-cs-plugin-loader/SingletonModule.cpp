@@ -0,0 +1,41 @@
+#include "SingletonModule.h"
+#include "CoreClr.h"
+#include "Config.h"
+#include "Log.h"
+#include "NativePluginFramework.h"
+
+static constexpr std::array<const char*, (size_t)Singleton::Count> SINGLETON_NAMES = {
+    "sFacility",
+    "sMhGUI",
+    "sMhRender",
+    "sMhCamera"
+};
+
+void SingletonModule::initialize(CoreClr* coreclr) {
+    m_get_singleton = coreclr->get_method<void*(const char*)>(
+        config::SPL_CORE_ASSEMBLY_NAME,
+        L"SharpPluginLoader.Core.SingletonManager",
+        L"GetSingletonNative"
+    );
+
+    coreclr->add_internal_call<InternalCallId::NotifySingletonsChanged>(on_singletons_changed);
+}
+
+void SingletonModule::shutdown() {
+    for (auto& singleton : s_singletons) {
+        singleton.store(nullptr, std::memory_order_release);
+    }
+}
+
+void SingletonModule::refresh() {
+    for (size_t i = 0; i < SINGLETON_NAMES.size(); ++i) {
+        const auto instance = m_get_singleton(SINGLETON_NAMES[i]);
+        s_singletons[i].store(instance, std::memory_order_release);
+
+        dlog::debug("[SingletonModule] {} = {:p}", SINGLETON_NAMES[i], instance);
+    }
+}
+
+void SingletonModule::on_singletons_changed() {
+    NativePluginFramework::get_module<SingletonModule>()->refresh();
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "NativeModule.h"
+#include "SharpPluginLoader.h"
+
+#include <array>
+#include <atomic>
+
+// Singletons used by native code on hot paths. The value is the slot in the cache.
+enum class Singleton : u32 {
+    Facility,
+    MhGUI,
+    MhRender,
+    MhCamera,
+
+    Count
+};
+
+class SingletonModule final : public NativeModule {
+public:
+    void initialize(CoreClr* coreclr) override;
+    void shutdown() override;
+
+    // Returns the cached singleton instance, or nullptr if it hasn't been mapped yet.
+    // Doesn't transition into managed code.
+    static void* get(Singleton singleton) {
+        return s_singletons[(u32)singleton].load(std::memory_order_acquire);
+    }
+
+    template<class T>
+    static T* get(Singleton singleton) {
+        return (T*)get(singleton);
+    }
+
+    // Re-resolves all cached singletons through the managed SingletonManager.
+    void refresh();
+
+private:
+    // Called by the managed SingletonManager whenever its singleton map changes.
+    static void on_singletons_changed();
+
+private:
+    void*(*m_get_singleton)(const char* name) = nullptr;
+
+    static inline std::array<std::atomic<void*>, (size_t)Singleton::Count> s_singletons{};
+};
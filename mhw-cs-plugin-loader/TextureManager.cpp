@@ -1,6 +1,8 @@
 #include "TextureManager.h"
 #include "HResultHandler.h"
 
+#include <algorithm>
+
 TextureManager::TextureManager(ID3D12Device* device, ID3D12CommandQueue* cmd_queue, const ComPtr<ID3D12DescriptorHeap>& heap)
     : m_is_d3d12(true), m_device12(device), m_command_queue12(cmd_queue)
     , m_descriptor_heap12(std::make_unique<DirectX::DescriptorHeap>(heap.Get())) {}
@@ -65,6 +67,8 @@ TextureHandle TextureManager::load_texture(std::string_view path, u32* out_width
         handle = (TextureHandle)entry.Texture11.Get();
     }
 
+    entry.Memory = memory_stats::TrackedBytes(memory_stats::Tag::Textures, get_texture_size(entry));
+
     dlog::debug("Loaded texture: handle {}, path {}", handle, path);
 
     m_textures.emplace(handle, std::move(entry));
@@ -74,7 +78,7 @@ TextureHandle TextureManager::load_texture(std::string_view path, u32* out_width
 void TextureManager::unload_texture(TextureHandle handle) {
     const auto it = m_textures.find(handle);
     if (it == m_textures.end()) {
-        dlog::error("Failed to unload texture: handle {} does not exist", handle);
+        DLOG_ERROR_LIMITED("Failed to unload texture: handle {} does not exist", handle);
         return;
     }
 
@@ -88,9 +92,34 @@ void TextureManager::unload_texture(TextureHandle handle) {
     dlog::debug("Unloaded texture: handle {}", handle);
 }
 
+u64 TextureManager::get_texture_size(const TextureEntry& entry) const {
+    if (m_is_d3d12) {
+        const auto desc = entry.Texture12->GetDesc();
+        return m_device12->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
+    }
+
+    ComPtr<ID3D11Resource> resource;
+    ComPtr<ID3D11Texture2D> texture;
+    entry.Texture11->GetResource(resource.GetAddressOf());
+    if (FAILED(resource.As(&texture))) {
+        return 0;
+    }
+
+    // D3D11 has no way to query the allocation size, so assume 4 bytes per texel across the mip chain
+    D3D11_TEXTURE2D_DESC desc;
+    texture->GetDesc(&desc);
+
+    u64 size = 0;
+    for (u32 mip = 0; mip < (std::max)(desc.MipLevels, 1u); ++mip) {
+        size += (u64)(std::max)(desc.Width >> mip, 1u) * (std::max)(desc.Height >> mip, 1u) * 4;
+    }
+
+    return size * desc.ArraySize;
+}
+
 D3D12_GPU_DESCRIPTOR_HANDLE TextureManager::get_gpu_descriptor_handle(TextureEntry& entry) {
     if (m_next_descriptor_index >= DESCRIPTOR_HEAP_SIZE && m_free_descriptor_indices.empty()) {
-        dlog::error("Failed to get GPU descriptor handle: descriptor heap is full");
+        DLOG_ERROR_LIMITED("Failed to get GPU descriptor handle: descriptor heap is full");
         return { 0 };
     }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "SharpPluginLoader.h"
+#include "MemoryStats.h"
 
 #include <vector>
 #include <unordered_map>
@@ -23,6 +24,7 @@ class TextureManager {
         ComPtr<ID3D11ShaderResourceView> Texture11 = nullptr;
         ComPtr<ID3D12Resource> Texture12 = nullptr;
         u32 DescriptorIndex;
+        memory_stats::TrackedBytes Memory;
     };
 
 public:
@@ -46,6 +48,7 @@ private:
     static DXGI_FORMAT get_texture_format(const ComPtr<ID3D11Resource>& texture);
 
     D3D12_GPU_DESCRIPTOR_HANDLE get_gpu_descriptor_handle(TextureEntry& entry);
+    u64 get_texture_size(const TextureEntry& entry) const;
 
 private:
     bool m_is_d3d12;
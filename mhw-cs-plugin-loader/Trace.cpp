@@ -0,0 +1,131 @@
+#include "Trace.h"
+
+#include "Log.h"
+#include "MemoryStats.h"
+
+#include <Windows.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+
+namespace trace {
+namespace {
+
+std::atomic<bool> s_enabled = false;
+std::atomic<u32> s_next_span = 0;
+std::atomic<u32> s_dropped_spans = 0;
+
+std::array<Span, MAX_SPANS> s_spans{};
+// Set once a slot has been fully written, so finish() never reads a span that is still being recorded.
+std::array<std::atomic<bool>, MAX_SPANS> s_span_ready{};
+const memory_stats::TrackedBytes s_span_memory{ memory_stats::Tag::Logging, sizeof(s_spans) + sizeof(s_span_ready) };
+
+i64 query_frequency() {
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return frequency.QuadPart;
+}
+
+}
+
+void set_enabled(bool enabled) {
+    s_enabled.store(enabled, std::memory_order_release);
+}
+
+bool is_enabled() {
+    return s_enabled.load(std::memory_order_acquire);
+}
+
+i64 now() {
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+}
+
+void record(std::string_view name, const char* category, i64 start, i64 end) {
+    if (!is_enabled()) {
+        return;
+    }
+
+    const u32 index = s_next_span.fetch_add(1, std::memory_order_relaxed);
+    if (index >= MAX_SPANS) {
+        s_dropped_spans.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto& span = s_spans[index];
+    const size_t length = (std::min)(name.size(), MAX_SPAN_NAME_LENGTH - 1);
+    std::memcpy(span.Name, name.data(), length);
+    span.Name[length] = '\0';
+    span.Category = category;
+    span.Start = start;
+    span.End = end;
+    span.ThreadId = GetCurrentThreadId();
+
+    s_span_ready[index].store(true, std::memory_order_release);
+}
+
+void record_managed(const char* name, i64 start, i64 end) {
+    record(name ? name : "", "managed", start, end);
+}
+
+void finish(const std::filesystem::path& path) {
+    if (!s_enabled.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    const u32 count = (std::min)(s_next_span.load(std::memory_order_acquire), MAX_SPANS);
+    if (count == 0) {
+        return;
+    }
+
+    const double ticks_per_us = (double)query_frequency() / 1'000'000.0;
+    const u32 pid = GetCurrentProcessId();
+
+    i64 origin = INT64_MAX;
+    for (u32 i = 0; i < count; ++i) {
+        if (s_span_ready[i].load(std::memory_order_acquire)) {
+            origin = (std::min)(origin, s_spans[i].Start);
+        }
+    }
+
+    nlohmann::json events = nlohmann::json::array();
+    for (u32 i = 0; i < count; ++i) {
+        if (!s_span_ready[i].load(std::memory_order_acquire)) {
+            continue;
+        }
+
+        const auto& span = s_spans[i];
+        events.push_back({
+            {"name", span.Name},
+            {"cat", span.Category},
+            {"ph", "X"},
+            {"ts", (double)(span.Start - origin) / ticks_per_us},
+            {"dur", (double)(span.End - span.Start) / ticks_per_us},
+            {"pid", pid},
+            {"tid", span.ThreadId}
+        });
+    }
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        dlog::error("[Trace] Failed to open {} for writing", path.string());
+        return;
+    }
+
+    // Managed span names arrive as ANSI strings, replace anything that isn't valid UTF-8
+    const nlohmann::json document = { {"traceEvents", events}, {"displayTimeUnit", "ms"} };
+    file << document.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+    file.close();
+
+    dlog::info(
+        "[Trace] Wrote {} boot spans to {} ({} dropped)",
+        events.size(), path.string(), s_dropped_spans.load(std::memory_order_relaxed)
+    );
+}
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "SharpPluginLoader.h"
+
+#include <filesystem>
+#include <string_view>
+
+// Scoped-span tracer for the boot path. Spans are written into a preallocated buffer
+// (no allocations or locks while tracing) and exported as Chrome trace event JSON,
+// which can be opened in chrome://tracing or https://ui.perfetto.dev.
+namespace trace {
+
+constexpr u32 MAX_SPANS = 2048;
+constexpr size_t MAX_SPAN_NAME_LENGTH = 96;
+
+struct Span {
+    char Name[MAX_SPAN_NAME_LENGTH];
+    const char* Category;
+    i64 Start; // QueryPerformanceCounter ticks
+    i64 End;
+    u32 ThreadId;
+};
+
+// Tracing is disabled by default, spans recorded while disabled are discarded.
+void set_enabled(bool enabled);
+bool is_enabled();
+
+// Current timestamp in QueryPerformanceCounter ticks. These are the same ticks as
+// System.Diagnostics.Stopwatch.GetTimestamp() on the managed side.
+i64 now();
+
+// Records a finished span on the calling thread. Names longer than MAX_SPAN_NAME_LENGTH - 1 are truncated.
+void record(std::string_view name, const char* category, i64 start, i64 end);
+
+// Internal call used by the managed side to record its own spans.
+void record_managed(const char* name, i64 start, i64 end);
+
+// Writes all recorded spans to the given file and stops tracing.
+void finish(const std::filesystem::path& path);
+
+class ScopedSpan {
+public:
+    explicit ScopedSpan(std::string_view name, const char* category = "native")
+        : m_name(name), m_category(category), m_start(now()) {}
+
+    ~ScopedSpan() { end(); }
+
+    ScopedSpan(const ScopedSpan&) = delete;
+    ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+    // Ends the span before the end of the scope. Does nothing if it was already ended.
+    void end() {
+        if (!m_ended) {
+            m_ended = true;
+            record(m_name, m_category, m_start, now());
+        }
+    }
+
+private:
+    std::string_view m_name;
+    const char* m_category;
+    i64 m_start;
+    bool m_ended = false;
+};
+
+}
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+// Traces the rest of the enclosing scope. The name must outlive the scope.
+#define TRACE_SCOPE(...) ::trace::ScopedSpan TRACE_CONCAT(trace_span_, __LINE__){ __VA_ARGS__ }
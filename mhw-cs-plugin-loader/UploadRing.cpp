@@ -0,0 +1,119 @@
+#include "UploadRing.h"
+
+#include "HResultHandler.h"
+
+#include <cstring>
+
+void UploadRing11::create(ID3D11Device* device, u32 size, UINT bind_flags) {
+    D3D11_BUFFER_DESC bd{};
+    bd.ByteWidth = size;
+    bd.Usage = D3D11_USAGE_DYNAMIC;
+    bd.BindFlags = bind_flags;
+    bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+    HandleResult(device->CreateBuffer(&bd, nullptr, m_buffer.GetAddressOf()));
+
+    m_size = size;
+    m_cursor = size; // Discard on the first upload
+    m_memory = { memory_stats::Tag::Primitives, size };
+}
+
+u32 UploadRing11::upload(ID3D11DeviceContext* context, const void* data, u32 bytes) {
+    u32 offset = 0;
+    std::memcpy(map(context, bytes, offset), data, bytes);
+    unmap(context);
+
+    return offset;
+}
+
+void* UploadRing11::map(ID3D11DeviceContext* context, u32 bytes, u32& offset) {
+    // Vertex buffer offsets only need to be 4 byte aligned, 16 keeps the copies aligned
+    offset = (m_cursor + 15) & ~15u;
+    D3D11_MAP map_type = D3D11_MAP_WRITE_NO_OVERWRITE;
+
+    if (offset + bytes > m_size) {
+        offset = 0;
+        map_type = D3D11_MAP_WRITE_DISCARD;
+    }
+
+    D3D11_MAPPED_SUBRESOURCE msr{};
+    HandleResult(context->Map(m_buffer.Get(), 0, map_type, 0, &msr));
+
+    m_cursor = offset + bytes;
+    return (u8*)msr.pData + offset;
+}
+
+void UploadRing11::unmap(ID3D11DeviceContext* context) {
+    context->Unmap(m_buffer.Get(), 0);
+}
+
+void UploadRing12::create(ID3D12Device* device, u32 chunk_size) {
+    m_device = device;
+    m_chunk_size = chunk_size;
+    m_chunks.clear();
+    add_chunk();
+    reset();
+}
+
+void UploadRing12::reset() {
+    m_current = 0;
+    m_offset = 0;
+}
+
+UploadRing12::Allocation UploadRing12::allocate(u32 bytes, u32 alignment) {
+    u32 offset = (m_offset + alignment - 1) & ~(alignment - 1);
+
+    if (offset + bytes > m_chunk_size) {
+        if (++m_current == m_chunks.size()) {
+            add_chunk();
+        }
+
+        offset = 0;
+    }
+
+    const auto& chunk = m_chunks[m_current];
+    m_offset = offset + bytes;
+
+    return {
+        .Data = chunk.Data + offset,
+        .Address = chunk.Address + offset,
+        .Resource = chunk.Buffer.Get(),
+        .Offset = offset
+    };
+}
+
+void UploadRing12::add_chunk() {
+    D3D12_HEAP_PROPERTIES heap_properties{};
+    heap_properties.Type = D3D12_HEAP_TYPE_UPLOAD;
+    heap_properties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+    heap_properties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+
+    D3D12_RESOURCE_DESC resource_desc{};
+    resource_desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    resource_desc.Width = m_chunk_size;
+    resource_desc.Height = 1;
+    resource_desc.DepthOrArraySize = 1;
+    resource_desc.MipLevels = 1;
+    resource_desc.Format = DXGI_FORMAT_UNKNOWN;
+    resource_desc.SampleDesc.Count = 1;
+    resource_desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+    Chunk chunk;
+    HandleResult(m_device->CreateCommittedResource(
+        &heap_properties,
+        D3D12_HEAP_FLAG_NONE,
+        &resource_desc,
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(chunk.Buffer.GetAddressOf())
+    ));
+
+    // Upload heaps can stay mapped for their whole lifetime, the CPU never reads from them
+    const D3D12_RANGE read_range{ 0, 0 };
+    HandleResult(chunk.Buffer->Map(0, &read_range, (void**)&chunk.Data));
+
+    chunk.Address = chunk.Buffer->GetGPUVirtualAddress();
+    chunk.Memory = { memory_stats::Tag::Primitives, m_chunk_size };
+
+    m_chunks.push_back(std::move(chunk));
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "MemoryStats.h"
+#include "SharpPluginLoader.h"
+
+#include <d3d11.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+
+#include <vector>
+
+// Per-frame upload memory for dynamic vertex data. Uploads are sub-allocated from large buffers
+// instead of mapping a dedicated buffer per draw, so any amount of data can be uploaded without
+// recreating buffers. A single upload is limited to the capacity of the ring, callers split
+// larger batches into several uploads (and draws).
+
+// A dynamic D3D11 buffer written with D3D11_MAP_WRITE_NO_OVERWRITE. When the ring is full,
+// the next upload discards it and starts over, which lets the driver hand out fresh memory.
+class UploadRing11 {
+public:
+    void create(ID3D11Device* device, u32 size, UINT bind_flags);
+
+    // Copies `bytes` from `data` into the ring and returns the offset they were written at.
+    // `bytes` must not exceed capacity().
+    u32 upload(ID3D11DeviceContext* context, const void* data, u32 bytes);
+
+    // Like upload, but returns the mapped memory to write the `bytes` to, call unmap once written
+    void* map(ID3D11DeviceContext* context, u32 bytes, u32& offset);
+    void unmap(ID3D11DeviceContext* context);
+
+    ID3D11Buffer* buffer() const { return m_buffer.Get(); }
+    u32 capacity() const { return m_size; }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D11Buffer> m_buffer;
+    u32 m_size = 0;
+    u32 m_cursor = 0;
+    memory_stats::TrackedBytes m_memory;
+};
+
+// Persistently mapped D3D12 upload heap chunks, allocated linearly from the start every frame.
+// When a chunk fills the next one is used, a new chunk is only created once the frame needs more
+// memory than any frame before it. Chunks are kept for later frames.
+class UploadRing12 {
+public:
+    struct Allocation {
+        void* Data = nullptr;
+        D3D12_GPU_VIRTUAL_ADDRESS Address = 0;
+        ID3D12Resource* Resource = nullptr; // For the calls taking a resource and offset instead of an address
+        u64 Offset = 0;
+    };
+
+    void create(ID3D12Device* device, u32 chunk_size);
+
+    // Starts a new frame, everything allocated before must no longer be in use by the GPU
+    void reset();
+
+    // `bytes` must not exceed capacity()
+    Allocation allocate(u32 bytes, u32 alignment = 16);
+
+    u32 capacity() const { return m_chunk_size; }
+
+private:
+    struct Chunk {
+        Microsoft::WRL::ComPtr<ID3D12Resource> Buffer;
+        u8* Data = nullptr;
+        D3D12_GPU_VIRTUAL_ADDRESS Address = 0;
+        memory_stats::TrackedBytes Memory;
+    };
+
+    void add_chunk();
+
+    Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+    std::vector<Chunk> m_chunks;
+    size_t m_current = 0;
+    u32 m_offset = 0;
+    u32 m_chunk_size = 0;
+};
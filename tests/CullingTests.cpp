@@ -0,0 +1,383 @@
+#include "Culling.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace culling;
+using namespace instance_builder;
+
+namespace {
+
+constexpr size_t COUNTS[] = { 0, 1, 3, 4, 5, 7, 8, 9, 17, 100 };
+
+constexpr Settings SETTINGS[] = {
+    { 0.0f, 0.0f },
+    { 50.0f, 0.0f },
+    { 0.0f, 0.05f },
+    { 50.0f, 0.05f },
+};
+
+// Left-handed perspective projection (D3DXMatrixPerspectiveFovLH), row-major
+void perspective(f32 fov_y, f32 aspect, f32 near_z, f32 far_z, f32 out[16]) {
+    const f32 y_scale = 1.0f / std::tan(fov_y * 0.5f);
+    const f32 range = far_z / (far_z - near_z);
+    const f32 proj[16] = {
+        y_scale / aspect, 0, 0, 0,
+        0, y_scale, 0, 0,
+        0, 0, range, 1,
+        0, 0, -near_z * range, 0
+    };
+    std::copy(std::begin(proj), std::end(proj), out);
+}
+
+// View matrix of a camera at `eye` whose x, y and z axes are right, up and forward
+void look_to(const f32 eye[3], const f32 right[3], const f32 up[3], const f32 forward[3], f32 out[16]) {
+    const f32* axes[3] = { right, up, forward };
+    for (size_t row = 0; row < 3; ++row) {
+        for (size_t col = 0; col < 3; ++col) {
+            out[row * 4 + col] = axes[col][row];
+        }
+
+        out[row * 4 + 3] = 0.0f;
+    }
+
+    for (size_t col = 0; col < 3; ++col) {
+        out[12 + col] = -(eye[0] * axes[col][0] + eye[1] * axes[col][1] + eye[2] * axes[col][2]);
+    }
+
+    out[15] = 1.0f;
+}
+
+// Camera at (0, 0, -10) looking down +Z with a 90 degree square frustum, near 1 and far 100
+Frustum default_frustum(const Settings& settings = {}) {
+    const f32 eye[3] = { 0, 0, -10 };
+    const f32 right[3] = { 1, 0, 0 };
+    const f32 up[3] = { 0, 1, 0 };
+    const f32 forward[3] = { 0, 0, 1 };
+
+    f32 view[16], proj[16];
+    look_to(eye, right, up, forward, view);
+    perspective(3.14159265f * 0.5f, 1.0f, 1.0f, 100.0f, proj);
+    return extract_frustum(view, proj, settings);
+}
+
+f32 plane_distance(const f32 plane[4], f32 x, f32 y, f32 z) {
+    return plane[0] * x + plane[1] * y + plane[2] * z + plane[3];
+}
+
+template<size_t N>
+void fill_random(Columns<N>& columns, size_t count, std::mt19937& rng) {
+    // Around the default frustum, so a good part of everything straddles a plane
+    std::uniform_real_distribution<f32> dist(-60.0f, 60.0f);
+    columns.resize(count);
+    for (auto& column : columns.Data) {
+        for (auto& value : column) {
+            value = dist(rng);
+        }
+    }
+}
+
+void randomize_radii(f32* radii, size_t count, std::mt19937& rng) {
+    std::uniform_real_distribution<f32> dist(0.0f, 8.0f);
+    for (size_t i = 0; i < count; ++i) {
+        radii[i] = dist(rng);
+    }
+}
+
+template<typename TColumns, typename Cull>
+void expect_sse_matches_scalar(TColumns& columns, Cull&& cull) {
+    for (const auto& settings : SETTINGS) {
+        const Frustum frustum = default_frustum(settings);
+        for (const size_t begin : { (size_t)0, (std::min)(columns.Count, (size_t)3) }) {
+            std::vector<u8> expected(columns.Count, 0xFF), actual(columns.Count, 0xFF);
+            cull(frustum, columns, begin, columns.Count, expected.data(), Isa::Scalar);
+            cull(frustum, columns, begin, columns.Count, actual.data(), Isa::Sse);
+            ASSERT_EQ(expected, actual) << "count " << columns.Count << ", begin " << begin
+                << ", max distance " << settings.MaxDistance << ", min screen size " << settings.MinScreenSize;
+
+            // Indices before begin are left alone
+            for (size_t i = 0; i < begin; ++i) {
+                ASSERT_EQ(actual[i], 0xFF);
+            }
+        }
+    }
+}
+
+struct Culled {
+    SphereColumns Spheres;
+    CapsuleColumns Capsules;
+    LineColumns Lines;
+
+    u8 sphere(const Frustum& f, f32 x, f32 y, f32 z, f32 r, Isa isa = Isa::Scalar) {
+        Spheres.resize(1);
+        Spheres[sphere::X][0] = x;
+        Spheres[sphere::Y][0] = y;
+        Spheres[sphere::Z][0] = z;
+        Spheres[sphere::Radius][0] = r;
+
+        u8 visible = 0xFF;
+        cull_spheres(f, Spheres, 0, 1, &visible, isa);
+        return visible;
+    }
+
+    // Four copies, so the SSE path runs a full batch instead of falling back to the scalar tail
+    u8 capsule(const Frustum& f, const f32 (&p0)[3], const f32 (&p1)[3], f32 r, Isa isa = Isa::Scalar) {
+        Capsules.resize(4);
+        for (size_t i = 0; i < 4; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                Capsules[capsule::P0X + j][i] = p0[j];
+                Capsules[capsule::P1X + j][i] = p1[j];
+            }
+
+            Capsules[capsule::Radius][i] = r;
+        }
+
+        u8 visible[4];
+        cull_capsules(f, Capsules, 0, 4, visible, isa);
+        EXPECT_TRUE(visible[0] == visible[1] && visible[0] == visible[2] && visible[0] == visible[3]);
+        return visible[0];
+    }
+
+    u8 line(const Frustum& f, const f32 (&p0)[3], const f32 (&p1)[3], Isa isa = Isa::Scalar) {
+        Lines.resize(4);
+        for (size_t i = 0; i < 4; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                Lines[line::P0X + j][i] = p0[j];
+                Lines[line::P1X + j][i] = p1[j];
+            }
+        }
+
+        u8 visible[4];
+        cull_lines(f, Lines, 0, 4, visible, isa);
+        return visible[0];
+    }
+};
+
+}
+
+TEST(Culling, ExtractFrustumKnownPlanes) {
+    const Frustum f = default_frustum({ 20.0f, 0.1f });
+
+    // clip = (x, y, z * a + (10 a + b), z + 10) with a = 100/99, b = -100/99
+    const f32 s = 1.0f / std::sqrt(2.0f);
+    const f32 expected[Frustum::PLANE_COUNT][4] = {
+        { s, 0, s, 10 * s },  // Left, x >= -w
+        { -s, 0, s, 10 * s }, // Right, x <= w
+        { 0, s, s, 10 * s },  // Bottom, y >= -w
+        { 0, -s, s, 10 * s }, // Top, y <= w
+        { 0, 0, 1, 9 },       // Near, view depth >= 1
+    };
+
+    for (size_t i = 0; i < Frustum::PLANE_COUNT; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            EXPECT_NEAR(f.Planes[i][j], expected[i][j], 1e-5f) << "plane " << i << ", element " << j;
+        }
+    }
+
+    const f32 clip_w[4] = { 0, 0, 1, 10 };
+    for (size_t j = 0; j < 4; ++j) {
+        EXPECT_NEAR(f.ClipW[j], clip_w[j], 1e-6f);
+    }
+
+    EXPECT_NEAR(f.Eye[0], 0.0f, 1e-6f);
+    EXPECT_NEAR(f.Eye[1], 0.0f, 1e-6f);
+    EXPECT_NEAR(f.Eye[2], -10.0f, 1e-6f);
+    EXPECT_NEAR(f.ScreenScale, 1.0f, 1e-6f);
+    EXPECT_EQ(f.MaxDistance, 20.0f);
+    EXPECT_EQ(f.MinScreenSize, 0.1f);
+}
+
+TEST(Culling, ExtractFrustumRotatedCamera) {
+    // Looking down -X from (5, 2, 3), 60 degree vertical fov and 16:9
+    const f32 eye[3] = { 5, 2, 3 };
+    const f32 right[3] = { 0, 0, 1 };
+    const f32 up[3] = { 0, 1, 0 };
+    const f32 forward[3] = { -1, 0, 0 };
+
+    f32 view[16], proj[16];
+    look_to(eye, right, up, forward, view);
+    perspective(3.14159265f / 3.0f, 16.0f / 9.0f, 0.5f, 1000.0f, proj);
+    const Frustum f = extract_frustum(view, proj, {});
+
+    for (size_t j = 0; j < 3; ++j) {
+        EXPECT_NEAR(f.Eye[j], eye[j], 1e-5f);
+    }
+
+    // Every plane passes through the eye except the near plane, which sits 0.5 in front of it
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_NEAR(plane_distance(f.Planes[i], eye[0], eye[1], eye[2]), 0.0f, 1e-4f) << "plane " << i;
+    }
+    EXPECT_NEAR(plane_distance(f.Planes[4], eye[0], eye[1], eye[2]), -0.5f, 1e-4f);
+    EXPECT_NEAR(plane_distance(f.ClipW, -5, 2, 3), 10.0f, 1e-4f);
+
+    // Ahead is inside, behind and off to the side are not
+    Culled culled;
+    EXPECT_EQ(culled.sphere(f, -5, 2, 3, 0.1f), 1);
+    EXPECT_EQ(culled.sphere(f, 15, 2, 3, 0.1f), 0);
+    EXPECT_EQ(culled.sphere(f, -5, 2, 30, 0.1f), 0);
+    EXPECT_EQ(culled.sphere(f, -5, 20, 3, 0.1f), 0);
+}
+
+TEST(Culling, SpheresMatchScalar) {
+    std::mt19937 rng(1);
+    for (const size_t count : COUNTS) {
+        SphereColumns spheres;
+        fill_random(spheres, count, rng);
+        randomize_radii(spheres[sphere::Radius], count, rng);
+        expect_sse_matches_scalar(spheres, cull_spheres);
+    }
+}
+
+TEST(Culling, ObbsMatchScalar) {
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<f32> angle(0.0f, 6.2831853f);
+    std::uniform_real_distribution<f32> extent(0.0f, 8.0f);
+
+    for (const size_t count : COUNTS) {
+        ObbColumns obbs;
+        fill_random(obbs, count, rng);
+
+        // Rotation about Y with random extents, the translation stays random
+        for (size_t i = 0; i < count; ++i) {
+            const f32 c = std::cos(angle(rng));
+            const f32 s = std::sin(angle(rng));
+            const f32 rotation[12] = { c, 0, -s, 0, 0, 1, 0, 0, s, 0, c, 0 };
+            for (size_t j = 0; j < 12; ++j) {
+                obbs[obb::Coord + j][i] = rotation[j];
+            }
+
+            obbs[obb::Coord + 15][i] = 1.0f;
+            for (size_t axis = 0; axis < 3; ++axis) {
+                obbs[obb::ExtentX + axis][i] = extent(rng);
+            }
+        }
+
+        expect_sse_matches_scalar(obbs, cull_obbs);
+    }
+}
+
+TEST(Culling, CapsulesMatchScalar) {
+    std::mt19937 rng(3);
+    for (const size_t count : COUNTS) {
+        CapsuleColumns capsules;
+        fill_random(capsules, count, rng);
+        randomize_radii(capsules[capsule::Radius], count, rng);
+
+        // Every third one collapsed to a point
+        for (size_t i = 0; i < count; i += 3) {
+            for (size_t j = 0; j < 3; ++j) {
+                capsules[capsule::P1X + j][i] = capsules[capsule::P0X + j][i];
+            }
+        }
+
+        expect_sse_matches_scalar(capsules, cull_capsules);
+    }
+}
+
+TEST(Culling, LinesMatchScalar) {
+    std::mt19937 rng(4);
+    for (const size_t count : COUNTS) {
+        LineColumns lines;
+        fill_random(lines, count, rng);
+
+        for (size_t i = 0; i < count; i += 3) {
+            for (size_t j = 0; j < 3; ++j) {
+                lines[line::P1X + j][i] = lines[line::P0X + j][i];
+            }
+        }
+
+        expect_sse_matches_scalar(lines, cull_lines);
+    }
+}
+
+TEST(Culling, DegenerateSegments) {
+    const Frustum f = default_frustum({ 50.0f, 0.05f });
+    Culled culled;
+
+    for (const Isa isa : { Isa::Scalar, Isa::Sse }) {
+        // Zero length capsules behave like spheres
+        EXPECT_EQ(culled.capsule(f, { 0, 0, 10 }, { 0, 0, 10 }, 2.0f, isa), 1) << get_isa_name(isa);
+        EXPECT_EQ(culled.capsule(f, { 0, 0, -20 }, { 0, 0, -20 }, 2.0f, isa), 0) << get_isa_name(isa);
+        EXPECT_EQ(culled.capsule(f, { 0, 0, 10 }, { 0, 0, 10 }, 0.0f, isa), 0) << get_isa_name(isa);
+
+        // Zero length lines are kept while in view, lines are not culled by their size
+        EXPECT_EQ(culled.line(f, { 1, 1, 10 }, { 1, 1, 10 }, isa), 1) << get_isa_name(isa);
+        EXPECT_EQ(culled.line(f, { 100, 1, 10 }, { 100, 1, 10 }, isa), 0) << get_isa_name(isa);
+
+        // Both ends outside different planes, the segment crosses the view and is kept
+        EXPECT_EQ(culled.line(f, { -40, 0, 10 }, { 40, 0, 10 }, isa), 1) << get_isa_name(isa);
+        // Both ends behind the near plane
+        EXPECT_EQ(culled.line(f, { -1, 0, -15 }, { 1, 0, -12 }, isa), 0) << get_isa_name(isa);
+    }
+}
+
+TEST(Culling, MaxDistance) {
+    const Frustum f = default_frustum({ 50.0f, 0.0f });
+    Culled culled;
+
+    for (const Isa isa : { Isa::Scalar, Isa::Sse }) {
+        // The eye is at z = -10
+        EXPECT_EQ(culled.sphere(f, 0, 0, 30, 1.0f, isa), 1) << get_isa_name(isa);
+        EXPECT_EQ(culled.sphere(f, 0, 0, 50, 1.0f, isa), 0) << get_isa_name(isa);
+        // Reaches into range with its radius
+        EXPECT_EQ(culled.sphere(f, 0, 0, 45, 6.0f, isa), 1) << get_isa_name(isa);
+
+        // The closest point of the capsule counts, not its ends or center
+        EXPECT_EQ(culled.capsule(f, { 0, 0, 30 }, { 0, 0, 90 }, 0.5f, isa), 1) << get_isa_name(isa);
+        EXPECT_EQ(culled.capsule(f, { 0, 0, 45 }, { 0, 0, 90 }, 0.5f, isa), 0) << get_isa_name(isa);
+        EXPECT_EQ(culled.line(f, { 0, 0, 30 }, { 0, 0, 90 }, isa), 1) << get_isa_name(isa);
+        EXPECT_EQ(culled.line(f, { 0, 0, 45 }, { 0, 0, 90 }, isa), 0) << get_isa_name(isa);
+    }
+
+    // 0 disables the test
+    const Frustum unlimited = default_frustum();
+    EXPECT_EQ(culled.sphere(unlimited, 0, 0, 80, 1.0f), 1);
+}
+
+TEST(Culling, ScreenSize) {
+    Culled culled;
+
+    for (const Isa isa : { Isa::Scalar, Isa::Sse }) {
+        // A radius of 1 at a view depth of 10 covers 0.1 of the viewport height
+        EXPECT_EQ(culled.sphere(default_frustum({ 0.0f, 0.05f }), 0, 0, 0, 1.0f, isa), 1) << get_isa_name(isa);
+        EXPECT_EQ(culled.sphere(default_frustum({ 0.0f, 0.2f }), 0, 0, 0, 1.0f, isa), 0) << get_isa_name(isa);
+
+        // The camera is inside, so it covers the screen no matter the threshold
+        EXPECT_EQ(culled.sphere(default_frustum({ 0.0f, 10.0f }), 0, 0, -9, 5.0f, isa), 1) << get_isa_name(isa);
+
+        // Capsules use their bounding sphere, a radius of 0.5 plus half the length of 1
+        EXPECT_EQ(culled.capsule(default_frustum({ 0.0f, 0.05f }), { -0.5f, 0, 0 }, { 0.5f, 0, 0 }, 0.5f, isa), 1) << get_isa_name(isa);
+        EXPECT_EQ(culled.capsule(default_frustum({ 0.0f, 0.2f }), { -0.5f, 0, 0 }, { 0.5f, 0, 0 }, 0.5f, isa), 0) << get_isa_name(isa);
+
+        EXPECT_EQ(culled.line(default_frustum({ 0.0f, 10.0f }), { 0, 0, 50 }, { 0, 0.01f, 50 }, isa), 1) << get_isa_name(isa);
+    }
+}
+
+TEST(Culling, SelectLods) {
+    const Frustum f = default_frustum();
+    const LodThresholds thresholds = { 0.2f, 0.05f };
+
+    SphereColumns spheres;
+    spheres.resize(4);
+    const f32 positions[4][4] = {
+        { 0, 0, 0, 3.0f },  // 0.3
+        { 0, 0, 0, 1.0f },  // 0.1
+        { 0, 0, 0, 0.1f },  // 0.01
+        { 0, 0, -9, 2.0f }, // Camera inside
+    };
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            spheres[j][i] = positions[i][j];
+        }
+    }
+
+    u8 lods[4];
+    select_sphere_lods(f, spheres, 0, 4, thresholds, lods);
+    EXPECT_EQ(lods[0], 0);
+    EXPECT_EQ(lods[1], 1);
+    EXPECT_EQ(lods[2], 2);
+    EXPECT_EQ(lods[3], 0);
+}
@@ -0,0 +1,72 @@
+#include "InstanceBuilder.h"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+using namespace instance_builder;
+
+namespace {
+
+void fill(InstanceBuilder& builder, size_t count) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<f32> dist(-100.0f, 100.0f);
+
+    builder.resize(count, count, count);
+    for (auto& column : builder.spheres().Data) {
+        for (auto& value : column) value = dist(rng);
+    }
+    for (auto& column : builder.obbs().Data) {
+        for (auto& value : column) value = dist(rng);
+    }
+    for (auto& column : builder.capsules().Data) {
+        for (auto& value : column) value = dist(rng);
+    }
+}
+
+bool supported(Isa isa) {
+    return isa <= detect_isa();
+}
+
+template<typename Build>
+void run(benchmark::State& state, Isa isa, Build&& build) {
+    if (!supported(isa)) {
+        state.SkipWithError("Instruction set not supported");
+        return;
+    }
+
+    const auto count = (size_t)state.range(0);
+    InstanceBuilder builder(isa);
+    fill(builder, count);
+
+    for (auto _ : state) {
+        build(builder, count);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed((int64_t)(state.iterations() * count));
+    state.SetLabel(get_isa_name(isa));
+}
+
+void spheres(benchmark::State& state, Isa isa) {
+    run(state, isa, [](InstanceBuilder& builder, size_t count) { builder.build_spheres(0, count); });
+}
+
+void obbs(benchmark::State& state, Isa isa) {
+    run(state, isa, [](InstanceBuilder& builder, size_t count) { builder.build_obbs(0, count); });
+}
+
+void capsules(benchmark::State& state, Isa isa) {
+    run(state, isa, [](InstanceBuilder& builder, size_t count) { builder.build_capsules(0, count); });
+}
+
+}
+
+#define SPL_INSTANCE_BENCHMARK(fn)                                                          \
+    BENCHMARK_CAPTURE(fn, Scalar, Isa::Scalar)->Arg(10000)->Arg(30000)->Arg(100000); \
+    BENCHMARK_CAPTURE(fn, Sse, Isa::Sse)->Arg(10000)->Arg(30000)->Arg(100000);       \
+    BENCHMARK_CAPTURE(fn, Avx, Isa::Avx)->Arg(10000)->Arg(30000)->Arg(100000)
+
+SPL_INSTANCE_BENCHMARK(spheres);
+SPL_INSTANCE_BENCHMARK(obbs);
+SPL_INSTANCE_BENCHMARK(capsules);
@@ -0,0 +1,225 @@
+#include "InstanceBuilder.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace instance_builder;
+
+namespace {
+
+// Counts around the SSE (4) and AVX (8) widths, so every kernel hits its tail
+constexpr size_t COUNTS[] = { 0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 100 };
+
+std::vector<Isa> simd_isas() {
+    std::vector<Isa> isas;
+    const Isa best = detect_isa();
+    if (best == Isa::Sse || best == Isa::Avx) {
+        isas.push_back(Isa::Sse);
+    }
+    if (best == Isa::Avx) {
+        isas.push_back(Isa::Avx);
+    }
+
+    return isas;
+}
+
+void expect_same(const std::vector<InstanceData>& expected, const std::vector<InstanceData>& actual, Isa isa) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        for (size_t j = 0; j < 16; ++j) {
+            // The kernels do the same operations in the same order, they only differ in rounding of 1/x
+            const f32 tolerance = 1e-5f * (std::max)(1.0f, std::abs(expected[i].Transform[j]));
+            EXPECT_NEAR(expected[i].Transform[j], actual[i].Transform[j], tolerance)
+                << get_isa_name(isa) << ", instance " << i << ", element " << j;
+        }
+
+        EXPECT_EQ(expected[i].Color.R, actual[i].Color.R);
+        EXPECT_EQ(expected[i].Color.G, actual[i].Color.G);
+        EXPECT_EQ(expected[i].Color.B, actual[i].Color.B);
+        EXPECT_EQ(expected[i].Color.A, actual[i].Color.A);
+    }
+}
+
+template<size_t N>
+void fill_random(Columns<N>& columns, size_t count, std::mt19937& rng, f32 min, f32 max) {
+    std::uniform_real_distribution<f32> dist(min, max);
+    columns.resize(count);
+    for (auto& column : columns.Data) {
+        for (auto& value : column) {
+            value = dist(rng);
+        }
+    }
+
+    for (auto& color : columns.Colors) {
+        color = { dist(rng), dist(rng), dist(rng), dist(rng) };
+    }
+}
+
+void set_capsule(CapsuleColumns& capsules, size_t i, const f32 (&p0)[3], const f32 (&p1)[3], f32 radius) {
+    capsules[capsule::P0X][i] = p0[0];
+    capsules[capsule::P0Y][i] = p0[1];
+    capsules[capsule::P0Z][i] = p0[2];
+    capsules[capsule::P1X][i] = p1[0];
+    capsules[capsule::P1Y][i] = p1[1];
+    capsules[capsule::P1Z][i] = p1[2];
+    capsules[capsule::Radius][i] = radius;
+}
+
+struct CapsuleInstances {
+    std::vector<InstanceData> Cylinders, Tops, Bottoms;
+
+    explicit CapsuleInstances(size_t count) : Cylinders(count), Tops(count), Bottoms(count) {}
+};
+
+CapsuleInstances build_capsules(const CapsuleColumns& in, size_t begin, Isa isa) {
+    CapsuleInstances out(in.Count);
+    instance_builder::build_capsules(in, begin, in.Count, out.Cylinders.data(), out.Tops.data(), out.Bottoms.data(), isa);
+    return out;
+}
+
+void expect_same(const CapsuleInstances& expected, const CapsuleInstances& actual, Isa isa) {
+    expect_same(expected.Cylinders, actual.Cylinders, isa);
+    expect_same(expected.Tops, actual.Tops, isa);
+    expect_same(expected.Bottoms, actual.Bottoms, isa);
+}
+
+}
+
+TEST(InstanceBuilder, IsaNames) {
+    EXPECT_STREQ(get_isa_name(Isa::Scalar), "Scalar");
+    EXPECT_STREQ(get_isa_name(Isa::Sse), "SSE");
+    EXPECT_STREQ(get_isa_name(Isa::Avx), "AVX");
+}
+
+TEST(InstanceBuilder, ScalarSphere) {
+    SphereColumns spheres;
+    spheres.resize(1);
+    spheres[sphere::X][0] = 1.0f;
+    spheres[sphere::Y][0] = 2.0f;
+    spheres[sphere::Z][0] = 3.0f;
+    spheres[sphere::Radius][0] = 4.0f;
+    spheres.Colors[0] = { 0.1f, 0.2f, 0.3f, 0.4f };
+
+    InstanceData out{};
+    build_spheres(spheres, 0, 1, &out, Isa::Scalar);
+
+    // Scale by the radius, translate to the center, transposed for HLSL
+    const f32 expected[16] = {
+        4, 0, 0, 1,
+        0, 4, 0, 2,
+        0, 0, 4, 3,
+        0, 0, 0, 1
+    };
+    for (size_t i = 0; i < 16; ++i) {
+        EXPECT_EQ(out.Transform[i], expected[i]) << i;
+    }
+    EXPECT_EQ(out.Color.A, 0.4f);
+}
+
+TEST(InstanceBuilder, SpheresMatchScalar) {
+    std::mt19937 rng(1);
+    for (const Isa isa : simd_isas()) {
+        for (const size_t count : COUNTS) {
+            SphereColumns spheres;
+            fill_random(spheres, count, rng, -1000.0f, 1000.0f);
+
+            for (const size_t begin : { (size_t)0, (std::min)(count, (size_t)3) }) {
+                std::vector<InstanceData> expected(count), actual(count);
+                build_spheres(spheres, begin, count, expected.data(), Isa::Scalar);
+                build_spheres(spheres, begin, count, actual.data(), isa);
+                expect_same(expected, actual, isa);
+            }
+        }
+    }
+}
+
+TEST(InstanceBuilder, ObbsMatchScalar) {
+    std::mt19937 rng(2);
+    for (const Isa isa : simd_isas()) {
+        for (const size_t count : COUNTS) {
+            ObbColumns obbs;
+            fill_random(obbs, count, rng, -100.0f, 100.0f);
+
+            for (const size_t begin : { (size_t)0, (std::min)(count, (size_t)3) }) {
+                std::vector<InstanceData> expected(count), actual(count);
+                build_obbs(obbs, begin, count, expected.data(), Isa::Scalar);
+                build_obbs(obbs, begin, count, actual.data(), isa);
+                expect_same(expected, actual, isa);
+            }
+        }
+    }
+}
+
+TEST(InstanceBuilder, CapsulesMatchScalar) {
+    std::mt19937 rng(3);
+    for (const Isa isa : simd_isas()) {
+        for (const size_t count : COUNTS) {
+            CapsuleColumns capsules;
+            fill_random(capsules, count, rng, -1000.0f, 1000.0f);
+
+            for (const size_t begin : { (size_t)0, (std::min)(count, (size_t)3) }) {
+                expect_same(build_capsules(capsules, begin, Isa::Scalar), build_capsules(capsules, begin, isa), isa);
+            }
+        }
+    }
+}
+
+TEST(InstanceBuilder, DegenerateCapsulesMatchScalar) {
+    // Zero length, vertical both ways and nearly vertical capsules, spread over SIMD lanes and the tail
+    CapsuleColumns capsules;
+    capsules.resize(19);
+    for (size_t i = 0; i < capsules.Count; ++i) {
+        const f32 o = (f32)i;
+        switch (i % 4) {
+        case 0: set_capsule(capsules, i, { o, 5, -o }, { o, 5, -o }, 1.5f); break;
+        case 1: set_capsule(capsules, i, { o, 0, 2 }, { o, 10 + o, 2 }, 2.0f); break;
+        case 2: set_capsule(capsules, i, { o, 10 + o, 2 }, { o, 0, 2 }, 0.5f); break;
+        case 3: set_capsule(capsules, i, { o, 0, 0 }, { o + 1e-4f, 20, 0 }, 1.0f); break;
+        }
+        capsules.Colors[i] = { 1, 0, 0, 1 };
+    }
+
+    const auto expected = build_capsules(capsules, 0, Isa::Scalar);
+    for (const Isa isa : simd_isas()) {
+        expect_same(expected, build_capsules(capsules, 0, isa), isa);
+    }
+
+    for (size_t i = 0; i < capsules.Count; ++i) {
+        for (const auto* instances : { &expected.Cylinders, &expected.Tops, &expected.Bottoms }) {
+            for (const f32 value : (*instances)[i].Transform) {
+                EXPECT_TRUE(std::isfinite(value)) << "capsule " << i;
+            }
+        }
+    }
+
+    // Zero length: no rotation, the cylinder collapses and both hemispheres sit at the point
+    const auto& cylinder = expected.Cylinders[0].Transform;
+    EXPECT_EQ(cylinder[0], 1.5f);
+    EXPECT_EQ(cylinder[5], 0.0f);
+    EXPECT_EQ(cylinder[10], 1.5f);
+    EXPECT_EQ(expected.Tops[0].Transform[7], 5.0f);
+    EXPECT_EQ(expected.Bottoms[0].Transform[7], 5.0f);
+
+    // Pointing down: the ends are swapped, so the top hemisphere is at the upper end
+    EXPECT_EQ(expected.Tops[2].Transform[7], 12.0f);
+    EXPECT_EQ(expected.Bottoms[2].Transform[7], 0.0f);
+    EXPECT_FLOAT_EQ(expected.Cylinders[2].Transform[5], 6.0f);
+}
+
+TEST(InstanceBuilder, BuilderBuildsEveryType) {
+    InstanceBuilder builder(Isa::Scalar);
+    builder.resize(2, 3, 4);
+    EXPECT_EQ(builder.spheres().Count, 2u);
+    EXPECT_EQ(builder.obbs().Count, 3u);
+    EXPECT_EQ(builder.capsules().Count, 4u);
+
+    builder.build();
+    EXPECT_EQ(builder.sphere_instances().size(), 2u);
+    EXPECT_EQ(builder.obb_instances().size(), 3u);
+    EXPECT_EQ(builder.cylinder_instances().size(), 4u);
+    EXPECT_EQ(builder.top_instances().size(), 4u);
+    EXPECT_EQ(builder.bottom_instances().size(), 4u);
+}
@@ -0,0 +1,51 @@
+#include "InstanceBuilder.h"
+#include "JobPool.h"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+using namespace instance_builder;
+
+namespace {
+
+constexpr size_t GRAIN = 512;
+
+// Builds capsule instances the way the renderer does, spread over 1 to 8 threads
+void parallel_capsules(benchmark::State& state) {
+    const auto thread_count = (size_t)state.range(0);
+    const auto count = (size_t)state.range(1);
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<f32> dist(-100.0f, 100.0f);
+
+    InstanceBuilder builder;
+    builder.resize(0, 0, count);
+    for (auto& column : builder.capsules().Data) {
+        for (auto& value : column) value = dist(rng);
+    }
+
+    JobPool pool(thread_count - 1);
+    for (auto _ : state) {
+        pool.parallel_for(count, GRAIN, [&](size_t begin, size_t end) { builder.build_capsules(begin, end); });
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed((int64_t)(state.iterations() * count));
+    state.SetLabel(get_isa_name(builder.isa()));
+}
+
+// Empty chunks, measures the cost of waking the workers and waiting for them
+void parallel_overhead(benchmark::State& state) {
+    const auto thread_count = (size_t)state.range(0);
+
+    JobPool pool(thread_count - 1);
+    for (auto _ : state) {
+        pool.parallel_for(thread_count * 4, 1, [](size_t begin, size_t end) { benchmark::DoNotOptimize(begin + end); });
+    }
+}
+
+}
+
+BENCHMARK(parallel_capsules)->ArgsProduct({ { 1, 2, 4, 8 }, { 10000, 100000 } })->UseRealTime();
+BENCHMARK(parallel_overhead)->DenseRange(1, 8)->UseRealTime();
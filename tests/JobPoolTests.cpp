@@ -0,0 +1,171 @@
+#include "JobPool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr size_t COUNTS[] = { 1, 2, 7, 8, 9, 31, 32, 33, 63, 64, 65, 100, 257, 1000, 4099 };
+constexpr size_t GRAINS[] = { 1, 2, 3, 16, 64, 1000 };
+
+// Runs a job and checks that every index was visited exactly once, by non-empty in-bounds ranges
+void expect_exact_cover(JobPool& pool, size_t count, size_t grain) {
+    std::vector<std::atomic<u32>> visits(count);
+    std::mutex mutex;
+    std::vector<std::pair<size_t, size_t>> ranges;
+
+    pool.parallel_for(count, grain, [&](size_t begin, size_t end) {
+        {
+            std::scoped_lock lock(mutex);
+            ranges.emplace_back(begin, end);
+        }
+
+        for (size_t i = begin; i < end; ++i) {
+            visits[i].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    for (const auto& [begin, end] : ranges) {
+        EXPECT_LT(begin, end) << "count " << count << ", grain " << grain;
+        EXPECT_LE(end, count) << "count " << count << ", grain " << grain;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(visits[i].load(), 1u) << "index " << i << ", count " << count << ", grain " << grain
+            << ", threads " << pool.thread_count();
+    }
+}
+
+std::vector<f32> compute(JobPool& pool, size_t count, size_t grain) {
+    std::vector<f32> out(count);
+    pool.parallel_for(count, grain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            out[i] = std::sin((f32)i * 0.01f) * std::sqrt((f32)i);
+        }
+    });
+
+    return out;
+}
+
+}
+
+TEST(JobPool, ThreadCountIncludesCaller) {
+    EXPECT_EQ(JobPool(0).thread_count(), 1u);
+    EXPECT_EQ(JobPool(3).thread_count(), 4u);
+    EXPECT_LE(JobPool::default_worker_count(), 7u);
+}
+
+TEST(JobPool, EmptyJobDoesNotCall) {
+    JobPool pool(2);
+    bool called = false;
+    pool.parallel_for(0, 1, [&](size_t, size_t) { called = true; });
+    EXPECT_FALSE(called);
+}
+
+TEST(JobPool, ZeroWorkersRunsInline) {
+    JobPool pool(0);
+    const auto caller = std::this_thread::get_id();
+    size_t calls = 0;
+
+    pool.parallel_for(1000, 1, [&](size_t begin, size_t end) {
+        EXPECT_EQ(std::this_thread::get_id(), caller);
+        EXPECT_EQ(begin, 0u);
+        EXPECT_EQ(end, 1000u);
+        ++calls;
+    });
+
+    EXPECT_EQ(calls, 1u);
+}
+
+TEST(JobPool, SmallJobsRunInline) {
+    JobPool pool(3);
+    const auto caller = std::this_thread::get_id();
+    size_t calls = 0;
+
+    pool.parallel_for(64, 64, [&](size_t begin, size_t end) {
+        EXPECT_EQ(std::this_thread::get_id(), caller);
+        EXPECT_EQ(begin, 0u);
+        EXPECT_EQ(end, 64u);
+        ++calls;
+    });
+
+    EXPECT_EQ(calls, 1u);
+}
+
+TEST(JobPool, CoversEveryIndexExactlyOnce) {
+    for (size_t workers = 0; workers < 8; ++workers) {
+        JobPool pool(workers);
+        for (const size_t count : COUNTS) {
+            for (const size_t grain : GRAINS) {
+                expect_exact_cover(pool, count, grain);
+            }
+        }
+    }
+}
+
+TEST(JobPool, ChunksRespectGrain) {
+    JobPool pool(3);
+    std::mutex mutex;
+    std::vector<size_t> sizes;
+
+    pool.parallel_for(1000, 100, [&](size_t begin, size_t end) {
+        std::scoped_lock lock(mutex);
+        sizes.push_back(end - begin);
+    });
+
+    size_t total = 0;
+    for (const size_t size : sizes) {
+        total += size;
+    }
+
+    EXPECT_EQ(total, 1000u);
+    EXPECT_LE(sizes.size(), 10u);
+}
+
+TEST(JobPool, ResultsDoNotDependOnThreadCount) {
+    JobPool reference_pool(0);
+    const auto expected = compute(reference_pool, 10007, 1);
+
+    for (size_t workers = 1; workers < 8; ++workers) {
+        JobPool pool(workers);
+        for (const size_t grain : GRAINS) {
+            EXPECT_EQ(compute(pool, expected.size(), grain), expected) << "workers " << workers << ", grain " << grain;
+        }
+    }
+}
+
+TEST(JobPool, RepeatedGenerations) {
+    // Back to back jobs of changing sizes, so workers that wake late see a newer generation or a finished job
+    JobPool pool(4);
+    std::vector<u64> sums(2000);
+
+    for (size_t generation = 0; generation < sums.size(); ++generation) {
+        const size_t count = 1 + generation % 97;
+        std::atomic<u64> sum = 0;
+
+        pool.parallel_for(count, 1, [&](size_t begin, size_t end) {
+            u64 local = 0;
+            for (size_t i = begin; i < end; ++i) {
+                local += i + 1;
+            }
+
+            sum.fetch_add(local, std::memory_order_relaxed);
+        });
+
+        ASSERT_EQ(sum.load(), (u64)count * (count + 1) / 2) << "generation " << generation;
+    }
+}
+
+TEST(JobPool, DestroyWhileIdle) {
+    for (size_t i = 0; i < 50; ++i) {
+        JobPool pool(3);
+        if (i % 2 == 0) {
+            expect_exact_cover(pool, 100, 1);
+        }
+    }
+}
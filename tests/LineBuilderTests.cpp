@@ -0,0 +1,133 @@
+#include "LineBuilder.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+using namespace line_builder;
+using instance_builder::Rgba;
+
+namespace {
+
+culling::LineColumns make_lines(size_t count) {
+    culling::LineColumns lines;
+    lines.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t j = 0; j < culling::line::Count; ++j) {
+            lines[j][i] = (f32)(i * 10 + j);
+        }
+
+        lines.Colors[i] = { 1.0f, 0.0f, 0.5f, (f32)i / (f32)count };
+    }
+
+    return lines;
+}
+
+}
+
+TEST(LineBuilder, PackColorChannelOrder) {
+    EXPECT_EQ(pack_color({ 1, 0, 0, 0 }), 0x000000FFu);
+    EXPECT_EQ(pack_color({ 0, 1, 0, 0 }), 0x0000FF00u);
+    EXPECT_EQ(pack_color({ 0, 0, 1, 0 }), 0x00FF0000u);
+    EXPECT_EQ(pack_color({ 0, 0, 0, 1 }), 0xFF000000u);
+}
+
+TEST(LineBuilder, PackColorClamps) {
+    const f32 inf = std::numeric_limits<f32>::infinity();
+    EXPECT_EQ(pack_color({ -1.0f, 2.0f, -inf, inf }), 0xFF00FF00u);
+    EXPECT_EQ(pack_color({ -0.0f, 1.0001f, 0, 0 }), 0x0000FF00u);
+}
+
+TEST(LineBuilder, PackColorRounds) {
+    // The nearest of the 256 levels, the same as the GPU's float to UNORM conversion
+    EXPECT_EQ(pack_color({ 0.5f, 0, 0, 0 }), 128u);
+    EXPECT_EQ(pack_color({ 0.25f, 0, 0, 0 }), 64u);
+    EXPECT_EQ(pack_color({ 1.0f / 255.0f, 0, 0, 0 }), 1u);
+    EXPECT_EQ(pack_color({ 0.49f / 255.0f, 0, 0, 0 }), 0u);
+    EXPECT_EQ(pack_color({ 0.51f / 255.0f, 0, 0, 0 }), 1u);
+    EXPECT_EQ(pack_color({ 254.49f / 255.0f, 0, 0, 0 }), 254u);
+
+    for (u32 level = 0; level < 256; ++level) {
+        ASSERT_EQ(pack_color({ (f32)level / 255.0f, 0, 0, 0 }), level);
+    }
+}
+
+TEST(LineBuilder, PackColorNan) {
+    const f32 nan = std::numeric_limits<f32>::quiet_NaN();
+    EXPECT_EQ(pack_color({ nan, 1, nan, 1 }), 0xFF00FF00u);
+    EXPECT_EQ(pack_color({ nan, nan, nan, nan }), 0u);
+}
+
+TEST(LineBuilder, SegmentLayout) {
+    // Must match the structured buffer in LineRenderingPullVS.hlsl
+    EXPECT_EQ(offsetof(Segment, P0), 0u);
+    EXPECT_EQ(offsetof(Segment, Color), 12u);
+    EXPECT_EQ(offsetof(Segment, P1), 16u);
+    EXPECT_EQ(offsetof(Segment, Padding), 28u);
+    EXPECT_EQ(sizeof(Segment), 32u);
+
+    EXPECT_EQ(offsetof(Vertex, Position), 0u);
+    EXPECT_EQ(offsetof(Vertex, Color), 16u);
+    EXPECT_EQ(sizeof(Vertex), 32u);
+}
+
+TEST(LineBuilder, BuildSegments) {
+    const auto lines = make_lines(5);
+    std::vector<Segment> segments(5);
+    build_segments(lines, 0, 5, segments.data());
+
+    for (size_t i = 0; i < 5; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            EXPECT_EQ(segments[i].P0[j], lines[culling::line::P0X + j][i]);
+            EXPECT_EQ(segments[i].P1[j], lines[culling::line::P1X + j][i]);
+        }
+
+        EXPECT_EQ(segments[i].Color, pack_color(lines.Colors[i]));
+        EXPECT_EQ(segments[i].Padding, 0u);
+    }
+}
+
+TEST(LineBuilder, BuildVertices) {
+    const auto lines = make_lines(3);
+    std::vector<Vertex> vertices(6);
+    build_vertices(lines, 0, 3, vertices.data());
+
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            EXPECT_EQ(vertices[i * 2].Position[j], lines[culling::line::P0X + j][i]);
+            EXPECT_EQ(vertices[i * 2 + 1].Position[j], lines[culling::line::P1X + j][i]);
+        }
+
+        EXPECT_EQ(vertices[i * 2].Position[3], 1.0f);
+        EXPECT_EQ(vertices[i * 2 + 1].Position[3], 1.0f);
+        EXPECT_EQ(vertices[i * 2].Color.A, lines.Colors[i].A);
+        EXPECT_EQ(vertices[i * 2 + 1].Color.R, lines.Colors[i].R);
+    }
+}
+
+TEST(LineBuilder, WritesOnlyTheRange) {
+    const auto lines = make_lines(10);
+
+    Segment sentinel_segment{};
+    sentinel_segment.Padding = 0xDEADBEEF;
+    std::vector<Segment> segments(10, sentinel_segment);
+    build_segments(lines, 3, 7, segments.data());
+
+    Vertex sentinel_vertex{};
+    sentinel_vertex.Position[3] = -1.0f;
+    std::vector<Vertex> vertices(20, sentinel_vertex);
+    build_vertices(lines, 3, 7, vertices.data());
+
+    for (size_t i = 0; i < 10; ++i) {
+        const bool inside = i >= 3 && i < 7;
+        EXPECT_EQ(segments[i].Padding, inside ? 0u : 0xDEADBEEF) << i;
+        if (inside) {
+            EXPECT_EQ(segments[i].P0[0], lines[culling::line::P0X][i]);
+        }
+
+        EXPECT_EQ(vertices[i * 2].Position[3], inside ? 1.0f : -1.0f) << i;
+        EXPECT_EQ(vertices[i * 2 + 1].Position[3], inside ? 1.0f : -1.0f) << i;
+    }
+}
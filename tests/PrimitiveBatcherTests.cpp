@@ -0,0 +1,258 @@
+#include "PrimitiveBatcher.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace primitive_batcher;
+using instance_builder::InstanceData;
+
+namespace {
+
+// Instances that remember where they came from, Transform[0] is the run and Transform[1] the index in it
+std::vector<InstanceData> make_run(size_t run, size_t count) {
+    std::vector<InstanceData> instances(count);
+    for (size_t i = 0; i < count; ++i) {
+        instances[i].Transform[0] = (f32)run;
+        instances[i].Transform[1] = (f32)i;
+    }
+
+    return instances;
+}
+
+struct Written {
+    std::vector<std::vector<InstanceData>> Passes;
+};
+
+Written write_all(const Batcher& batcher) {
+    Written written;
+    for (const auto& pass : batcher.passes()) {
+        auto& out = written.Passes.emplace_back(pass.InstanceCount);
+        batcher.write_instances(pass, out.data());
+    }
+
+    return written;
+}
+
+struct AddedRun {
+    u16 Slot;
+    size_t Run;
+    size_t Count;
+};
+
+// Checks the plan against the runs that were added, in the order they were added
+void expect_valid_plan(const Batcher& batcher, const std::vector<AddedRun>& added, size_t max_pass_instances) {
+    // What the stream should be: runs stably sorted by slot
+    auto sorted = added;
+    std::ranges::stable_sort(sorted, {}, &AddedRun::Slot);
+
+    std::vector<std::pair<u16, InstanceData>> expected;
+    for (const auto& run : sorted) {
+        for (size_t i = 0; i < run.Count; ++i) {
+            InstanceData instance{};
+            instance.Transform[0] = (f32)run.Run;
+            instance.Transform[1] = (f32)i;
+            expected.emplace_back(run.Slot, instance);
+        }
+    }
+
+    const auto written = write_all(batcher);
+    size_t stream_index = 0;
+    size_t draw_index = 0;
+
+    for (size_t p = 0; p < batcher.passes().size(); ++p) {
+        const auto& pass = batcher.passes()[p];
+        ASSERT_GT(pass.InstanceCount, 0u);
+        ASSERT_LE(pass.InstanceCount, max_pass_instances);
+        // Only the last pass may be partially filled
+        if (p + 1 < batcher.passes().size()) {
+            ASSERT_EQ(pass.InstanceCount, max_pass_instances);
+        }
+
+        ASSERT_EQ(pass.FirstDraw, draw_index);
+        draw_index += pass.DrawCount;
+
+        // The draws cover the pass back to back, each with one slot, and no two neighbours share a slot
+        u32 next_instance = 0;
+        const auto draws = batcher.draws(pass);
+        for (size_t d = 0; d < draws.size(); ++d) {
+            const auto& draw = draws[d];
+            ASSERT_EQ(draw.StartInstance, next_instance);
+            ASSERT_GT(draw.InstanceCount, 0u);
+            if (d > 0) {
+                ASSERT_LT(draws[d - 1].MeshSlot, draw.MeshSlot);
+            }
+
+            for (u32 i = draw.StartInstance; i < draw.StartInstance + draw.InstanceCount; ++i) {
+                ASSERT_LT(stream_index, expected.size());
+                const auto& [slot, instance] = expected[stream_index++];
+                ASSERT_EQ(draw.MeshSlot, slot);
+                ASSERT_EQ(written.Passes[p][i].Transform[0], instance.Transform[0]) << "pass " << p << ", instance " << i;
+                ASSERT_EQ(written.Passes[p][i].Transform[1], instance.Transform[1]) << "pass " << p << ", instance " << i;
+            }
+
+            next_instance += draw.InstanceCount;
+        }
+
+        ASSERT_EQ(next_instance, pass.InstanceCount);
+    }
+
+    EXPECT_EQ(stream_index, expected.size());
+    EXPECT_EQ(draw_index, batcher.draw_count());
+}
+
+}
+
+TEST(PrimitiveBatcher, MeshSlots) {
+    EXPECT_EQ(get_mesh_slot(MeshId::Sphere, 0), 0);
+    EXPECT_EQ(get_mesh_slot(MeshId::Sphere, culling::LOD_COUNT - 1), culling::LOD_COUNT - 1);
+    EXPECT_EQ(get_mesh_slot(MeshId::Cube, 0), culling::LOD_COUNT);
+    EXPECT_EQ(get_mesh_slot(MeshId::Cylinder, culling::LOD_COUNT - 1), MESH_SLOT_COUNT - 1);
+}
+
+TEST(PrimitiveBatcher, Empty) {
+    Batcher batcher;
+    const auto empty = make_run(0, 0);
+    batcher.add(MeshId::Sphere, 0, empty);
+    batcher.build(16);
+
+    EXPECT_TRUE(batcher.passes().empty());
+    EXPECT_EQ(batcher.draw_count(), 0u);
+}
+
+TEST(PrimitiveBatcher, SortsBySlotAndKeepsAddOrder) {
+    const auto a = make_run(0, 2);
+    const auto b = make_run(1, 3);
+    const auto c = make_run(2, 1);
+    const auto d = make_run(3, 4);
+
+    Batcher batcher;
+    batcher.add(MeshId::Cylinder, 0, a);
+    batcher.add(MeshId::Sphere, 2, b);
+    batcher.add(MeshId::Sphere, 0, c);
+    batcher.add(MeshId::Sphere, 2, d);
+    batcher.build(100);
+
+    ASSERT_EQ(batcher.passes().size(), 1u);
+    const auto draws = batcher.draws(batcher.passes()[0]);
+    ASSERT_EQ(draws.size(), 3u);
+
+    EXPECT_EQ(draws[0].MeshSlot, get_mesh_slot(MeshId::Sphere, 0));
+    EXPECT_EQ(draws[0].StartInstance, 0u);
+    EXPECT_EQ(draws[0].InstanceCount, 1u);
+
+    // b and d share a slot, they merge into one draw with b first
+    EXPECT_EQ(draws[1].MeshSlot, get_mesh_slot(MeshId::Sphere, 2));
+    EXPECT_EQ(draws[1].StartInstance, 1u);
+    EXPECT_EQ(draws[1].InstanceCount, 7u);
+
+    EXPECT_EQ(draws[2].MeshSlot, get_mesh_slot(MeshId::Cylinder, 0));
+    EXPECT_EQ(draws[2].StartInstance, 8u);
+    EXPECT_EQ(draws[2].InstanceCount, 2u);
+
+    const auto written = write_all(batcher);
+    const f32 expected_runs[] = { 2, 1, 1, 1, 3, 3, 3, 3, 0, 0 };
+    ASSERT_EQ(written.Passes[0].size(), std::size(expected_runs));
+    for (size_t i = 0; i < std::size(expected_runs); ++i) {
+        EXPECT_EQ(written.Passes[0][i].Transform[0], expected_runs[i]) << i;
+    }
+}
+
+TEST(PrimitiveBatcher, SplitsAtMaxPassInstances) {
+    const auto a = make_run(0, 5);
+    const auto b = make_run(1, 6);
+
+    Batcher batcher;
+    batcher.add(MeshId::Cube, 0, b);
+    batcher.add(MeshId::Sphere, 0, a);
+    batcher.build(4);
+
+    // 11 instances in passes of 4, 4 and 3. The sphere run spills into the second pass.
+    const auto passes = batcher.passes();
+    ASSERT_EQ(passes.size(), 3u);
+    EXPECT_EQ(passes[0].InstanceCount, 4u);
+    EXPECT_EQ(passes[1].InstanceCount, 4u);
+    EXPECT_EQ(passes[2].InstanceCount, 3u);
+
+    ASSERT_EQ(batcher.draws(passes[0]).size(), 1u);
+    ASSERT_EQ(batcher.draws(passes[1]).size(), 2u);
+    ASSERT_EQ(batcher.draws(passes[2]).size(), 1u);
+
+    const auto& spill = batcher.draws(passes[1])[0];
+    EXPECT_EQ(spill.MeshSlot, get_mesh_slot(MeshId::Sphere, 0));
+    EXPECT_EQ(spill.StartInstance, 0u);
+    EXPECT_EQ(spill.InstanceCount, 1u);
+
+    const auto& cube = batcher.draws(passes[1])[1];
+    EXPECT_EQ(cube.MeshSlot, get_mesh_slot(MeshId::Cube, 0));
+    EXPECT_EQ(cube.StartInstance, 1u);
+    EXPECT_EQ(cube.InstanceCount, 3u);
+
+    // Offsets are relative to the pass
+    EXPECT_EQ(batcher.draws(passes[2])[0].StartInstance, 0u);
+
+    expect_valid_plan(batcher, { { get_mesh_slot(MeshId::Cube, 0), 1, 6 }, { get_mesh_slot(MeshId::Sphere, 0), 0, 5 } }, 4);
+}
+
+TEST(PrimitiveBatcher, ExactlyFullPass) {
+    const auto a = make_run(0, 8);
+
+    Batcher batcher;
+    batcher.add(MeshId::Sphere, 1, a);
+    batcher.build(8);
+
+    ASSERT_EQ(batcher.passes().size(), 1u);
+    EXPECT_EQ(batcher.draw_count(), 1u);
+}
+
+TEST(PrimitiveBatcher, ClearKeepsWorking) {
+    const auto a = make_run(0, 3);
+    const auto b = make_run(1, 2);
+
+    Batcher batcher;
+    batcher.add(MeshId::Cube, 0, a);
+    batcher.build(16);
+    batcher.clear();
+    EXPECT_TRUE(batcher.passes().empty());
+
+    batcher.add(MeshId::Sphere, 0, b);
+    batcher.build(16);
+    expect_valid_plan(batcher, { { get_mesh_slot(MeshId::Sphere, 0), 1, 2 } }, 16);
+}
+
+TEST(PrimitiveBatcher, RandomRuns) {
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<size_t> mesh_dist(0, (size_t)MeshId::Count - 1);
+    std::uniform_int_distribution<size_t> lod_dist(0, culling::LOD_COUNT - 1);
+    std::uniform_int_distribution<size_t> count_dist(0, 40);
+    std::uniform_int_distribution<size_t> run_count_dist(0, 60);
+
+    Batcher batcher;
+    for (size_t iteration = 0; iteration < 200; ++iteration) {
+        const size_t run_count = run_count_dist(rng);
+        std::vector<std::vector<InstanceData>> storage;
+        std::vector<AddedRun> added;
+
+        batcher.clear();
+        for (size_t run = 0; run < run_count; ++run) {
+            const auto mesh = (MeshId)mesh_dist(rng);
+            const size_t lod = lod_dist(rng);
+            const auto& instances = storage.emplace_back(make_run(run, count_dist(rng)));
+
+            batcher.add(mesh, lod, instances);
+            if (!instances.empty()) {
+                added.push_back({ get_mesh_slot(mesh, lod), run, instances.size() });
+            }
+        }
+
+        for (const size_t max_pass_instances : { (size_t)1, (size_t)7, (size_t)64, (size_t)100000 }) {
+            batcher.build(max_pass_instances);
+            expect_valid_plan(batcher, added, max_pass_instances);
+            if (testing::Test::HasFatalFailure()) {
+                FAIL() << "iteration " << iteration << ", max pass instances " << max_pass_instances;
+            }
+        }
+    }
+}